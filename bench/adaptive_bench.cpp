@@ -0,0 +1,235 @@
+// Runs the adaptive quality controller against a rate-limited consumer on a loopback TCP socket
+// (POSIX only). A 90 Hz producer queues both eyes the way Present does, a sender thread drains a
+// two-slot mailbox and blocks on the socket the way FrameSender does, and the consumer reads at a
+// capped rate during the middle phase. Each run is done with adaptive.enabled off, then on.
+//
+//   ovd_adaptive_bench [seconds per phase]
+
+#include "frame/frame_metadata.h"
+#include "frame/quality_controller.h"
+#include "control/control.h"
+#include "mpsc/mailbox.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct Phase {
+    const char* name;
+    double bytesPerSecond;  // 0 for as fast as the consumer can read
+};
+
+struct EyeJob {
+    uint64_t frameIndex;
+    uint32_t width;
+    uint32_t height;
+    uint64_t queuedUs;
+};
+
+struct PhaseStats {
+    std::vector<uint64_t> latenciesUs;
+    uint64_t framesSent = 0;
+    uint64_t evicted = 0;
+};
+
+static constexpr uint32_t kEyeWidth = 960;
+static constexpr uint32_t kEyeHeight = 540;
+static constexpr double kDisplayFrequency = 90.0;
+
+static const Phase kPhases[] = {
+    { "fast link", 0.0 },
+    { "60 MB/s",   60e6 },
+    { "fast link", 0.0 },
+};
+
+static bool SendAll(int socket, const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool ConnectLoopback(int& serverSide, int& clientSide)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        return false;
+
+    clientSide = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(clientSide, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        return false;
+    serverSide = accept(listener, nullptr, nullptr);
+    close(listener);
+
+    int noDelay = 1;
+    setsockopt(serverSide, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return serverSide >= 0;
+}
+
+static uint64_t Percentile(std::vector<uint64_t> values, double fraction)
+{
+    if (values.empty())
+        return 0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void Run(bool adaptive, double phaseSeconds)
+{
+    control::Registry::Get().Execute(adaptive ? "set adaptive.enabled=1" : "set adaptive.enabled=0");
+
+    int serverSide = -1;
+    int clientSide = -1;
+    if (!ConnectLoopback(serverSide, clientSide))
+    {
+        std::printf("loopback connection failed\n");
+        return;
+    }
+
+    QualityController quality;
+    quality.Reset();
+    mpsc::Mailbox<EyeJob> mailbox(2);
+    std::atomic<uint32_t> pendingEvictions{0};
+    std::atomic<uint32_t> phaseIndex{0};
+    std::atomic<double> consumerRate{kPhases[0].bytesPerSecond};
+    std::atomic<uint64_t> timelineLatencyUs{0};
+    std::atomic<uint64_t> timelineFrames{0};
+    PhaseStats stats[std::size(kPhases)];
+
+    // Reads whole messages, pacing itself to consumerRate
+    std::jthread consumer([&](std::stop_token st) {
+        std::vector<uint8_t> buffer(64 * 1024);
+        auto windowStart = std::chrono::steady_clock::now();
+        double windowRate = consumerRate;
+        double windowBytes = 0.0;
+        while (!st.stop_requested())
+        {
+            double rate = consumerRate;
+            if (rate != windowRate)
+            {
+                windowStart = std::chrono::steady_clock::now();
+                windowRate = rate;
+                windowBytes = 0.0;
+            }
+            if (rate > 0.0)
+                std::this_thread::sleep_until(windowStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(windowBytes / rate)));
+
+            ssize_t received = recv(clientSide, buffer.data(), buffer.size(), 0);
+            if (received <= 0)
+                break;
+            windowBytes += static_cast<double>(received);
+        }
+    });
+
+    // Sends each eye as a length-prefixed message, like FrameSender over SocketManager
+    std::jthread sender([&](std::stop_token st) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(kEyeWidth) * kEyeHeight * 4);
+        while (auto job = mailbox.recv(st))
+        {
+            uint32_t header[2] = { 0, job->width * job->height * 4 };
+            std::memset(pixels.data(), static_cast<int>(job->frameIndex), header[1]);
+            if (!SendAll(serverSide, reinterpret_cast<const uint8_t*>(header), sizeof(header)) || !SendAll(serverSide, pixels.data(), header[1]))
+                break;
+
+            uint64_t latencyUs = GetDriverTimeUs() - job->queuedUs;
+            quality.RecordFrame(latencyUs, pendingEvictions.exchange(0));
+            timelineLatencyUs += latencyUs;
+            timelineFrames++;
+            PhaseStats& phase = stats[phaseIndex];
+            phase.latenciesUs.push_back(latencyUs);
+            phase.framesSent++;
+        }
+    });
+
+    if (adaptive)
+        std::printf("  %6s %-10s %5s %6s %7s %10s\n", "time", "phase", "level", "scale", "divisor", "latency_us");
+
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / kDisplayFrequency));
+    auto start = std::chrono::steady_clock::now();
+    uint64_t framesPerPhase = static_cast<uint64_t>(phaseSeconds * kDisplayFrequency);
+    for (uint64_t frame = 0; frame < framesPerPhase * std::size(kPhases); frame++)
+    {
+        uint32_t phase = static_cast<uint32_t>(frame / framesPerPhase);
+        if (phase != phaseIndex)
+        {
+            phaseIndex = phase;
+            consumerRate = kPhases[phase].bytesPerSecond;
+        }
+
+        // Present's side: thin frames and shrink eyes as the controller says
+        QualityLevel level = quality.GetQuality();
+        if (frame % level.frameDivisor == 0)
+        {
+            uint32_t width = std::max(2u, static_cast<uint32_t>(kEyeWidth * level.scale) & ~1u);
+            uint32_t height = std::max(2u, static_cast<uint32_t>(kEyeHeight * level.scale) & ~1u);
+            for (uint32_t eye = 0; eye < 2; eye++)
+            {
+                size_t evicted = mailbox.push(EyeJob{ frame, width, height, GetDriverTimeUs() });
+                pendingEvictions += static_cast<uint32_t>(evicted);
+                stats[phase].evicted += evicted;
+            }
+        }
+
+        // Half-second timeline of what the controller did
+        if (adaptive && frame % 45 == 0)
+        {
+            uint64_t count = timelineFrames.exchange(0);
+            uint64_t total = timelineLatencyUs.exchange(0);
+            std::printf("  %5.1fs %-10s %5u %5.0f%% %7u %10llu\n", frame / kDisplayFrequency, kPhases[phase].name, quality.GetLevel(),
+                        level.scale * 100.0f, level.frameDivisor, static_cast<unsigned long long>(count ? total / count : 0));
+        }
+
+        std::this_thread::sleep_until(start + period * static_cast<int64_t>(frame + 1));
+    }
+
+    sender.request_stop();
+    sender.join();
+    shutdown(serverSide, SHUT_RDWR);
+    consumer.request_stop();
+    consumer.join();
+    close(serverSide);
+    close(clientSide);
+
+    std::printf("  %-10s %9s %9s %9s %8s\n", "phase", "eyes/s", "p50_us", "p90_us", "evicted");
+    for (size_t i = 0; i < std::size(kPhases); i++)
+    {
+        std::printf("  %-10s %9.1f %9llu %9llu %8llu\n", kPhases[i].name, stats[i].framesSent / phaseSeconds,
+                    static_cast<unsigned long long>(Percentile(stats[i].latenciesUs, 0.5)),
+                    static_cast<unsigned long long>(Percentile(stats[i].latenciesUs, 0.9)),
+                    static_cast<unsigned long long>(stats[i].evicted));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double phaseSeconds = argc > 1 ? std::atof(argv[1]) : 4.0;
+
+    std::printf("%ux%u BGRA eyes at %.0f Hz, target latency %s ms\n\n", kEyeWidth, kEyeHeight, kDisplayFrequency,
+                control::Registry::Get().Execute("get adaptive.target_latency_ms").c_str());
+    std::printf("adaptive off\n");
+    Run(false, phaseSeconds);
+    std::printf("\nadaptive on\n");
+    Run(true, phaseSeconds);
+    return 0;
+}
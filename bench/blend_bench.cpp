@@ -0,0 +1,122 @@
+// Measures compositing overlay layers onto an eye image, and checks the kernel the CPU picks
+// against a float reference. Synthetic layers, so it runs without D3D or SteamVR.
+//
+//   ovd_blend_bench [frames]
+
+#include "image/blend.h"
+#include "thread/worker_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t kEyeWidth = 1920;
+static constexpr uint32_t kEyeHeight = 1080;
+// D3D11 row pitches are padded; use something that is not a multiple of the row size
+static constexpr uint32_t kRowPitch = kEyeWidth * 4 + 256;
+
+struct Overlay {
+    const char* name;
+    // Alpha of pixel (x, y); colour channels are noise
+    std::function<uint8_t(uint32_t x, uint32_t y, std::mt19937& rng)> alpha;
+};
+
+static std::vector<uint8_t> MakeLayer(uint32_t seed, const std::function<uint8_t(uint32_t, uint32_t, std::mt19937&)>& alpha)
+{
+    std::vector<uint8_t> pixels(static_cast<size_t>(kRowPitch) * kEyeHeight, 0);
+    std::mt19937 rng(seed);
+    for (uint32_t y = 0; y < kEyeHeight; y++)
+    {
+        for (uint32_t x = 0; x < kEyeWidth; x++)
+        {
+            uint8_t* p = &pixels[static_cast<size_t>(y) * kRowPitch + x * 4];
+            uint32_t v = rng();
+            std::memcpy(p, &v, 3);
+            p[3] = alpha(x, y, rng);
+        }
+    }
+    return pixels;
+}
+
+// Straight from the definition, no integer tricks
+static bool MatchesReference(const std::vector<uint8_t>& src, const std::vector<uint8_t>& dst, const std::vector<uint8_t>& out)
+{
+    for (uint32_t y = 0; y < kEyeHeight; y++)
+    {
+        for (uint32_t x = 0; x < kEyeWidth * 4; x++)
+        {
+            size_t i = static_cast<size_t>(y) * kRowPitch + x;
+            float a = src[i - x % 4 + 3];
+            uint8_t expected = static_cast<uint8_t>(std::lround((src[i] * a + dst[i] * (255.0f - a)) / 255.0f));
+            if (out[i] != expected)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 120;
+    double pixels = static_cast<double>(kEyeWidth) * kEyeHeight;
+
+    std::vector<uint8_t> base = MakeLayer(1, [](uint32_t, uint32_t, std::mt19937&) { return uint8_t{ 255 }; });
+
+    const Overlay overlays[] = {
+        // Nothing drawn, the common case between dashboard opens
+        { "transparent", [](uint32_t, uint32_t, std::mt19937&) { return uint8_t{ 0 }; } },
+        // A HUD quad in the lower third, soft edged, clear elsewhere
+        { "hud panel", [](uint32_t x, uint32_t y, std::mt19937&) {
+            bool inside = x >= 480 && x < 1440 && y >= 700 && y < 1000;
+            bool edge = inside && (x < 488 || x >= 1432 || y < 708 || y >= 992);
+            return static_cast<uint8_t>(!inside ? 0 : edge ? 128 : 255);
+        } },
+        // Translucent dashboard over the whole view
+        { "dashboard 75%", [](uint32_t, uint32_t, std::mt19937&) { return uint8_t{ 192 }; } },
+        // Every pixel different, worst case for the opaque/clear shortcuts
+        { "noise alpha", [](uint32_t, uint32_t, std::mt19937& rng) { return static_cast<uint8_t>(rng()); } },
+    };
+
+    WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    std::printf("kernel: %s, %ux%u eye, %u threads striped\n", GetBlendKernelName(), kEyeWidth, kEyeHeight, pool.GetConcurrency());
+    std::printf("%-16s %12s %12s %12s %6s\n", "overlay", "ns/px", "ms/eye", "ms striped", "exact");
+
+    for (const Overlay& overlay : overlays)
+    {
+        std::vector<uint8_t> layer = MakeLayer(2, overlay.alpha);
+        std::vector<uint8_t> out(base.size(), 0);
+
+        // Readback into a separate image, as Present does for the first overlay
+        BlendImageOver(layer.data(), kRowPitch, base.data(), kRowPitch, out.data(), kRowPitch, kEyeWidth, 0, kEyeHeight);
+        bool exact = MatchesReference(layer, base, out);
+
+        // Stacked in place, as Present does for any further overlay
+        std::vector<uint8_t> inPlace = base;
+        BlendImageOver(layer.data(), kRowPitch, inPlace.data(), kRowPitch, inPlace.data(), kRowPitch, kEyeWidth, 0, kEyeHeight);
+        exact = exact && inPlace == out;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frames; i++)
+            BlendImageOver(layer.data(), kRowPitch, base.data(), kRowPitch, out.data(), kRowPitch, kEyeWidth, 0, kEyeHeight);
+        double single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < frames; i++)
+        {
+            pool.RunStripes(kEyeHeight, [&](uint32_t rowBegin, uint32_t rowEnd) {
+                BlendImageOver(layer.data(), kRowPitch, base.data(), kRowPitch, out.data(), kRowPitch, kEyeWidth, rowBegin, rowEnd);
+            });
+        }
+        double striped = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        std::printf("%-16s %12.3f %12.3f %12.3f %6s\n", overlay.name, single * 1e6 / pixels, single, striped, exact ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Compares per-frame allocation of eye buffers against the recycled frame buffer pool.
+// Simulates one second of 90 Hz stereo frames with a couple of frames in flight at the sender.
+//
+//   ovd_buffer_pool_bench [width] [height]
+
+#include "frame/frame_fanout.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+static constexpr uint32_t kFramesPerSecond = 90;
+static constexpr size_t kFramesInFlight = 2;
+
+static long MinorPageFaults()
+{
+#if defined(__linux__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+#else
+    return 0;
+#endif
+}
+
+template<typename FrameFn>
+static void Measure(const char* name, FrameFn frame, uint64_t (*allocations)())
+{
+    // One warm-up second so both variants start from the same steady state
+    for (uint32_t i = 0; i < kFramesPerSecond; i++)
+        frame();
+
+    uint64_t allocationsBefore = allocations();
+    long faultsBefore = MinorPageFaults();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kFramesPerSecond; i++)
+        frame();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-10s %10llu allocs/s %10ld page faults/s %8.3f ms/frame\n", name,
+                static_cast<unsigned long long>(allocations() - allocationsBefore),
+                MinorPageFaults() - faultsBefore, ms / kFramesPerSecond);
+}
+
+static uint64_t s_vectorAllocations = 0;
+
+static uint64_t VectorAllocations()
+{
+    return s_vectorAllocations;
+}
+
+static uint64_t PoolAllocations()
+{
+    return FrameBufferPool::Shared().GetStats().allocations;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t width = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1920;
+    uint32_t height = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 1080;
+    size_t frameSize = static_cast<size_t>(width) * height * 4;
+    std::vector<uint8_t> source(frameSize, 0x5A);
+
+    // Before: a fresh zeroed vector per eye, released once the sender is done with it
+    std::deque<std::vector<uint8_t>> vectorsInFlight;
+    Measure("vector", [&] {
+        for (int eye = 0; eye < 2; eye++)
+        {
+            std::vector<uint8_t> pixels(frameSize);
+            s_vectorAllocations++;
+            std::memcpy(pixels.data(), source.data(), frameSize);
+            vectorsInFlight.push_back(std::move(pixels));
+            if (vectorsInFlight.size() > kFramesInFlight * 2)
+                vectorsInFlight.pop_front();
+        }
+    }, VectorAllocations);
+
+    // After: pooled buffers shared by two subscribers, returned when both let go
+    std::deque<FrameBufferRef> senderInFlight;
+    std::deque<FrameBufferRef> recorderInFlight;
+    Measure("pool", [&] {
+        for (int eye = 0; eye < 2; eye++)
+        {
+            FrameBufferRef pixels = FrameBufferPool::Shared().Acquire(frameSize);
+            std::memcpy(pixels.GetMutableData(), source.data(), frameSize);
+            senderInFlight.push_back(pixels);
+            recorderInFlight.push_back(pixels);
+            if (senderInFlight.size() > kFramesInFlight * 2)
+                senderInFlight.pop_front();
+            if (recorderInFlight.size() > kFramesInFlight)
+                recorderInFlight.pop_front();
+        }
+    }, PoolAllocations);
+
+    return 0;
+}
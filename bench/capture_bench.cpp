@@ -0,0 +1,81 @@
+// Measures compositor-thread time per Present for different client subscriptions: the readback
+// copies, crop and convert Present does, against the CPU mock backend at 90 Hz frame indices.
+//
+//   ovd_capture_bench [frames]
+
+#include "frame/eye_writer.h"
+#include "frame/frame_buffer_pool.h"
+#include "frame/frame_subscription.h"
+#include "readback/mock_readback.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Scenario {
+    const char* name;
+    FrameSubscription subscription;
+};
+
+static constexpr uint32_t kTextureWidth = 3840;  // Both eyes side by side
+static constexpr uint32_t kTextureHeight = 1080;
+static constexpr uint64_t kTextureHandle = 1;
+static constexpr double kDisplayFrequency = 90.0;
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 270;
+
+    std::vector<uint8_t> texture(static_cast<size_t>(kTextureWidth) * kTextureHeight * 4, 0x40);
+
+    const Scenario scenarios[] = {
+        { "both eyes",        kDefaultFrameSubscription },
+        { "left eye",         { 1, 1, 0.0f, 0 } },
+        { "both, divisor 3",  { 3, 3, 0.0f, 0 } },
+        { "left, 30 fps",     { 1, 1, 30.0f, 0 } },
+        { "left, 10 fps",     { 1, 1, 10.0f, 0 } },
+        { "paused",           { 3, 1, 0.0f, 1 } },
+    };
+
+    std::printf("%-16s %9s %11s %9s\n", "subscription", "converted", "us/present", "saved");
+    double baseline = 0.0;
+    for (const auto& scenario : scenarios)
+    {
+        MockReadback readback(2, 1);
+        readback.RegisterTexture(kTextureHandle, texture.data(), kTextureWidth * 4, kTextureWidth, kTextureHeight, SourceFormat::Bgra8);
+
+        uint64_t converted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < frames; frame++)
+        {
+            uint32_t wantedEyes = SelectSubscribedEyes(scenario.subscription, frame, kDisplayFrequency);
+            for (uint32_t eye = 0; eye < 2; eye++)
+            {
+                if (!((wantedEyes >> eye) & 1))
+                    continue;
+                float uMin = eye == 0 ? 0.0f : 0.5f;
+                readback.Submit(ReadbackRequest{ kTextureHandle, uMin, 0.0f, uMin + 0.5f, 1.0f, eye, frame, 0 });
+            }
+
+            for (uint32_t eye = 0; eye < 2; eye++)
+            {
+                auto result = readback.Acquire(eye);
+                if (!result)
+                    continue;
+
+                PixelRect source{ 0, 0, result->width, result->height };
+                EyeLayout layout{ source, result->width, result->height, ResampleFilter::Box, result->format, PixelFormat::Bgra8, false };
+                FrameBufferRef pixels = FrameBufferPool::Shared().Acquire(GetPixelFormatSize(layout.format, layout.width, layout.height));
+                WriteEye(WorkerPool::Shared(), result->data, result->rowPitch, layout, pixels.GetMutableData());
+                readback.Release(eye);
+                converted++;
+            }
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+        if (baseline == 0.0)
+            baseline = us;
+
+        std::printf("%-16s %9llu %11.1f %8.0f%%\n", scenario.name, static_cast<unsigned long long>(converted), us, 100.0 * (1.0 - us / baseline));
+    }
+    return 0;
+}
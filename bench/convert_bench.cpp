@@ -0,0 +1,97 @@
+// Checks every conversion kernel set this CPU can run byte for byte against the scalar one, for
+// every output format on odd widths and heights inside a padded source, then reports the bytes
+// per frame and the conversion cost of each format. Exits with 1 if any check fails.
+//
+//   ovd_convert_bench [frames]
+
+#include "image/convert.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static constexpr uint32_t kEyeWidth = 1920;
+static constexpr uint32_t kEyeHeight = 1080;
+// D3D11 row pitches are padded; use something that is not a multiple of the row size
+static constexpr uint32_t kRowPitch = kEyeWidth * 4 + 256;
+
+struct Format {
+    PixelFormat format;
+    const char* name;
+};
+
+static const Format kFormats[] = {
+    { PixelFormat::Bgra8, "bgra8" },
+    { PixelFormat::Rgba8, "rgba8" },
+    { PixelFormat::Rgb8, "rgb8" },
+    { PixelFormat::I420, "i420" },
+    { PixelFormat::Nv12, "nv12" },
+    { PixelFormat::Gray8, "gray8" },
+    { PixelFormat::Rgba16F, "rgba16f" },
+};
+
+// Odd and even sizes around every vector width, placed away from the image origin
+static const PixelRect kCheckRects[] = {
+    { 0, 0, 1, 1 }, { 1, 1, 2, 2 }, { 3, 2, 3, 5 }, { 5, 7, 7, 3 }, { 2, 1, 15, 9 }, { 9, 4, 17, 11 },
+    { 1, 3, 31, 33 }, { 7, 5, 33, 7 }, { 3, 0, 63, 31 }, { 11, 13, 65, 17 }, { 0, 2, 127, 65 }, { 13, 1, 129, 64 },
+    { 17, 9, 1001, 37 }, { 0, 0, kEyeWidth, kEyeHeight },
+};
+
+static bool MatchesReference(const ConvertKernels& reference, const ConvertKernels& kernels, const std::vector<uint8_t>& image, PixelFormat format)
+{
+    for (const PixelRect& rect : kCheckRects)
+    {
+        size_t size = GetPixelFormatSize(format, rect.width, rect.height);
+        std::vector<uint8_t> expected(size), actual(size);
+        ConvertBgraWithKernels(reference, image.data(), kRowPitch, rect, format, expected.data());
+        ConvertBgraWithKernels(kernels, image.data(), kRowPitch, rect, format, actual.data());
+        if (expected != actual)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 30;
+    double pixels = static_cast<double>(kEyeWidth) * kEyeHeight;
+
+    std::vector<uint8_t> image(static_cast<size_t>(kRowPitch) * kEyeHeight);
+    std::mt19937 rng(1);
+    for (uint8_t& byte : image)
+        byte = static_cast<uint8_t>(rng());
+
+    std::vector<ConvertKernels> variants = GetConvertKernelVariants();
+    const ConvertKernels& reference = variants.front();
+    const PixelRect eye{ 0, 0, kEyeWidth, kEyeHeight };
+    std::vector<uint8_t> out(GetPixelFormatSize(PixelFormat::Rgba16F, kEyeWidth, kEyeHeight));
+
+    std::printf("%ux%u BGRA eye, ns/px per kernel set\n", kEyeWidth, kEyeHeight);
+    std::printf("%-8s %12s %6s", "format", "bytes", "exact");
+    for (const ConvertKernels& kernels : variants)
+        std::printf(" %10s", kernels.name);
+    std::printf("\n");
+
+    bool passed = true;
+    for (const Format& format : kFormats)
+    {
+        bool exact = true;
+        for (const ConvertKernels& kernels : variants)
+            exact = MatchesReference(reference, kernels, image, format.format) && exact;
+        passed = passed && exact;
+
+        std::printf("%-8s %12zu %6s", format.name, GetPixelFormatSize(format.format, kEyeWidth, kEyeHeight), exact ? "yes" : "NO");
+        for (const ConvertKernels& kernels : variants)
+        {
+            ConvertBgraWithKernels(kernels, image.data(), kRowPitch, eye, format.format, out.data());
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < frames; i++)
+                ConvertBgraWithKernels(kernels, image.data(), kRowPitch, eye, format.format, out.data());
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            std::printf(" %10.3f", ns / frames / pixels);
+        }
+        std::printf("\n");
+    }
+    return passed ? 0 : 1;
+}
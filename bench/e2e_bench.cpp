@@ -0,0 +1,370 @@
+// Runs the real driver core end to end without SteamVR (POSIX only): a StandIn hosts the driver
+// and its mock compositor, and a loopback client streams BodyPosition messages while reading the
+// frames back over TCP.
+//
+// Reports pose-in -> TrackedDevicePoseUpdated latency (client send to the HMD pose thread handing
+// that pose to the host) and frame throughput and latency at the client. With overlay layers the
+// compositor submits HUD panels on top of the eyes, which the driver blends in before sending.
+// With shm the client asks for the shared memory ring halfway through, so the second half's
+// frames are read from the ring and reported next to the first half's over TCP.
+//
+//   ovd_e2e_bench [seconds] [client pose Hz] [port] [overlay layers] [shm 0|1]
+
+#include "standin/stand_in.h"
+#include "socket/socket_manager.h"
+#include "frame/frame_metadata.h"
+#include "control/control.h"
+#include "shm/frame_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// Outside Windows the ring has no frame-ready event, so its reader polls
+static constexpr auto kRingPollInterval = std::chrono::microseconds(100);
+
+struct FrameStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    std::vector<uint64_t> latenciesUs;  // Present to fully received
+};
+
+struct RingStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t lapped = 0;  // Slots overwritten before they were read
+    // First pixel byte of each frame read, and when it was read
+    std::vector<std::pair<uint8_t, uint64_t>> tagsReadUs;
+};
+
+static uint64_t Percentile(std::vector<uint64_t> values, double fraction)
+{
+    if (values.empty())
+        return 0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static bool SendAll(int socket, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        ssize_t sent = send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool RecvAll(int socket, void* data, size_t size)
+{
+    return size == 0 || recv(socket, data, size, MSG_WAITALL) == static_cast<ssize_t>(size);
+}
+
+static int ConnectClient(uint16_t port)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+
+    // The driver's accept thread may not be listening the instant Init returns
+    for (int attempt = 0; attempt < 50; attempt++)
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            return client;
+        }
+        close(client);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return -1;
+}
+
+// Reads the shared ring like a same-host client: takes the newest unread slot, copies the pixels
+// out and checks the slot's sequence again in case the driver lapped it meanwhile
+static void ReadSharedRing(const SharedMemoryInfo& info, std::stop_token st, RingStats& stats)
+{
+    int fd = shm_open(info.mappingName, O_RDONLY, 0);
+    if (fd < 0)
+        return;
+    void* view = mmap(nullptr, info.mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return;
+
+    const uint8_t* base = static_cast<const uint8_t*>(view);
+    const auto* ring = reinterpret_cast<const FrameRingHeader*>(base);
+    std::vector<uint8_t> pixels(info.maxFrameBytes);
+    uint64_t lastSequence = ring->writeSequence.load(std::memory_order_acquire);
+    while (!st.stop_requested())
+    {
+        uint64_t writeSequence = ring->writeSequence.load(std::memory_order_acquire);
+        if (writeSequence == lastSequence)
+        {
+            std::this_thread::sleep_for(kRingPollInterval);
+            continue;
+        }
+
+        // More than a lap behind, the oldest slot still intact is the first one worth reading
+        uint64_t sequence = std::max(lastSequence + 1, writeSequence + 1 - std::min<uint64_t>(writeSequence, info.slotCount));
+        stats.lapped += sequence - lastSequence - 1;
+        lastSequence = sequence;
+
+        const auto* slot = reinterpret_cast<const FrameSlotHeader*>(base + sizeof(FrameRingHeader) + (sequence % info.slotCount) * info.slotStride);
+        if (slot->sequence.load(std::memory_order_acquire) != sequence)
+        {
+            stats.lapped++;
+            continue;
+        }
+        uint32_t size = std::min(slot->size, info.maxFrameBytes);
+        std::memcpy(pixels.data(), slot + 1, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            stats.lapped++;
+            continue;
+        }
+
+        stats.tagsReadUs.emplace_back(size > 0 ? pixels[0] : uint8_t{ 0 }, GetDriverTimeUs());
+        stats.frames++;
+        stats.bytes += size;
+    }
+    munmap(view, info.mappingSize);
+}
+
+// Ring frames carry no FrameMetadata. The mock compositor fills each frame's first row with the
+// low byte of its frame number, so a frame is timed from the newest Present with that byte
+static std::vector<uint64_t> MatchPresentTags(const std::vector<uint64_t>& presentCallsUs, const std::vector<std::pair<uint8_t, uint64_t>>& tagsReadUs)
+{
+    std::vector<uint64_t> latenciesUs;
+    for (const auto& [tag, readUs] : tagsReadUs)
+    {
+        size_t frame = std::upper_bound(presentCallsUs.begin(), presentCallsUs.end(), readUs) - presentCallsUs.begin();
+        while (frame > 0 && ((frame - 1) & 0xFF) != tag)
+            frame--;
+        if (frame > 0)
+            latenciesUs.push_back(readUs - presentCallsUs[frame - 1]);
+    }
+    return latenciesUs;
+}
+
+static void PrintLatency(const char* name, const std::vector<uint64_t>& latenciesUs)
+{
+    std::printf("  %-28s %8zu %8.2f %8.2f %8.2f %8.2f\n", name, latenciesUs.size(),
+                Percentile(latenciesUs, 0.5) / 1000.0, Percentile(latenciesUs, 0.9) / 1000.0,
+                Percentile(latenciesUs, 0.99) / 1000.0, Percentile(latenciesUs, 1.0) / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+    double poseRate = argc > 2 ? std::atof(argv[2]) : 90.0;
+    int port = argc > 3 ? std::atoi(argv[3]) : 21313;
+    uint32_t overlayLayers = argc > 4 ? static_cast<uint32_t>(std::atoi(argv[4])) : 0;
+    bool sharedMemory = argc > 5 && std::atoi(argv[5]) != 0;
+
+    // Head poses carry their sequence number in posZ, so the host can tell which one it was handed
+    size_t maxPoses = static_cast<size_t>(seconds * poseRate) + 64;
+    std::vector<std::atomic<uint64_t>> poseSentUs(maxPoses);
+    std::vector<uint64_t> poseLatenciesUs;
+    uint64_t lastPoseSequence = 0;
+
+    // Only the HMD's pose thread reports device 0, so the observer needs no lock for it
+    StandIn standIn([&](uint32_t deviceIndex, const vr::DriverPose_t& pose) {
+        if (deviceIndex != 0)
+            return;
+
+        uint64_t sequence = static_cast<uint64_t>(std::llround(pose.vecPosition[2]));
+        if (sequence > lastPoseSequence && sequence < maxPoses)
+        {
+            lastPoseSequence = sequence;
+            poseLatenciesUs.push_back(GetDriverTimeUs() - poseSentUs[sequence].load(std::memory_order_acquire));
+        }
+    });
+    if (!standIn.Start(static_cast<uint16_t>(port), overlayLayers))
+    {
+        std::printf("driver stand-in failed to start\n");
+        return 1;
+    }
+
+    int client = ConnectClient(static_cast<uint16_t>(port));
+    if (client < 0)
+    {
+        std::printf("could not connect to the driver on port %d\n", port);
+        return 1;
+    }
+
+    std::printf("client poses at %.0f Hz, HMD pose thread at %s Hz, %.0f s\n\n", poseRate,
+                control::Registry::Get().Execute("get pose.hmd_rate_hz").c_str(), seconds);
+
+    // The pose sender and the shared memory request share the socket
+    std::mutex sendMtx;
+
+    // Reads every message; frames are timed against their Present stamp
+    FrameStats frameStats;
+    std::promise<SharedMemoryInfo> ringInfo;
+    std::jthread receiver([&] {
+        std::vector<uint8_t> payload;
+        MsgHeader header;
+        while (RecvAll(client, &header, sizeof(header)))
+        {
+            payload.resize(header.size);
+            if (!RecvAll(client, payload.data(), header.size))
+                break;
+
+            if (header.type == MsgType::Frame && header.size >= sizeof(FrameInfo) + sizeof(FrameMetadata))
+            {
+                FrameMetadata metadata;
+                std::memcpy(&metadata, payload.data() + sizeof(FrameInfo), sizeof(metadata));
+                frameStats.latenciesUs.push_back(GetDriverTimeUs() - metadata.presentUs);
+                frameStats.frames++;
+                frameStats.bytes += header.size;
+            }
+            else if (header.type == MsgType::SharedMemoryInfo && header.size == sizeof(SharedMemoryInfo))
+            {
+                SharedMemoryInfo info;
+                std::memcpy(&info, payload.data(), sizeof(info));
+                ringInfo.set_value(info);
+            }
+        }
+    });
+
+    // The client: head plus both hands, so the controllers get registered and driven too
+    std::jthread poseSender([&](std::stop_token st) {
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / poseRate));
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t sequence = 1; sequence < maxPoses && !st.stop_requested(); sequence++)
+        {
+            BodyPosition body{};
+            body.head = Pose{ 0.0f, 1.7f, static_cast<float>(sequence), 1.0f, 0.0f, 0.0f, 0.0f };
+            body.leftHand = Pose{ -0.2f, 1.2f, -0.3f, 1.0f, 0.0f, 0.0f, 0.0f };
+            body.rightHand = Pose{ 0.2f, 1.2f, -0.3f, 1.0f, 0.0f, 0.0f, 0.0f };
+
+            MsgHeader header{ MsgType::BodyPosition, sizeof(body) };
+            poseSentUs[sequence].store(GetDriverTimeUs(), std::memory_order_release);
+            std::unique_lock<std::mutex> lock(sendMtx);
+            if (!SendAll(client, &header, sizeof(header)) || !SendAll(client, &body, sizeof(body)))
+                break;
+            lock.unlock();
+
+            std::this_thread::sleep_until(start + period * static_cast<int64_t>(sequence));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    RingStats ringStats;
+    double tcpElapsed = 0.0;
+    double ringElapsed = 0.0;
+    if (sharedMemory)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds / 2));
+        tcpElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        MockCompositor* compositor = standIn.GetCompositor();
+        SharedMemoryRequest request{ 0, compositor->GetEyeWidth() * compositor->GetEyeHeight() * 4 };
+        MsgHeader header{ MsgType::SharedMemoryRequest, sizeof(request) };
+        {
+            std::lock_guard<std::mutex> lock(sendMtx);
+            SendAll(client, &header, sizeof(header));
+            SendAll(client, &request, sizeof(request));
+        }
+
+        std::future<SharedMemoryInfo> reply = ringInfo.get_future();
+        if (reply.wait_until(start + std::chrono::duration<double>(seconds)) == std::future_status::ready)
+        {
+            SharedMemoryInfo info = reply.get();
+            if (info.slotCount == 0)
+                std::printf("shared memory unavailable, reporting TCP only\n\n");
+
+            auto ringStart = std::chrono::steady_clock::now();
+            std::jthread ringReader([&](std::stop_token st) {
+                if (info.slotCount > 0)
+                    ReadSharedRing(info, st, ringStats);
+            });
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(seconds));
+            ringReader.request_stop();
+            ringReader.join();
+            ringElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - ringStart).count();
+        }
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+    poseSender.request_stop();
+    poseSender.join();
+
+    MockVRHost& host = standIn.GetHost();
+    MockCompositor* compositor = standIn.GetCompositor();
+    uint64_t frameCount = compositor->GetPresentCount();
+    uint32_t deviceCount = host.GetDeviceCount();
+    std::vector<uint64_t> poseUpdates(deviceCount);
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        poseUpdates[i] = host.GetPoseUpdateCount(i);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Shutting the driver down closes the connection, which ends the receiver
+    standIn.Stop();
+    receiver.join();
+    close(client);
+
+    std::printf("  %-28s %8s %8s %8s %8s %8s\n", "latency (ms)", "count", "p50", "p90", "p99", "max");
+    PrintLatency("pose in -> pose updated", poseLatenciesUs);
+    PrintLatency("Present call", compositor->GetPresentTimesUs());
+    if (sharedMemory)
+    {
+        PrintLatency("Present -> TCP received", frameStats.latenciesUs);
+        PrintLatency("Present -> shm ring read", MatchPresentTags(compositor->GetPresentCallsUs(), ringStats.tagsReadUs));
+
+        std::printf("\n  %ux%u eyes: %.1f presents/s\n", compositor->GetEyeWidth(), compositor->GetEyeHeight(), frameCount / elapsed);
+        std::printf("  TCP, first %.1f s: %.1f eye frames/s, %.1f MB/s received\n", tcpElapsed,
+                    frameStats.frames / tcpElapsed, frameStats.bytes / tcpElapsed / 1e6);
+        if (ringElapsed > 0.0)
+        {
+            std::printf("  shm, last %.1f s: %.1f eye frames/s, %.1f MB/s read, %llu slots lapped\n", ringElapsed,
+                        ringStats.frames / ringElapsed, ringStats.bytes / ringElapsed / 1e6, static_cast<unsigned long long>(ringStats.lapped));
+        }
+    }
+    else
+    {
+        PrintLatency("Present -> client received", frameStats.latenciesUs);
+
+        std::printf("\n  %ux%u eyes: %.1f presents/s, %.1f eye frames/s, %.1f MB/s received\n", compositor->GetEyeWidth(), compositor->GetEyeHeight(),
+                    frameCount / elapsed, frameStats.frames / elapsed, frameStats.bytes / elapsed / 1e6);
+    }
+    if (overlayLayers > 0)
+    {
+        metrics::Registry& registry = metrics::Registry::Get();
+        std::printf("  %u overlays: %llu layers composited, %llu skipped, composite p50 %.2f ms\n", overlayLayers,
+                    static_cast<unsigned long long>(registry.GetCounter("present.layers_composited").Get()),
+                    static_cast<unsigned long long>(registry.GetCounter("present.layers_skipped").Get()),
+                    registry.GetHistogram("present.composite_us").GetSnapshot().GetQuantile(0.5) / 1000.0);
+    }
+    std::printf("  devices:");
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        std::printf(" %s (%.0f poses/s)", host.GetDeviceSerial(i), poseUpdates[i] / elapsed);
+    }
+    std::printf("\n");
+    return 0;
+}
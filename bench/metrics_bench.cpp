@@ -0,0 +1,49 @@
+// Cost of recording into the metrics registry from one or more threads.
+//
+//   ovd_metrics_bench [threads] [iterations]
+
+#include "metrics/metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+static double NanosecondsPerOp(uint32_t threads, uint64_t iterations, const std::function<void(uint64_t)>& op)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::jthread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&op, iterations] {
+            for (uint64_t i = 0; i < iterations; i++)
+                op(i);
+        });
+    }
+    workers.clear();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : std::max(std::thread::hardware_concurrency(), 1u);
+    uint64_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+
+    auto& registry = metrics::Registry::Get();
+    metrics::Counter& counter = registry.GetCounter("bench.counter");
+    metrics::Gauge& gauge = registry.GetGauge("bench.gauge");
+    metrics::Histogram& histogram = registry.GetHistogram("bench.histogram");
+    metrics::Histogram& timed = registry.GetHistogram("bench.timer_us");
+
+    std::printf("%u thread(s), ns per op per thread\n", threads);
+    std::printf("counter add      %6.2f\n", NanosecondsPerOp(threads, iterations, [&](uint64_t) { counter.Add(); }));
+    std::printf("gauge set        %6.2f\n", NanosecondsPerOp(threads, iterations, [&](uint64_t i) { gauge.Set(static_cast<int64_t>(i)); }));
+    std::printf("histogram record %6.2f\n", NanosecondsPerOp(threads, iterations, [&](uint64_t i) { histogram.Record(i & 0xFFFF); }));
+    std::printf("scoped timer     %6.2f\n", NanosecondsPerOp(threads, iterations / 10, [&](uint64_t) { metrics::ScopedTimer timer(timed); }));
+
+    uint64_t expected = static_cast<uint64_t>(threads) * iterations;
+    std::printf("counter total %s\n", counter.Get() == expected ? "ok" : "WRONG");
+    std::printf("\n%s", registry.FormatText().c_str());
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Drives the readback ring the way Present does, using the CPU mock backend, to check frame
+// ordering and lag for different ring depths and simulated GPU latencies.
+//
+//   ovd_readback_bench [frames]
+
+#include "readback/mock_readback.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+static constexpr uint32_t kTextureWidth = 3840;  // Both eyes side by side
+static constexpr uint32_t kTextureHeight = 1080;
+static constexpr uint64_t kTextureHandle = 1;
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 600;
+
+    std::vector<uint8_t> texture(static_cast<size_t>(kTextureWidth) * kTextureHeight * 4, 0x40);
+
+    std::printf("%5s %7s %9s %8s %8s %8s %9s %11s\n", "depth", "latency", "converted", "dropped", "max lag", "pairs", "ordered", "us/present");
+    for (uint32_t depth = 1; depth <= 3; depth++)
+    {
+        for (uint32_t latency = 0; latency <= 2; latency++)
+        {
+            MockReadback readback(depth, latency);
+            readback.RegisterTexture(kTextureHandle, texture.data(), kTextureWidth * 4, kTextureWidth, kTextureHeight, SourceFormat::Bgra8);
+
+            uint64_t lastIndex[2] = { UINT64_MAX, UINT64_MAX };
+            uint64_t maxLag = 0;
+            uint64_t pairs = 0;
+            bool ordered = true;
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t frame = 0; frame < frames; frame++)
+            {
+                for (uint32_t eye = 0; eye < 2; eye++)
+                {
+                    float uMin = eye == 0 ? 0.0f : 0.5f;
+                    readback.Submit(ReadbackRequest{ kTextureHandle, uMin, 0.0f, uMin + 0.5f, 1.0f, eye, frame, 0 });
+                }
+
+                uint64_t acquired[2] = { UINT64_MAX, UINT64_MAX };
+                for (uint32_t eye = 0; eye < 2; eye++)
+                {
+                    auto result = readback.Acquire(eye);
+                    if (!result)
+                        continue;
+
+                    if (lastIndex[eye] != UINT64_MAX && result->frameIndex <= lastIndex[eye])
+                        ordered = false;
+                    if (result->width != kTextureWidth / 2 || result->height != kTextureHeight)
+                        ordered = false;
+                    lastIndex[eye] = result->frameIndex;
+                    acquired[eye] = result->frameIndex;
+                    maxLag = std::max(maxLag, frame - result->frameIndex);
+                    readback.Release(eye);
+                }
+                if (acquired[0] != UINT64_MAX && acquired[0] == acquired[1])
+                    pairs++;
+            }
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+            ReadbackStats stats = readback.GetStats();
+            std::printf("%5u %7u %9llu %8llu %8llu %8llu %9s %11.1f\n", depth, latency,
+                        static_cast<unsigned long long>(stats.completed), static_cast<unsigned long long>(stats.dropped),
+                        static_cast<unsigned long long>(maxLag), static_cast<unsigned long long>(pairs),
+                        ordered ? "yes" : "NO", us);
+        }
+    }
+    return 0;
+}
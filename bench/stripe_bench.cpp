@@ -0,0 +1,144 @@
+// Measures how Present's per-eye crop/convert scales with worker threads.
+// Uses a synthetic buffer shaped like a mapped staging texture, so it runs without D3D or SteamVR.
+// First checks that striped output matches serial output byte for byte on random layouts with
+// odd sizes, every source and output format and resampling. Exits with 1 if any layout differs.
+//
+//   ovd_stripe_bench [maxThreads] [frames]
+
+#include "frame/eye_writer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Scenario {
+    const char* name;
+    SourceFormat sourceFormat;
+    PixelFormat format;
+    uint32_t width;   // 0 keeps the eye's size
+    uint32_t height;
+};
+
+static constexpr uint32_t kEyeWidth = 1920;
+static constexpr uint32_t kEyeHeight = 1080;
+// D3D11 row pitches are padded; use something that is not a multiple of the row size
+static constexpr uint32_t kRowPitch = kEyeWidth * 2 * 4 + 256;
+
+// Enough threads that even short eyes are cut into several stripes of uneven height
+static constexpr uint32_t kCheckThreads = 8;
+static constexpr uint32_t kCheckLayouts = 200;
+
+static const char* const kSourceFormatNames[] = { "bgra8", "rgba8", "rgb10a2" };
+static const char* const kFormatNames[] = { "bgra8", "rgba8", "rgb8", "i420", "nv12", "gray8", "rgba16f" };
+
+static EyeLayout MakeRandomLayout(std::mt19937& rng)
+{
+    auto random = [&](uint32_t min, uint32_t max) { return std::uniform_int_distribution<uint32_t>(min, max)(rng); };
+
+    EyeLayout layout;
+    layout.source.width = random(1, 700);
+    layout.source.height = random(1, 400);
+    layout.source.x = random(0, kEyeWidth * 2 - layout.source.width);
+    layout.source.y = random(0, kEyeHeight - layout.source.height);
+    layout.sourceFormat = static_cast<SourceFormat>(random(0, 2));
+    layout.format = static_cast<PixelFormat>(random(0, 6));
+    layout.filter = static_cast<ResampleFilter>(random(0, 1));
+    layout.resample = random(0, 1) != 0;
+    layout.width = layout.resample ? random(1, 600) : layout.source.width;
+    layout.height = layout.resample ? random(1, 400) : layout.source.height;
+    return layout;
+}
+
+// Writes each layout with one thread and with kCheckThreads into buffers prefilled differently,
+// so a row no stripe wrote shows up as well as one written wrong
+static bool StripedMatchesSerial(const std::vector<uint8_t>& mapped)
+{
+    WorkerPool serial(0);
+    WorkerPool striped(kCheckThreads - 1);
+    std::mt19937 rng(2);
+
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < kCheckLayouts; i++)
+    {
+        EyeLayout layout = MakeRandomLayout(rng);
+        size_t size = GetPixelFormatSize(layout.format, layout.width, layout.height);
+        std::vector<uint8_t> expected(size, 0x00), actual(size, 0xFF);
+        WriteEye(serial, mapped.data(), kRowPitch, layout, expected.data());
+        WriteEye(striped, mapped.data(), kRowPitch, layout, actual.data());
+        if (expected == actual)
+            continue;
+
+        failures++;
+        std::printf("striped output differs: %ux%u+%u+%u %s -> %ux%u %s%s\n", layout.source.width, layout.source.height,
+                    layout.source.x, layout.source.y, kSourceFormatNames[static_cast<uint32_t>(layout.sourceFormat)],
+                    layout.width, layout.height, kFormatNames[static_cast<uint32_t>(layout.format)],
+                    layout.resample ? (layout.filter == ResampleFilter::Box ? " box" : " bilinear") : "");
+    }
+    std::printf("%u random layouts, striped on %u threads vs serial: %s\n\n", kCheckLayouts, kCheckThreads, failures ? "DIFFERS" : "exact");
+    return failures == 0;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t frames = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 60;
+
+    // Both eyes side by side in one texture, like a single shared swapchain image
+    std::vector<uint8_t> mapped(static_cast<size_t>(kRowPitch) * kEyeHeight);
+    std::mt19937 rng(1);
+    for (auto& byte : mapped)
+        byte = static_cast<uint8_t>(rng());
+
+    bool passed = StripedMatchesSerial(mapped);
+
+    const Scenario scenarios[] = {
+        { "bgra8 crop",             SourceFormat::Bgra8,   PixelFormat::Bgra8, 0, 0 },
+        { "bgra8 -> i420",          SourceFormat::Bgra8,   PixelFormat::I420,  0, 0 },
+        { "bgra8 -> 960x540 rgb8",  SourceFormat::Bgra8,   PixelFormat::Rgb8,  960, 540 },
+        { "rgb10a2 -> bgra8",       SourceFormat::Rgb10A2, PixelFormat::Bgra8, 0, 0 },
+        { "rgb10a2 -> rgba16f",     SourceFormat::Rgb10A2, PixelFormat::Rgba16F, 0, 0 },
+    };
+
+    std::printf("%-24s %8s %12s %10s\n", "scenario", "threads", "ms/frame", "speedup");
+    for (const Scenario& scenario : scenarios)
+    {
+        double baseline = 0.0;
+        for (uint32_t threads = 1; threads <= maxThreads; threads++)
+        {
+            WorkerPool pool(threads - 1);
+
+            EyeLayout layouts[2];
+            std::vector<uint8_t> outputs[2];
+            for (uint32_t eye = 0; eye < 2; eye++)
+            {
+                EyeLayout& layout = layouts[eye];
+                layout.source = { eye * kEyeWidth, 0, kEyeWidth, kEyeHeight };
+                layout.width = scenario.width ? scenario.width : kEyeWidth;
+                layout.height = scenario.height ? scenario.height : kEyeHeight;
+                layout.filter = ResampleFilter::Bilinear;
+                layout.sourceFormat = scenario.sourceFormat;
+                layout.format = scenario.format;
+                layout.resample = layout.width != kEyeWidth || layout.height != kEyeHeight;
+                outputs[eye].resize(GetPixelFormatSize(layout.format, layout.width, layout.height));
+            }
+
+            auto frame = [&] {
+                for (uint32_t eye = 0; eye < 2; eye++)
+                    WriteEye(pool, mapped.data(), kRowPitch, layouts[eye], outputs[eye].data());
+            };
+
+            frame(); // Warm up scratch buffers and page in the outputs
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < frames; i++)
+                frame();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+            if (threads == 1)
+                baseline = ms;
+            std::printf("%-24s %8u %12.3f %9.2fx\n", scenario.name, threads, ms, baseline / ms);
+        }
+    }
+    return passed ? 0 : 1;
+}
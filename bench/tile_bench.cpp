@@ -0,0 +1,191 @@
+// Compares bytes on the wire for Raw, DeltaRle and Tiles coding of a session, and checks
+// that tile updates rebuild the frames exactly.
+//
+//   ovd_tile_bench [recording...]
+//
+// A recording is a dump of Frame messages as the driver sends them with CODEC_RAW
+// (see Client.record_frames in the Python client). Without one, synthetic sessions are used.
+
+#include "codec/frame_codec.h"
+#include "frame/frame_metadata.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Session {
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t frameCount;
+    // Fills frame i, pixels still holds frame i - 1
+    std::function<void(uint32_t frame, std::vector<uint8_t>& pixels)> render;
+};
+
+static constexpr uint32_t kEyeWidth = 1920;
+static constexpr uint32_t kEyeHeight = 1080;
+static constexpr uint32_t kSyntheticFrames = 270;  // Three seconds at 90 Hz
+
+static void FillNoise(std::vector<uint8_t>& pixels, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        uint32_t v = rng();
+        std::memcpy(&pixels[i], &v, 4);
+        pixels[i + 3] = 0xFF;
+    }
+}
+
+static void FillRect(std::vector<uint8_t>& pixels, uint32_t width, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+{
+    for (uint32_t row = y; row < y + h; row++)
+        for (uint32_t col = x; col < x + w; col++)
+            std::memcpy(&pixels[(static_cast<size_t>(row) * width + col) * 4], &color, 4);
+}
+
+static std::vector<Session> SyntheticSessions()
+{
+    std::vector<Session> sessions;
+
+    // Static menu with a small cursor drifting across it
+    sessions.push_back({ "menu + cursor", kEyeWidth, kEyeHeight, kSyntheticFrames, [](uint32_t frame, std::vector<uint8_t>& pixels) {
+        static std::vector<uint8_t> background;
+        if (frame == 0)
+        {
+            background.resize(pixels.size());
+            FillNoise(background, 1);
+        }
+        pixels = background;
+        FillRect(pixels, kEyeWidth, 400 + frame * 3, 300 + frame, 16, 16, 0xFFFFFFFF);
+    } });
+
+    // Loading screen, only a spinner in the middle changes
+    sessions.push_back({ "loading spinner", kEyeWidth, kEyeHeight, kSyntheticFrames, [](uint32_t frame, std::vector<uint8_t>& pixels) {
+        if (frame == 0)
+            FillRect(pixels, kEyeWidth, 0, 0, kEyeWidth, kEyeHeight, 0xFF101010);
+        FillRect(pixels, kEyeWidth, 896, 476, 128, 128, 0xFF101010);
+        FillRect(pixels, kEyeWidth, 896 + (frame % 8) * 14, 476 + (frame % 8) * 14, 16, 16, 0xFFE0E0E0);
+    } });
+
+    // Scene held still most of the time, with a short burst of motion every second
+    sessions.push_back({ "mostly still", kEyeWidth, kEyeHeight, kSyntheticFrames, [](uint32_t frame, std::vector<uint8_t>& pixels) {
+        if (frame == 0 || frame % 90 < 10)
+            FillNoise(pixels, frame + 2);
+    } });
+
+    // Everything moves, the worst case for tiles
+    sessions.push_back({ "full motion", kEyeWidth, kEyeHeight, kSyntheticFrames, [](uint32_t frame, std::vector<uint8_t>& pixels) {
+        FillNoise(pixels, frame + 1000);
+    } });
+
+    return sessions;
+}
+
+// Raw BGRA/RGBA frames of the left eye from a dump of Frame messages
+static bool LoadRecording(const char* path, Session& session, std::vector<std::vector<uint8_t>>& frames)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    uint32_t header[2];
+    while (file.read(reinterpret_cast<char*>(header), sizeof(header)))
+    {
+        std::vector<uint8_t> payload(header[1]);
+        if (!file.read(reinterpret_cast<char*>(payload.data()), payload.size()))
+            break;
+
+        // MsgType::Frame followed by FrameInfo { width, height, eye, codec, format } and FrameMetadata
+        uint32_t info[5];
+        size_t headerSize = sizeof(info) + sizeof(FrameMetadata);
+        if (header[0] != 0 || payload.size() < headerSize)
+            continue;
+        std::memcpy(info, payload.data(), sizeof(info));
+        bool fourByteRaw = info[3] == 0 && (info[4] == 0 || info[4] == 1);
+        size_t size = static_cast<size_t>(info[0]) * info[1] * 4;
+        if (info[2] != 0 || !fourByteRaw || payload.size() != headerSize + size)
+            continue;
+        if (!frames.empty() && (info[0] != session.width || info[1] != session.height))
+            continue;
+
+        session.width = info[0];
+        session.height = info[1];
+        frames.emplace_back(payload.begin() + headerSize, payload.end());
+    }
+
+    session.name = path;
+    session.frameCount = static_cast<uint32_t>(frames.size());
+    return !frames.empty();
+}
+
+static void Run(const Session& session)
+{
+    FrameEncoder delta;
+    FrameEncoder tiles;
+    std::vector<uint8_t> pixels(static_cast<size_t>(session.width) * session.height * 4, 0);
+    std::vector<uint8_t> decoded(pixels.size(), 0);
+
+    uint64_t rawBytes = 0;
+    uint64_t deltaBytes = 0;
+    uint64_t tileBytes = 0;
+    uint32_t skipped = 0;
+    bool exact = true;
+
+    for (uint32_t frame = 0; frame < session.frameCount; frame++)
+    {
+        session.render(frame, pixels);
+        rawBytes += pixels.size();
+
+        deltaBytes += delta.Encode(FrameCodec::DeltaRle, pixels.data(), pixels.size(), session.width, session.height, 0).size;
+
+        auto encoded = tiles.Encode(FrameCodec::Tiles, pixels.data(), pixels.size(), session.width, session.height, 0);
+        if (encoded.unchanged)
+        {
+            skipped++;
+            continue;
+        }
+        tileBytes += encoded.size;
+
+        if (encoded.codec == FrameCodec::Raw)
+            std::memcpy(decoded.data(), encoded.data, encoded.size);
+        else if (!codec::DecodeTiles(encoded.data, encoded.size, session.width, session.height, decoded.data()))
+            exact = false;
+        if (decoded != pixels)
+            exact = false;
+    }
+
+    double mb = 1024.0 * 1024.0;
+    std::printf("%-20s %6u %10.1f %10.1f %10.1f %7.1f%% %8u %6s\n", session.name.c_str(), session.frameCount,
+                rawBytes / mb, deltaBytes / mb, tileBytes / mb, 100.0 * (1.0 - static_cast<double>(tileBytes) / rawBytes),
+                skipped, exact ? "yes" : "NO");
+}
+
+int main(int argc, char** argv)
+{
+    std::printf("%-20s %6s %10s %10s %10s %8s %8s %6s\n", "session", "frames", "raw MB", "delta MB", "tiles MB", "saved", "skipped", "exact");
+
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            Session session{ "", 0, 0, 0, nullptr };
+            std::vector<std::vector<uint8_t>> frames;
+            if (!LoadRecording(argv[i], session, frames))
+            {
+                std::fprintf(stderr, "No raw left eye frames in %s\n", argv[i]);
+                continue;
+            }
+            session.render = [&frames](uint32_t frame, std::vector<uint8_t>& pixels) { pixels = frames[frame]; };
+            Run(session);
+        }
+        return 0;
+    }
+
+    for (const auto& session : SyntheticSessions())
+        Run(session);
+    return 0;
+}
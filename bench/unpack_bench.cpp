@@ -0,0 +1,164 @@
+// Checks every unpack kernel this CPU can run byte for byte against the scalar reference on
+// packed 10:10:10:2 and 8-bit patterns, including row lengths that leave a tail after the
+// vector loop, checks that 10-bit -> half keeps every 10-bit value, and reports throughput.
+// Exits with 1 if any check fails.
+//
+//   ovd_unpack_bench [frames]
+
+#include "image/unpack.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr uint32_t kEyeWidth = 1920;
+static constexpr uint32_t kEyeHeight = 1080;
+// Longer than any vector width, so every tail length is covered for every kernel
+static constexpr uint32_t kMaxTailRow = 67;
+
+static uint32_t PackRgb10A2(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    return (r & 0x3FF) | ((g & 0x3FF) << 10) | ((b & 0x3FF) << 20) | ((a & 3) << 30);
+}
+
+// Every 10-bit value in each channel, each alpha, then random words for the mixed bit patterns
+static std::vector<uint8_t> MakeRgb10A2Pattern(size_t pixels)
+{
+    std::vector<uint8_t> bytes(pixels * 4);
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < pixels; i++)
+    {
+        uint32_t v = i < 4096
+            ? PackRgb10A2(static_cast<uint32_t>(i), static_cast<uint32_t>(i * 7 + 3), static_cast<uint32_t>(1023 - i), static_cast<uint32_t>(i >> 10))
+            : static_cast<uint32_t>(rng());
+        std::memcpy(&bytes[i * 4], &v, 4);
+    }
+    return bytes;
+}
+
+static float HalfToFloat(uint16_t half)
+{
+    uint32_t exponent = (half >> 10) & 0x1F;
+    float mantissa = static_cast<float>(half & 0x3FF);
+    float value = exponent == 0 ? std::ldexp(mantissa, -24) : std::ldexp(1024.0f + mantissa, static_cast<int>(exponent) - 25);
+    return half & 0x8000 ? -value : value;
+}
+
+// Each row length from 1 to kMaxTailRow, at every offset a row could start at in the pattern
+template<typename Fn>
+static bool ForEachTailRow(const std::vector<uint8_t>& pattern, Fn&& check)
+{
+    for (uint32_t count = 1; count <= kMaxTailRow; count++)
+    {
+        for (size_t start = 0; start + count <= pattern.size() / 4; start += 4099)
+        {
+            if (!check(pattern.data() + start * 4, count))
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool MatchesBgra8(const UnpackKernels& reference, const UnpackKernels& kernels, const std::vector<uint8_t>& pattern)
+{
+    return ForEachTailRow(pattern, [&](const uint8_t* src, uint32_t count) {
+        std::vector<uint8_t> expected(count * 4), actual(count * 4);
+        reference.rgb10a2ToBgra8(src, expected.data(), count);
+        kernels.rgb10a2ToBgra8(src, actual.data(), count);
+        return expected == actual;
+    });
+}
+
+static bool MatchesHalf(const UnpackKernels& reference, const UnpackKernels& kernels, const std::vector<uint8_t>& pattern)
+{
+    return ForEachTailRow(pattern, [&](const uint8_t* src, uint32_t count) {
+        std::vector<uint16_t> expected(count * 4), actual(count * 4);
+        reference.rgb10a2ToHalf(src, expected.data(), count);
+        kernels.rgb10a2ToHalf(src, actual.data(), count);
+        if (expected != actual)
+            return false;
+        for (bool bgra : { true, false })
+        {
+            reference.rgba8ToHalf(src, expected.data(), count, bgra);
+            kernels.rgba8ToHalf(src, actual.data(), count, bgra);
+            if (expected != actual)
+                return false;
+        }
+        return true;
+    });
+}
+
+// Half has 11 significant bits, enough to bring every 10-bit value back exactly
+static bool RoundTripsHalf(const UnpackKernels& kernels, const std::vector<uint8_t>& pattern)
+{
+    uint32_t count = static_cast<uint32_t>(pattern.size() / 4);
+    std::vector<uint16_t> halves(static_cast<size_t>(count) * 4);
+    kernels.rgb10a2ToHalf(pattern.data(), halves.data(), count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t p;
+        std::memcpy(&p, &pattern[static_cast<size_t>(i) * 4], 4);
+        const uint16_t* h = &halves[static_cast<size_t>(i) * 4];
+        if (std::lround(HalfToFloat(h[0]) * 1023.0f) != static_cast<long>(p & 0x3FF) ||
+            std::lround(HalfToFloat(h[1]) * 1023.0f) != static_cast<long>((p >> 10) & 0x3FF) ||
+            std::lround(HalfToFloat(h[2]) * 1023.0f) != static_cast<long>((p >> 20) & 0x3FF) ||
+            std::lround(HalfToFloat(h[3]) * 3.0f) != static_cast<long>(p >> 30))
+            return false;
+    }
+    return true;
+}
+
+template<typename Fn>
+static double MeasureNsPerPixel(uint32_t frames, Fn&& unpackFrame)
+{
+    unpackFrame();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++)
+        unpackFrame();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / frames / (static_cast<double>(kEyeWidth) * kEyeHeight);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 30;
+
+    std::vector<uint8_t> pattern = MakeRgb10A2Pattern(static_cast<size_t>(kEyeWidth) * kEyeHeight);
+    std::vector<uint8_t> bgra(pattern.size());
+    std::vector<uint16_t> halves(pattern.size());
+
+    std::vector<UnpackKernels> variants = GetUnpackKernelVariants();
+    const UnpackKernels& reference = variants.front();
+
+    std::printf("%ux%u packed 10:10:10:2, tails 1..%u px\n", kEyeWidth, kEyeHeight, kMaxTailRow);
+    std::printf("%-12s %10s %10s %10s %12s %12s %12s\n", "kernels", "bgra8", "half", "round trip", "bgra8 ns/px", "half ns/px", "rgba8 ns/px");
+
+    bool passed = true;
+    for (const UnpackKernels& kernels : variants)
+    {
+        bool bgraExact = MatchesBgra8(reference, kernels, pattern);
+        bool halfExact = MatchesHalf(reference, kernels, pattern);
+        bool roundTrip = RoundTripsHalf(kernels, pattern);
+        passed = passed && bgraExact && halfExact && roundTrip;
+
+        double bgraNs = MeasureNsPerPixel(frames, [&] {
+            for (uint32_t y = 0; y < kEyeHeight; y++)
+                kernels.rgb10a2ToBgra8(&pattern[static_cast<size_t>(y) * kEyeWidth * 4], &bgra[static_cast<size_t>(y) * kEyeWidth * 4], kEyeWidth);
+        });
+        double halfNs = MeasureNsPerPixel(frames, [&] {
+            for (uint32_t y = 0; y < kEyeHeight; y++)
+                kernels.rgb10a2ToHalf(&pattern[static_cast<size_t>(y) * kEyeWidth * 4], &halves[static_cast<size_t>(y) * kEyeWidth * 4], kEyeWidth);
+        });
+        double rgbaNs = MeasureNsPerPixel(frames, [&] {
+            for (uint32_t y = 0; y < kEyeHeight; y++)
+                kernels.rgba8ToHalf(&pattern[static_cast<size_t>(y) * kEyeWidth * 4], &halves[static_cast<size_t>(y) * kEyeWidth * 4], kEyeWidth, true);
+        });
+
+        std::printf("%-12s %10s %10s %10s %12.3f %12.3f %12.3f\n", kernels.name, bgraExact ? "exact" : "DIFFERS",
+                    halfExact ? "exact" : "DIFFERS", roundTrip ? "yes" : "NO", bgraNs, halfNs, rgbaNs);
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,343 @@
+#include "driver_client.h"
+#include <algorithm>
+#include <cstring>
+
+// Matches the driver's send buffer so a whole eye can be in flight
+static constexpr int kReceiveBufferSize = 8 * 1024 * 1024;
+
+static bool IsFrame(MsgType type)
+{
+    return type == MsgType::Frame || type == MsgType::StereoFrame;
+}
+
+// Eyes a frame message carries, and which of them decode without the previous frame of that eye.
+// DeltaRle and Tiles keyframes arrive as Qoi and Raw, so those two always stand alone
+struct FrameEyes {
+    uint32_t present = 0;
+    uint32_t standalone = 0;
+};
+
+static FrameEyes GetFrameEyes(const ClientMessage& message)
+{
+    FrameEyes eyes;
+    auto add = [&](const FrameInfo& info) {
+        uint32_t bit = 1u << (info.eye & 1);
+        eyes.present |= bit;
+        if (info.codec == FrameCodec::Raw || info.codec == FrameCodec::Qoi)
+            eyes.standalone |= bit;
+    };
+    if (message.type == MsgType::Frame && message.head.size() >= sizeof(FrameInfo))
+    {
+        FrameInfo info;
+        std::memcpy(&info, message.head.data(), sizeof(info));
+        add(info);
+    }
+    else if (message.type == MsgType::StereoFrame && message.head.size() >= sizeof(StereoFrameInfo))
+    {
+        StereoFrameInfo info;
+        std::memcpy(&info, message.head.data(), sizeof(info));
+        add(info.eyes[0]);
+        add(info.eyes[1]);
+    }
+    return eyes;
+}
+
+static bool RecvAll(SOCKET socket, void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0)
+    {
+        int received = recv(socket, bytes, static_cast<int>(std::min<size_t>(size, INT32_MAX)), MSG_WAITALL);
+        if (received <= 0)
+            return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+DriverClient::DriverClient(uint32_t frameQueueDepth, bool blockWhenFull) :
+    m_frameQueueDepth(std::max(frameQueueDepth, 1u)),
+    m_blockWhenFull(blockWhenFull)
+{}
+
+DriverClient::~DriverClient()
+{
+    Disconnect();
+}
+
+bool DriverClient::Connect(const std::string& host, uint16_t port)
+{
+    Disconnect();
+    if (!net::Startup())
+        return false;
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    SOCKET client = INVALID_SOCKET;
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) == 1)
+        client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (client == INVALID_SOCKET || connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+    {
+        if (client != INVALID_SOCKET)
+            net::Close(client);
+        net::Cleanup();
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    setsockopt(client, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&kReceiveBufferSize), sizeof(kReceiveBufferSize));
+
+    m_socket = client;
+    m_connected = true;
+    m_framesDropped = 0;
+    m_receiveThread = std::jthread([this](std::stop_token st) { ReceiveThreadFunc(st); });
+    return true;
+}
+
+void DriverClient::Disconnect()
+{
+    if (m_socket == INVALID_SOCKET)
+        return;
+
+    m_receiveThread.request_stop();
+    net::Shutdown(m_socket);
+    if (m_receiveThread.joinable())
+        m_receiveThread.join();
+    {
+        // The shutdown above fails any send in progress; later ones see the invalid socket
+        std::lock_guard<std::mutex> lock(m_sendMtx);
+        net::Close(m_socket);
+        m_socket = INVALID_SOCKET;
+        m_sendQueue.clear();
+    }
+    net::Cleanup();
+
+    // Released outside the lock, provided buffers may call back into their owner
+    std::deque<ClientMessage> messages;
+    std::vector<ProvidedBuffer> provided;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        messages.swap(m_messages);
+        provided.swap(m_provided);
+        m_queuedFrames = 0;
+        m_haptics.clear();
+    }
+}
+
+std::optional<ClientMessage> DriverClient::Receive(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_cv.wait_for(lock, timeout, [this] { return !m_messages.empty() || !m_connected; });
+    if (m_messages.empty())
+        return std::nullopt;
+
+    ClientMessage message = std::move(m_messages.front());
+    m_messages.pop_front();
+    if (IsFrame(message.type))
+    {
+        m_queuedFrames--;
+        m_cv.notify_all();
+    }
+    return message;
+}
+
+std::vector<Haptic> DriverClient::TakeHaptics()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::vector<Haptic> haptics(m_haptics.begin(), m_haptics.end());
+    m_haptics.clear();
+    return haptics;
+}
+
+void DriverClient::ProvideBuffer(ProvidedBuffer buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_provided.push_back(std::move(buffer));
+}
+
+bool DriverClient::SendAll(net::Buffer* buffers, uint32_t count)
+{
+    while (count > 0)
+    {
+        int64_t result = net::SendGathered(m_socket, buffers, count);
+        if (result <= 0)
+            return false;
+
+        // Skip buffers that were fully written, then trim the partially written one
+        size_t sent = static_cast<size_t>(result);
+        while (count > 0 && sent >= net::GetBufferSize(*buffers))
+        {
+            sent -= net::GetBufferSize(*buffers);
+            ++buffers;
+            --count;
+        }
+        if (count > 0)
+            net::AdvanceBuffer(*buffers, sent);
+    }
+    return true;
+}
+
+bool DriverClient::Send(MsgType type, const void* data, uint32_t size)
+{
+    if (!m_connected)
+        return false;
+
+    MsgHeader header { type, size };
+    net::Buffer buffers[2] = {
+        net::MakeBuffer(&header, sizeof(header)),
+        net::MakeBuffer(data, size)
+    };
+    std::lock_guard<std::mutex> lock(m_sendMtx);
+    return m_socket != INVALID_SOCKET && SendAll(buffers, size > 0 ? 2 : 1);
+}
+
+void DriverClient::Queue(MsgType type, const void* data, uint32_t size)
+{
+    MsgHeader header { type, size };
+    const auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    std::lock_guard<std::mutex> lock(m_sendMtx);
+    m_sendQueue.insert(m_sendQueue.end(), headerBytes, headerBytes + sizeof(header));
+    m_sendQueue.insert(m_sendQueue.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+}
+
+bool DriverClient::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_sendMtx);
+    if (m_sendQueue.empty())
+        return true;
+
+    net::Buffer buffer = net::MakeBuffer(m_sendQueue.data(), m_sendQueue.size());
+    bool sent = m_connected && m_socket != INVALID_SOCKET && SendAll(&buffer, 1);
+    m_sendQueue.clear();
+    return sent;
+}
+
+bool DriverClient::ReadFrame(const MsgHeader& header, size_t headSize, ClientMessage& message)
+{
+    if (header.size < headSize)
+        return false;
+
+    message.head.resize(headSize);
+    if (!RecvAll(m_socket, message.head.data(), headSize))
+        return false;
+
+    message.pixelSize = header.size - headSize;
+    if (message.pixelSize == 0)
+        return true;
+
+    uint8_t* pixels = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto fits = std::find_if(m_provided.begin(), m_provided.end(), [&](const ProvidedBuffer& buffer) { return buffer.capacity >= message.pixelSize; });
+        if (fits != m_provided.end())
+        {
+            pixels = fits->data;
+            message.provided = std::move(fits->owner);
+            message.providedCapacity = fits->capacity;
+            m_provided.erase(fits);
+        }
+    }
+    if (!pixels)
+    {
+        message.pooled = FrameBufferPool::Shared().Acquire(message.pixelSize);
+        pixels = message.pooled.GetMutableData();
+    }
+
+    message.pixels = pixels;
+    return RecvAll(m_socket, pixels, message.pixelSize);
+}
+
+std::deque<ClientMessage>::iterator DriverClient::FindDroppableFrame(const ClientMessage& incoming)
+{
+    for (auto frame = m_messages.begin(); frame != m_messages.end(); ++frame)
+    {
+        if (!IsFrame(frame->type))
+            continue;
+
+        // Each eye's next frame, queued or just received, must not decode against this one. An
+        // eye with no later frame yet could still get a delta, so that keeps the frame too
+        uint32_t pending = GetFrameEyes(*frame).present;
+        bool droppable = true;
+        for (auto later = std::next(frame); pending != 0 && droppable; ++later)
+        {
+            const ClientMessage& next = later == m_messages.end() ? incoming : *later;
+            if (IsFrame(next.type))
+            {
+                FrameEyes eyes = GetFrameEyes(next);
+                droppable = (eyes.present & pending & ~eyes.standalone) == 0;
+                pending &= ~eyes.present;
+            }
+            if (later == m_messages.end())
+                break;
+        }
+        if (droppable && pending == 0)
+            return frame;
+    }
+    return m_messages.end();
+}
+
+void DriverClient::ReceiveThreadFunc(std::stop_token st)
+{
+    MsgHeader header;
+    while (!st.stop_requested() && RecvAll(m_socket, &header, sizeof(header)))
+    {
+        ClientMessage message { header.type, {}, nullptr, 0, {}, {}, 0 };
+        bool received;
+        if (header.type == MsgType::Frame)
+            received = ReadFrame(header, sizeof(FrameInfo) + sizeof(FrameMetadata), message);
+        else if (header.type == MsgType::StereoFrame)
+            received = ReadFrame(header, sizeof(StereoFrameInfo) + sizeof(FrameMetadata), message);
+        else
+        {
+            message.head.resize(header.size);
+            received = RecvAll(m_socket, message.head.data(), header.size);
+        }
+        if (!received)
+            break;
+
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (header.type == MsgType::Haptic)
+        {
+            if (message.head.size() >= sizeof(Haptic))
+            {
+                Haptic haptic;
+                std::memcpy(&haptic, message.head.data(), sizeof(haptic));
+                if (m_haptics.size() == kMaxHaptics)
+                    m_haptics.pop_front();
+                m_haptics.push_back(haptic);
+            }
+            continue;
+        }
+
+        if (IsFrame(header.type) && m_queuedFrames >= m_frameQueueDepth)
+        {
+            // Latest wins: drop the oldest unclaimed frame nothing decodes against, a lent buffer
+            // goes back to be reused
+            auto dropped = m_blockWhenFull ? m_messages.end() : FindDroppableFrame(message);
+            if (dropped != m_messages.end())
+            {
+                if (dropped->provided)
+                    m_provided.push_back(ProvidedBuffer{ const_cast<uint8_t*>(dropped->pixels), dropped->providedCapacity, std::move(dropped->provided) });
+                m_messages.erase(dropped);
+                m_queuedFrames--;
+                m_framesDropped++;
+            }
+            // Stop reading until the consumer catches up, TCP pushes back from there
+            else if (!m_cv.wait(lock, st, [this] { return m_queuedFrames < m_frameQueueDepth; }))
+            {
+                break;
+            }
+        }
+        if (IsFrame(header.type))
+            m_queuedFrames++;
+        m_messages.push_back(std::move(message));
+        m_cv.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_connected = false;
+    m_cv.notify_all();
+}
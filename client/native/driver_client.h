@@ -0,0 +1,106 @@
+#pragma once
+
+// Native client for the driver's TCP protocol. A receive thread reads each message as it arrives:
+// frame pixels go straight from the socket into page-aligned pooled buffers, or into buffers the
+// caller lent with ProvideBuffer, and are handed out in arrival order without another copy.
+// Haptics are set aside so they can be polled without reading past queued frames. Poses and
+// inputs can be queued and sent together in one gathered write.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "socket/socket_manager.h"
+#include "frame/frame_buffer_pool.h"
+
+// Memory the caller lends for frame pixels. owner is dropped once the frame read into it is
+// released, or on Disconnect if no frame was
+struct ProvidedBuffer {
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    std::shared_ptr<void> owner;
+};
+
+struct ClientMessage {
+    MsgType type;
+    // The whole payload, except for Frame and StereoFrame where it is the FrameInfo or
+    // StereoFrameInfo and FrameMetadata in front of the pixels
+    std::vector<uint8_t> head;
+    // Frame and StereoFrame pixels, in a pooled buffer or a provided one
+    const uint8_t* pixels = nullptr;
+    size_t pixelSize = 0;
+    FrameBufferRef pooled;
+    std::shared_ptr<void> provided;
+    size_t providedCapacity = 0;
+};
+
+class DriverClient
+{
+public:
+    // Once frameQueueDepth frames wait unclaimed, each new frame replaces the oldest one, so the
+    // socket keeps being read and haptics keep arriving behind a slow consumer. A DeltaRle or
+    // Tiles frame is never dropped if a later one decodes against it; the receive thread then
+    // stops reading as with blockWhenFull, and TCP pushes back on the driver, haptics included
+    explicit DriverClient(uint32_t frameQueueDepth = 2, bool blockWhenFull = false);
+    ~DriverClient();
+
+    DriverClient(const DriverClient&) = delete;
+    DriverClient& operator=(const DriverClient&) = delete;
+
+    bool Connect(const std::string& host, uint16_t port);
+    void Disconnect();
+    // False once the driver hung up, even while received messages wait to be claimed
+    bool IsConnected() const { return m_connected; }
+    // Frames replaced unclaimed by newer ones since Connect
+    uint64_t GetFramesDropped() const { return m_framesDropped; }
+
+    // Next message in arrival order, haptics excepted. nullopt on timeout, or right away once
+    // disconnected with nothing left to claim
+    std::optional<ClientMessage> Receive(std::chrono::milliseconds timeout);
+    // Haptics received since the last call, oldest first
+    std::vector<Haptic> TakeHaptics();
+    // Used by the next frame whose pixels fit, before falling back to the pool
+    void ProvideBuffer(ProvidedBuffer buffer);
+
+    bool Send(MsgType type, const void* data, uint32_t size);
+    // Held until Flush, which sends everything queued in one write
+    void Queue(MsgType type, const void* data, uint32_t size);
+    void QueuePose(const BodyPosition& body) { Queue(MsgType::BodyPosition, &body, sizeof(body)); }
+    void QueueController(const ControllerInput& input) { Queue(MsgType::Controller, &input, sizeof(input)); }
+    bool Flush();
+
+private:
+    void ReceiveThreadFunc(std::stop_token st);
+    bool ReadFrame(const MsgHeader& header, size_t headSize, ClientMessage& message);
+    // Oldest queued frame that no queued frame or incoming decodes against, else m_messages.end()
+    std::deque<ClientMessage>::iterator FindDroppableFrame(const ClientMessage& incoming);
+    bool SendAll(net::Buffer* buffers, uint32_t count);
+
+    // Haptics nobody polled are dropped oldest first past this
+    static constexpr size_t kMaxHaptics = 256;
+
+    uint32_t m_frameQueueDepth;
+    bool m_blockWhenFull;
+    SOCKET m_socket = INVALID_SOCKET;
+    std::atomic<bool> m_connected{false};
+    std::atomic<uint64_t> m_framesDropped{0};
+    std::jthread m_receiveThread;
+
+    std::mutex m_mtx;
+    std::condition_variable_any m_cv;
+    std::deque<ClientMessage> m_messages;
+    uint32_t m_queuedFrames = 0;
+    std::deque<Haptic> m_haptics;
+    std::vector<ProvidedBuffer> m_provided;
+
+    // Keeps concurrent sends and flushes from interleaving on the socket
+    std::mutex m_sendMtx;
+    std::vector<uint8_t> m_sendQueue;
+};
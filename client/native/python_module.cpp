@@ -0,0 +1,377 @@
+// ovd_client._native: DriverClient for the Python client. Frame pixels are exposed through the
+// buffer protocol, so memoryview and numpy.frombuffer wrap them without copying. Blocking calls
+// release the GIL.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "driver_client.h"
+#include <memory>
+#include <new>
+
+// How often a blocked recv checks for Ctrl+C
+static constexpr auto kSignalCheckInterval = std::chrono::milliseconds(50);
+
+// Pixels of one received frame, valid while this object or any view of it is alive
+struct PixelBufferObject {
+    PyObject_HEAD
+    FrameBufferRef pooled;
+    std::shared_ptr<void> provided;
+    uint8_t* data;
+    Py_ssize_t size;
+};
+
+// Methods copy client before releasing the GIL, so close from another thread can't free it
+// under a blocked recv or send; that call fails once the connection is shut down
+struct ConnectionObject {
+    PyObject_HEAD
+    std::shared_ptr<DriverClient> client;
+};
+
+static PyTypeObject* s_pixelBufferType = nullptr;
+
+static int PixelBuffer_getbuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    auto* buffer = reinterpret_cast<PixelBufferObject*>(self);
+    return PyBuffer_FillInfo(view, self, buffer->data, buffer->size, 0, flags);
+}
+
+static void PixelBuffer_dealloc(PyObject* self)
+{
+    auto* buffer = reinterpret_cast<PixelBufferObject*>(self);
+    PyTypeObject* type = Py_TYPE(self);
+    buffer->pooled.~FrameBufferRef();
+    buffer->provided.~shared_ptr();
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static PyType_Slot s_pixelBufferSlots[] = {
+    { Py_bf_getbuffer, reinterpret_cast<void*>(PixelBuffer_getbuffer) },
+    { Py_tp_dealloc, reinterpret_cast<void*>(PixelBuffer_dealloc) },
+    { Py_tp_doc, const_cast<char*>("Pixels of a received frame; wrap with memoryview or numpy.frombuffer.") },
+    { 0, nullptr }
+};
+
+static PyType_Spec s_pixelBufferSpec = {
+    "ovd_client._native.PixelBuffer",
+    sizeof(PixelBufferObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    s_pixelBufferSlots
+};
+
+static PyObject* MakePixelBuffer(ClientMessage& message)
+{
+    PyObject* self = s_pixelBufferType->tp_alloc(s_pixelBufferType, 0);
+    if (!self)
+        return nullptr;
+
+    auto* buffer = reinterpret_cast<PixelBufferObject*>(self);
+    new (&buffer->pooled) FrameBufferRef(std::move(message.pooled));
+    new (&buffer->provided) std::shared_ptr<void>(std::move(message.provided));
+    buffer->data = const_cast<uint8_t*>(message.pixels);
+    buffer->size = static_cast<Py_ssize_t>(message.pixelSize);
+    return self;
+}
+
+static std::shared_ptr<DriverClient> GetClient(PyObject* self)
+{
+    std::shared_ptr<DriverClient> client = reinterpret_cast<ConnectionObject*>(self)->client;
+    if (!client)
+        PyErr_SetString(PyExc_ConnectionError, "Not connected");
+    return client;
+}
+
+static PyObject* Connection_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+    PyObject* self = type->tp_alloc(type, 0);
+    if (self)
+        new (&reinterpret_cast<ConnectionObject*>(self)->client) std::shared_ptr<DriverClient>();
+    return self;
+}
+
+static void CloseClient(ConnectionObject* connection);
+
+static int Connection_init(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[] = { "host", "port", "queue_depth", "block_when_full", nullptr };
+    const char* host;
+    unsigned short port;
+    unsigned int queueDepth = 2;
+    int blockWhenFull = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sH|Ip", const_cast<char**>(keywords), &host, &port, &queueDepth, &blockWhenFull))
+        return -1;
+
+    CloseClient(reinterpret_cast<ConnectionObject*>(self));
+    auto client = std::make_shared<DriverClient>(queueDepth, blockWhenFull != 0);
+    bool connected;
+    Py_BEGIN_ALLOW_THREADS
+    connected = client->Connect(host, port);
+    Py_END_ALLOW_THREADS
+    if (!connected)
+    {
+        PyErr_Format(PyExc_ConnectionRefusedError, "Could not connect to %s:%u", host, static_cast<unsigned>(port));
+        return -1;
+    }
+
+    reinterpret_cast<ConnectionObject*>(self)->client = std::move(client);
+    return 0;
+}
+
+static void CloseClient(ConnectionObject* connection)
+{
+    std::shared_ptr<DriverClient> client = std::move(connection->client);
+    if (!client)
+        return;
+    // Disconnect joins the receive thread, which may need the GIL to release a provided buffer.
+    // The last method still using the client frees it when it returns
+    Py_BEGIN_ALLOW_THREADS
+    client->Disconnect();
+    client.reset();
+    Py_END_ALLOW_THREADS
+}
+
+static void Connection_dealloc(PyObject* self)
+{
+    PyTypeObject* type = Py_TYPE(self);
+    auto* connection = reinterpret_cast<ConnectionObject*>(self);
+    CloseClient(connection);
+    connection->client.~shared_ptr();
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static PyObject* Connection_close(PyObject* self, PyObject*)
+{
+    CloseClient(reinterpret_cast<ConnectionObject*>(self));
+    Py_RETURN_NONE;
+}
+
+static PyObject* Connection_recv(PyObject* self, PyObject*)
+{
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (!client)
+        return nullptr;
+
+    std::optional<ClientMessage> message;
+    while (true)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        message = client->Receive(kSignalCheckInterval);
+        Py_END_ALLOW_THREADS
+        if (message)
+            break;
+        if (!client->IsConnected())
+        {
+            PyErr_SetString(PyExc_ConnectionError, "Connection closed");
+            return nullptr;
+        }
+        if (PyErr_CheckSignals() < 0)
+            return nullptr;
+    }
+
+    PyObject* head = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(message->head.data()), static_cast<Py_ssize_t>(message->head.size()));
+    if (!head)
+        return nullptr;
+    PyObject* pixels = message->pixels ? MakePixelBuffer(*message) : Py_NewRef(Py_None);
+    if (!pixels)
+    {
+        Py_DECREF(head);
+        return nullptr;
+    }
+    return Py_BuildValue("(INN)", static_cast<unsigned int>(message->type), head, pixels);
+}
+
+static PyObject* Connection_send(PyObject* self, PyObject* args)
+{
+    unsigned int type;
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "Iy*", &type, &data))
+        return nullptr;
+
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    bool sent = false;
+    if (client)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        sent = client->Send(static_cast<MsgType>(type), data.buf, static_cast<uint32_t>(data.len));
+        Py_END_ALLOW_THREADS
+        if (!sent)
+            PyErr_SetString(PyExc_ConnectionError, "Connection closed");
+    }
+    PyBuffer_Release(&data);
+    if (!sent)
+        return nullptr;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Connection_queue(PyObject* self, PyObject* args)
+{
+    unsigned int type;
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "Iy*", &type, &data))
+        return nullptr;
+
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (client)
+        client->Queue(static_cast<MsgType>(type), data.buf, static_cast<uint32_t>(data.len));
+    PyBuffer_Release(&data);
+    if (!client)
+        return nullptr;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Connection_flush(PyObject* self, PyObject*)
+{
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (!client)
+        return nullptr;
+
+    bool sent;
+    Py_BEGIN_ALLOW_THREADS
+    sent = client->Flush();
+    Py_END_ALLOW_THREADS
+    if (!sent)
+    {
+        PyErr_SetString(PyExc_ConnectionError, "Connection closed");
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Connection_poll_haptics(PyObject* self, PyObject*)
+{
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (!client)
+        return nullptr;
+
+    std::vector<Haptic> haptics = client->TakeHaptics();
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(haptics.size()));
+    if (!list)
+        return nullptr;
+    for (size_t i = 0; i < haptics.size(); i++)
+    {
+        PyObject* payload = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(&haptics[i]), sizeof(Haptic));
+        if (!payload)
+        {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), payload);
+    }
+    return list;
+}
+
+static PyObject* Connection_frames_dropped(PyObject* self, PyObject*)
+{
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (!client)
+        return nullptr;
+    return PyLong_FromUnsignedLongLong(client->GetFramesDropped());
+}
+
+static void ReleaseProvidedView(void* pointer)
+{
+    auto* view = static_cast<Py_buffer*>(pointer);
+    if (Py_IsInitialized())
+    {
+        PyGILState_STATE state = PyGILState_Ensure();
+        PyBuffer_Release(view);
+        PyGILState_Release(state);
+    }
+    delete view;
+}
+
+static PyObject* Connection_provide_buffer(PyObject* self, PyObject* buffer)
+{
+    std::shared_ptr<DriverClient> client = GetClient(self);
+    if (!client)
+        return nullptr;
+
+    auto view = std::make_unique<Py_buffer>();
+    if (PyObject_GetBuffer(buffer, view.get(), PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0)
+        return nullptr;
+
+    ProvidedBuffer provided;
+    provided.data = static_cast<uint8_t*>(view->buf);
+    provided.capacity = static_cast<size_t>(view->len);
+    provided.owner = std::shared_ptr<void>(view.release(), ReleaseProvidedView);
+    client->ProvideBuffer(std::move(provided));
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef s_connectionMethods[] = {
+    { "recv", Connection_recv, METH_NOARGS, "Next message as (type, head, pixels), blocking. pixels is a PixelBuffer for frames, else None." },
+    { "send", Connection_send, METH_VARARGS, "Send one message now." },
+    { "queue", Connection_queue, METH_VARARGS, "Hold a message for the next flush." },
+    { "flush", Connection_flush, METH_NOARGS, "Send every queued message in one write." },
+    { "poll_haptics", Connection_poll_haptics, METH_NOARGS, "Haptic payloads received since the last call." },
+    { "frames_dropped", Connection_frames_dropped, METH_NOARGS, "Frames replaced unclaimed by newer ones since connecting." },
+    { "provide_buffer", Connection_provide_buffer, METH_O, "Lend a writable buffer for the pixels of the next frame that fits." },
+    { "close", Connection_close, METH_NOARGS, "Disconnect and drop anything not yet received." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+static PyType_Slot s_connectionSlots[] = {
+    { Py_tp_init, reinterpret_cast<void*>(Connection_init) },
+    { Py_tp_new, reinterpret_cast<void*>(Connection_new) },
+    { Py_tp_dealloc, reinterpret_cast<void*>(Connection_dealloc) },
+    { Py_tp_methods, s_connectionMethods },
+    { Py_tp_doc, const_cast<char*>("Connection(host, port, queue_depth=2, block_when_full=False): driver connection with a background receive thread. Past queue_depth unclaimed frames the oldest is dropped unless a later delta frame applies to it, or with block_when_full reading stops.") },
+    { 0, nullptr }
+};
+
+static PyType_Spec s_connectionSpec = {
+    "ovd_client._native.Connection",
+    sizeof(ConnectionObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    s_connectionSlots
+};
+
+static PyObject* PoolStats(PyObject*, PyObject*)
+{
+    FrameBufferPoolStats stats = FrameBufferPool::Shared().GetStats();
+    return Py_BuildValue("{sKsKsIsI}",
+        "allocations", static_cast<unsigned long long>(stats.allocations),
+        "reuses", static_cast<unsigned long long>(stats.reuses),
+        "outstanding", stats.outstanding,
+        "free", stats.free);
+}
+
+static PyMethodDef s_moduleMethods[] = {
+    { "pool_stats", PoolStats, METH_NOARGS, "Frame buffer pool counters." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+static PyModuleDef s_module = {
+    PyModuleDef_HEAD_INIT,
+    "ovd_client._native",
+    "Native driver connection for ovd_client.",
+    -1,
+    s_moduleMethods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+PyMODINIT_FUNC PyInit__native()
+{
+    PyObject* module = PyModule_Create(&s_module);
+    if (!module)
+        return nullptr;
+
+    s_pixelBufferType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&s_pixelBufferSpec));
+    auto* connectionType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&s_connectionSpec));
+    if (!s_pixelBufferType || !connectionType ||
+        PyModule_AddType(module, s_pixelBufferType) < 0 ||
+        PyModule_AddType(module, connectionType) < 0)
+    {
+        Py_XDECREF(connectionType);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    Py_DECREF(connectionType);
+    return module;
+}
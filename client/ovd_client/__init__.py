@@ -1,6 +1,6 @@
 __version__ = "0.1.0"
 
-from .client import Client, Pose, Frame
+from .client import Client, Pose, Frame, FrameMetadata, StereoFrame, FrameTiming, Haptic, apply_tiles
 from .vmd import VMDPlayer
 
-__all__ = ["Client", "Pose", "Frame", "VMDPlayer", "__version__"]
+__all__ = ["Client", "Pose", "Frame", "FrameMetadata", "StereoFrame", "FrameTiming", "Haptic", "apply_tiles", "VMDPlayer", "__version__"]
@@ -1,26 +1,107 @@
+import json
 import math
+import mmap
 import os
+import select
 import socket
 import struct
 import time
+from collections import deque
+from contextlib import contextmanager
 from dataclasses import dataclass
-from typing import Optional
+from typing import Iterator, Optional
 
 import numpy as np
 import pygame
 
 from .vmd import VMDPlayer
 
+try:
+    # Built in place by cmake -DOVD_BUILD_CLIENT=ON
+    from . import _native
+except ImportError:
+    _native = None
+
 
 # Protocol constants
 MSG_TYPE_FRAME = 0
 MSG_TYPE_BODY_POSITION = 1
 MSG_TYPE_CONTROLLER = 2
+MSG_TYPE_SHARED_MEMORY_REQUEST = 3
+MSG_TYPE_SHARED_MEMORY_INFO = 4
+MSG_TYPE_CODEC_REQUEST = 5
+MSG_TYPE_OUTPUT_SPEC = 6
+MSG_TYPE_STEREO_REQUEST = 7
+MSG_TYPE_STEREO_FRAME = 8
+MSG_TYPE_TIMING_REQUEST = 9
+MSG_TYPE_FRAME_TIMING = 10
+MSG_TYPE_SUBSCRIPTION = 11
+MSG_TYPE_STATS_REQUEST = 12
+MSG_TYPE_STATS = 13
+MSG_TYPE_TRACE_REQUEST = 14
+MSG_TYPE_TRACE = 15
+MSG_TYPE_CONTROL = 16
+MSG_TYPE_CONTROL_REPLY = 17
+MSG_TYPE_DEVICE_SETUP = 18
+MSG_TYPE_HAPTIC = 19
+
+# Frame codecs (see src/codec/frame_codec.h)
+CODEC_RAW = 0
+CODEC_QOI = 1
+CODEC_DELTA_RLE = 2
+CODEC_TILES = 3
+
+# Output pixel formats (see src/image/convert.h)
+FORMAT_BGRA8 = 0
+FORMAT_RGBA8 = 1
+FORMAT_RGB8 = 2
+FORMAT_I420 = 3
+FORMAT_NV12 = 4
+FORMAT_GRAY8 = 5
+FORMAT_RGBA16F = 6  # RGBA float16, full precision for 10-bit swapchains
+
+# Stereo frame layouts (see StereoLayout in src/socket/socket_manager.h)
+STEREO_SEQUENTIAL = 0
+STEREO_SIDE_BY_SIDE = 1
+
+# Eye masks for subscribe
+EYE_LEFT = 1
+EYE_RIGHT = 2
+EYE_BOTH = 3
+
+# Resample filters for set_output
+FILTER_BOX = 0
+FILTER_BILINEAR = 1
+
+# Devices for setup_devices, named like the update_pose arguments (see DeviceRole in
+# src/provider/device_activity.h)
+DEVICES = (
+    "left_hand", "right_hand", "waist", "chest", "left_foot", "right_foot",
+    "left_knee", "right_knee", "left_elbow", "right_elbow", "left_shoulder", "right_shoulder",
+)
 
 MSG_HEADER_SIZE = 8
-FRAME_INFO_SIZE = 12
+FRAME_INFO_SIZE = 20
+FRAME_METADATA_SIZE = 96
+STEREO_FRAME_INFO_SIZE = 64
+FRAME_TIMING_SIZE = 48
+HAPTIC_SIZE = 24
 POSE_SIZE = 28  # 7 floats
 BODY_POSITION_SIZE = POSE_SIZE * 13  # head + 12 body parts
+SHARED_MEMORY_INFO_SIZE = 152
+
+# Shared memory frame ring layout (see src/shm/frame_ring.h)
+FRAME_RING_MAGIC = 0x5244564F
+FRAME_RING_HEADER_SIZE = 32
+FRAME_SLOT_HEADER_SIZE = 32
+
+# Bytes in front of the pixels in each frame message: frame info, then metadata
+_FRAME_HEAD_SIZES = {
+    MSG_TYPE_FRAME: FRAME_INFO_SIZE + FRAME_METADATA_SIZE,
+    MSG_TYPE_STEREO_FRAME: STEREO_FRAME_INFO_SIZE + FRAME_METADATA_SIZE,
+}
+# Messages that can arrive between any others and are recorded as they are read
+_SIDE_MESSAGES = (MSG_TYPE_FRAME_TIMING, MSG_TYPE_HAPTIC)
 
 DEFAULT_HOST = "127.0.0.1"
 DEFAULT_PORT = 21213
@@ -56,34 +137,201 @@ class Pose:
                            self.rot_w, self.rot_x, self.rot_y, self.rot_z)
 
 
+@dataclass
+class FrameMetadata:
+    """What a frame was rendered from and when it moved through the driver.
+
+    Timestamps are microseconds on the driver's monotonic clock; only differences are meaningful.
+    """
+    frame_index: int
+    # The newest update_pose call the driver had applied when the frame was submitted, counted
+    # from 1 per connection (0 = none yet), and when the driver received it
+    pose_sequence: int
+    pose_received_us: int
+    submit_us: int
+    present_us: int
+    send_us: int
+    hmd_pose: tuple[tuple[float, ...], ...]  # 3x4 row-major world-from-head matrix used to render
+
+    @classmethod
+    def unpack(cls, data: bytes) -> "FrameMetadata":
+        fields = struct.unpack("<6Q12f", data)
+        rows = tuple(tuple(fields[6 + row * 4:10 + row * 4]) for row in range(3))
+        return cls(*fields[:6], hmd_pose=rows)
+
+
 @dataclass
 class Frame:
     """VR frame data received from the driver."""
     width: int
     height: int
     eye: int  # 0 = left, 1 = right
-    data: bytes
+    data: bytes | memoryview
+    codec: int = CODEC_RAW  # data is in `format` only for CODEC_RAW, otherwise the encoded payload
+    format: int = FORMAT_BGRA8
+    metadata: Optional[FrameMetadata] = None  # Not available for shared memory frames
+
+
+@dataclass
+class StereoFrame:
+    """Both eyes of the same driver frame."""
+    frame_index: int
+    layout: int  # STEREO_SEQUENTIAL or STEREO_SIDE_BY_SIDE, as actually sent
+    # Sequential: [left, right]. Side by side: one frame holding both eyes, left eye first in each row.
+    frames: list[Frame]
+    metadata: Optional[FrameMetadata] = None
+
+
+@dataclass
+class FrameTiming:
+    """Where a frame's time went in the driver, sent after the frame when set_timing_reports is on."""
+    frame_index: int
+    submit_to_present_us: int
+    present_to_readback_us: int  # includes the frames the GPU readback is pipelined by
+    readback_to_send_us: int
+    vsync_period_us: int
+    # Totals since the driver started
+    presents: int
+    dropped: int
+    mispresented: int
+
+
+@dataclass
+class Haptic:
+    """A vibration a game asked one of the controllers for; see poll_haptics."""
+    device: str  # "left_hand" or "right_hand"
+    duration: float  # seconds
+    frequency: float  # Hz
+    amplitude: float  # 0..1
+    timestamp_us: int  # driver clock, like FrameMetadata timestamps
+
+
+def apply_tiles(frame: Frame, canvas: bytearray) -> None:
+    """Paste a CODEC_TILES frame over the previous full frame of the same eye, held in canvas.
+
+    canvas must hold width * height * 4 bytes; CODEC_RAW keyframes should be copied into it whole.
+    """
+    tile_size, count = struct.unpack_from("<II", frame.data, 0)
+    indices = struct.unpack_from(f"<{count}I", frame.data, 8)
+    columns = (frame.width + tile_size - 1) // tile_size
+    src = 8 + count * 4
+    for index in indices:
+        x = (index % columns) * tile_size
+        y = (index // columns) * tile_size
+        row_bytes = min(tile_size, frame.width - x) * 4
+        for row in range(y, min(y + tile_size, frame.height)):
+            dst = (row * frame.width + x) * 4
+            canvas[dst:dst + row_bytes] = frame.data[src:src + row_bytes]
+            src += row_bytes
+
+
+class _SharedFrameRing:
+    """Read-only view of the driver's shared memory frame ring."""
+
+    def __init__(self, mapping_name: str, mapping_size: int, slot_count: int, slot_stride: int) -> None:
+        if os.name == "nt":
+            self._map = mmap.mmap(-1, mapping_size, tagname=mapping_name, access=mmap.ACCESS_READ)
+        else:
+            # POSIX shared memory from shm_open, which Linux exposes under /dev/shm
+            with open("/dev/shm" + mapping_name, "rb") as file:
+                self._map = mmap.mmap(file.fileno(), mapping_size, access=mmap.ACCESS_READ)
+        self._view = memoryview(self._map)
+        self.slot_count = slot_count
+        self.slot_stride = slot_stride
+        self.last_sequence = 0
+
+        magic, = struct.unpack_from("<I", self._map, 0)
+        if magic != FRAME_RING_MAGIC:
+            raise ConnectionError("Shared frame ring not initialized")
+
+    def close(self) -> None:
+        self._view.release()
+        self._map.close()
+
+    def _slot_offset(self, sequence: int) -> int:
+        return FRAME_RING_HEADER_SIZE + (sequence % self.slot_count) * self.slot_stride
+
+    def next_frame(self, poll_interval: float = 0.0005) -> Frame:
+        """Wait for the next published frame. The returned data is a zero-copy view into
+        the ring and is only valid until the driver laps the slot (slot_count - 1 frames)."""
+        while True:
+            write_sequence, = struct.unpack_from("<Q", self._map, 24)
+            if write_sequence > self.last_sequence:
+                # Skip straight to the newest frame if we fell more than a lap behind
+                sequence = max(self.last_sequence + 1, write_sequence - self.slot_count + 1)
+                offset = self._slot_offset(sequence)
+                slot_sequence, width, height, eye, size, fmt = struct.unpack_from("<QIIIII", self._map, offset)
+                self.last_sequence = sequence
+                if slot_sequence != sequence:
+                    continue  # Overwritten while we looked, try the next one
+                data_offset = offset + FRAME_SLOT_HEADER_SIZE
+                return Frame(width=width, height=height, eye=eye, data=self._view[data_offset:data_offset + size],
+                             format=fmt)
+            time.sleep(poll_interval)
 
 
 class Client:
-    """TCP client for communicating with the OpenVR virtual driver."""
+    """TCP client for communicating with the OpenVR virtual driver.
+
+    When the native module is built, a background thread receives into pooled buffers and frame
+    data is a zero-copy view of them; otherwise, or with native=False, the socket is read directly.
+    """
 
-    def __init__(self, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT) -> None:
+    def __init__(self, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT, native: Optional[bool] = None,
+                 queue_depth: int = 2, block_when_full: bool = False) -> None:
+        """queue_depth is how many received frames the native client holds. Past that each new frame
+        replaces the oldest unclaimed one, or with block_when_full the client stops reading the socket
+        until one is received, which also holds back haptics. Frames a later CODEC_DELTA_RLE or
+        CODEC_TILES frame applies to are never dropped; the client stops reading instead."""
+        if native and _native is None:
+            raise ImportError("ovd_client._native is not built, see cmake -DOVD_BUILD_CLIENT=ON")
         self.host = host
         self.port = port
+        self._use_native = _native is not None if native is None else native
+        self._queue_depth = queue_depth
+        self._block_when_full = block_when_full
         self._socket: Optional[socket.socket] = None
+        self._connection = None
+        self._ring: Optional[_SharedFrameRing] = None
+        self.last_timing: Optional[FrameTiming] = None
+        self._haptics: deque[Haptic] = deque(maxlen=256)
+        self._pending_header: Optional[tuple[int, int]] = None
+        self._provided: deque[memoryview] = deque()
+        self._batch: Optional[list[tuple[int, bytes]]] = None
+        self._subscription = (EYE_BOTH, 1, 0.0)
+        self._pose_sequence = 0
+        self._pose_sent_at: dict[int, float] = {}
 
     def connect(self) -> None:
         """Connect to the driver."""
-        self._socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        self._socket.connect((self.host, self.port))
+        if self._use_native:
+            self._connection = _native.Connection(self.host, self.port, self._queue_depth, self._block_when_full)
+        else:
+            self._socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            self._socket.connect((self.host, self.port))
+        self._pose_sequence = 0
+        self._pose_sent_at.clear()
+        self._haptics.clear()
+        self._pending_header = None
+        self._provided.clear()
 
     def disconnect(self) -> None:
         """Disconnect from the driver."""
+        if self._ring:
+            self._ring.close()
+            self._ring = None
+        if self._connection:
+            self._connection.close()
+            self._connection = None
         if self._socket:
             self._socket.close()
             self._socket = None
 
+    @property
+    def frames_dropped(self) -> int:
+        """Frames the native client replaced unclaimed by newer ones since connecting."""
+        return self._connection.frames_dropped() if self._connection else 0
+
     def __enter__(self):
         self.connect()
         return self
@@ -93,23 +341,139 @@ class Client:
         return False
 
     def _send(self, msg_type: int, data: bytes) -> None:
-        """Send a message with header."""
+        """Send a message with header, or hold it until the enclosing batch ends."""
+        if self._batch is not None:
+            self._batch.append((msg_type, data))
+        elif self._connection:
+            self._connection.send(msg_type, data)
+        elif self._socket is None:
+            raise ConnectionError("Not connected")
+        else:
+            header = struct.pack("<II", msg_type, len(data))
+            self._socket.sendall(header + data)
+
+    @contextmanager
+    def batch(self) -> Iterator["Client"]:
+        """Send the pose and input updates made inside the with block together, in one write."""
+        if self._batch is not None:
+            yield self
+            return
+        self._batch = []
+        try:
+            yield self
+        finally:
+            batch, self._batch = self._batch, None
+            if self._connection:
+                for msg_type, data in batch:
+                    self._connection.queue(msg_type, data)
+                self._connection.flush()
+            elif self._socket is not None and batch:
+                self._socket.sendall(b"".join(struct.pack("<II", msg_type, len(data)) + data for msg_type, data in batch))
+
+    def provide_buffer(self, buffer) -> None:
+        """Lend a writable buffer, e.g. a numpy array, to receive the pixels of the next frame that fits.
+
+        That frame's data is then a view of the buffer, so don't reuse it until done with the frame.
+        """
+        if self._connection:
+            self._connection.provide_buffer(buffer)
+        else:
+            self._provided.append(memoryview(buffer).cast("B"))
+
+    def _recv_into(self, view: memoryview) -> memoryview:
+        """Fill view from the socket."""
         if self._socket is None:
             raise ConnectionError("Not connected")
-        header = struct.pack("<II", msg_type, len(data))
-        self._socket.sendall(header + data)
+        received = 0
+        while received < len(view):
+            count = self._socket.recv_into(view[received:])
+            if count == 0:
+                raise ConnectionError("Connection closed")
+            received += count
+        return view
 
     def _recv_exact(self, size: int) -> bytes:
-        """Receive exactly `size` bytes."""
+        """Receive exactly `size` bytes, in a single read unless the wait is interrupted."""
         if self._socket is None:
             raise ConnectionError("Not connected")
-        data = b""
-        while len(data) < size:
-            chunk = self._socket.recv(size - len(data))
+        parts = []
+        remaining = size
+        while remaining > 0:
+            chunk = self._socket.recv(remaining, socket.MSG_WAITALL)
             if not chunk:
                 raise ConnectionError("Connection closed")
-            data += chunk
-        return data
+            parts.append(chunk)
+            remaining -= len(chunk)
+        return parts[0] if len(parts) == 1 else b"".join(parts)
+
+    def _recv_header(self) -> tuple[int, int]:
+        """Receive the next message header, consuming any timing reports and haptics in front of it."""
+        if self._pending_header is not None:
+            header, self._pending_header = self._pending_header, None
+            return header
+        while True:
+            msg_type, msg_size = struct.unpack("<II", self._recv_exact(MSG_HEADER_SIZE))
+            if msg_type not in _SIDE_MESSAGES:
+                return msg_type, msg_size
+            self._handle_side_message(msg_type, self._recv_exact(msg_size))
+
+    def _recv_message(self) -> tuple[int, bytes, Optional[bytes | memoryview]]:
+        """Receive the next message, recording timing reports and haptics on the way.
+
+        Frames come back as (type, frame info and metadata, pixels), anything else as (type, payload, None).
+        """
+        if self._connection:
+            while True:
+                msg_type, head, pixels = self._connection.recv()
+                if msg_type in _SIDE_MESSAGES:
+                    self._handle_side_message(msg_type, head)
+                elif msg_type in _FRAME_HEAD_SIZES:
+                    return msg_type, head, memoryview(pixels if pixels is not None else b"")
+                else:
+                    return msg_type, head, None
+
+        msg_type, msg_size = self._recv_header()
+        head_size = _FRAME_HEAD_SIZES.get(msg_type)
+        if head_size is None:
+            return msg_type, self._recv_exact(msg_size), None
+        head = self._recv_exact(head_size)
+        pixel_size = msg_size - head_size
+        for index, buffer in enumerate(self._provided):
+            if len(buffer) >= pixel_size:
+                del self._provided[index]
+                return msg_type, head, self._recv_into(buffer[:pixel_size])
+        return msg_type, head, self._recv_exact(pixel_size)
+
+    def _handle_side_message(self, msg_type: int, payload: bytes) -> None:
+        if msg_type == MSG_TYPE_FRAME_TIMING:
+            self.last_timing = FrameTiming(*struct.unpack("<QIIIIQQQ", payload))
+        else:
+            device, duration, frequency, amplitude, timestamp_us = struct.unpack("<IfffQ", payload)
+            self._haptics.append(Haptic(DEVICES[device], duration, frequency, amplitude, timestamp_us))
+
+    def poll_haptics(self) -> list[Haptic]:
+        """Vibrations the driver forwarded since the last call, oldest first. Never blocks.
+
+        The driver sends them ahead of queued frame data, so they arrive within about a frame of the
+        game asking. The native client keeps reading while frames go unclaimed unless block_when_full
+        is set; without it, haptics behind a frame not yet received wait for that frame. With shared
+        memory frames nothing else reads the socket, so call this each loop.
+        """
+        if self._connection:
+            for payload in self._connection.poll_haptics():
+                self._handle_side_message(MSG_TYPE_HAPTIC, payload)
+        while self._pending_header is None and self._socket is not None:
+            readable, _, _ = select.select([self._socket], [], [], 0)
+            if not readable:
+                break
+            msg_type, msg_size = struct.unpack("<II", self._recv_exact(MSG_HEADER_SIZE))
+            if msg_type in _SIDE_MESSAGES:
+                self._handle_side_message(msg_type, self._recv_exact(msg_size))
+            else:
+                self._pending_header = (msg_type, msg_size)
+        haptics = list(self._haptics)
+        self._haptics.clear()
+        return haptics
 
     def update_controller(
         self,
@@ -179,21 +543,210 @@ class Client:
         )
         self._send(MSG_TYPE_BODY_POSITION, data)
 
+        # The driver numbers these the same way; frames name the one they were rendered from
+        self._pose_sequence += 1
+        self._pose_sent_at[self._pose_sequence] = time.perf_counter()
+        self._pose_sent_at.pop(self._pose_sequence - 1024, None)
+
+    def motion_to_photon(self, metadata: FrameMetadata) -> Optional[float]:
+        """Seconds from the update_pose call a frame was rendered from until now.
+
+        Call it when the frame is shown. None if the frame predates any pose sent on this connection.
+        """
+        sent_at = self._pose_sent_at.get(metadata.pose_sequence)
+        return None if sent_at is None else time.perf_counter() - sent_at
+
+    def setup_devices(self, *devices: str) -> None:
+        """Have the driver register controllers and trackers before their first pose, e.g. "waist".
+
+        Devices otherwise appear in SteamVR once update_pose sends them (or update_controller, for
+        both hands), and stop tracking after a few seconds without poses. They are never removed.
+        """
+        mask = 0
+        for device in devices:
+            mask |= 1 << DEVICES.index(device)
+        self._send(MSG_TYPE_DEVICE_SETUP, struct.pack("<I", mask))
+
+    def set_codec(self, codec: int) -> None:
+        """Select how subsequent frames are encoded (CODEC_RAW, CODEC_QOI, CODEC_DELTA_RLE or CODEC_TILES).
+
+        With CODEC_DELTA_RLE, delta frames apply to the previous frame of the same eye and
+        keyframes arrive as CODEC_QOI. With CODEC_TILES, only changed 64x64 tiles are sent
+        (see apply_tiles), keyframes arrive as CODEC_RAW and unchanged frames are not sent.
+        """
+        self._send(MSG_TYPE_CODEC_REQUEST, struct.pack("<I", codec))
+
+    def set_output(
+        self,
+        width: int = 0,
+        height: int = 0,
+        roi: Optional[tuple[float, float, float, float]] = None,
+        filter: int = FILTER_BILINEAR,
+        format: int = FORMAT_BGRA8,
+    ) -> None:
+        """Have the driver crop, scale and convert frames before sending them.
+
+        Args:
+            width: Output width in pixels, 0 to follow the region's aspect ratio
+            height: Output height in pixels, 0 to follow the region's aspect ratio
+            roi: (u_min, v_min, u_max, v_max) region of the eye image in 0..1, None for the whole eye
+            filter: FILTER_BOX (best for large downscales) or FILTER_BILINEAR
+            format: One of the FORMAT_* constants. Codecs only apply to 4 byte formats.
+                FORMAT_RGBA16F frames read as np.frombuffer(data, dtype=np.float16).
+        """
+        u_min, v_min, u_max, v_max = roi or (0.0, 0.0, 0.0, 0.0)
+        self._send(MSG_TYPE_OUTPUT_SPEC,
+                   struct.pack("<II4fII", width, height, u_min, v_min, u_max, v_max, filter, format))
+
+    def enable_shared_memory(self, slot_count: int = 0, max_frame_bytes: int = 0) -> bool:
+        """Ask the driver to deliver frames through shared memory instead of TCP.
+
+        Only works when running on the same machine as SteamVR. Zero arguments use the
+        driver defaults. Returns False if the driver could not set up shared memory.
+        """
+        self._send(MSG_TYPE_SHARED_MEMORY_REQUEST, struct.pack("<II", slot_count, max_frame_bytes))
+
+        # Frames already in flight arrive before the reply, drop them
+        while True:
+            msg_type, payload, _ = self._recv_message()
+            if msg_type == MSG_TYPE_SHARED_MEMORY_INFO:
+                break
+
+        mapping_name, _event_name, slot_count, slot_stride, _max_frame_bytes, _reserved, mapping_size = \
+            struct.unpack("<64s64sIIIIQ", payload)
+        if slot_count == 0:
+            return False
+
+        self._ring = _SharedFrameRing(
+            mapping_name.split(b"\0", 1)[0].decode(), mapping_size, slot_count, slot_stride)
+        return True
+
+    def set_stereo(self, enabled: bool = True, layout: int = STEREO_SEQUENTIAL) -> None:
+        """Receive both eyes of each frame in one message, read with get_stereo_frame.
+
+        Side by side needs both eyes at the same height and a non-planar format; the driver
+        falls back to sequential otherwise. Codecs apply to the side by side image as a whole.
+        """
+        self._send(MSG_TYPE_STEREO_REQUEST, struct.pack("<II", int(enabled), layout))
+
+    def subscribe(self, eyes: int = EYE_BOTH, divisor: int = 1, max_fps: float = 0.0) -> None:
+        """Choose which eyes and frames the driver captures for this client.
+
+        Frames nobody subscribed to are never read back from the GPU, so asking only for what
+        is used saves driver time. divisor takes every Nth display frame; max_fps is rounded
+        down to a whole divisor of the display rate. Zero means no limit.
+        """
+        self._subscription = (eyes, divisor, max_fps)
+        self._send(MSG_TYPE_SUBSCRIPTION, struct.pack("<IIfI", eyes, divisor, max_fps, 0))
+
+    def pause(self) -> None:
+        """Stop frame capture for this client until resume, keeping the subscription."""
+        self._send(MSG_TYPE_SUBSCRIPTION, struct.pack("<IIfI", *self._subscription, 1))
+
+    def resume(self) -> None:
+        self._send(MSG_TYPE_SUBSCRIPTION, struct.pack("<IIfI", *self._subscription, 0))
+
+    def set_timing_reports(self, enabled: bool = True) -> None:
+        """Have the driver send a FrameTiming after each frame; the newest is kept in last_timing.
+
+        Reports follow frames sent over TCP, not frames delivered through shared memory.
+        """
+        self._send(MSG_TYPE_TIMING_REQUEST, struct.pack("<I", int(enabled)))
+
+    def get_stereo_frame(self) -> StereoFrame:
+        """Receive a matched left/right pair from the driver (blocking). Requires set_stereo."""
+        msg_type, head, payload = self._recv_message()
+        if msg_type != MSG_TYPE_STEREO_FRAME:
+            raise ValueError(f"Expected stereo frame message, got type {msg_type}")
+
+        info = struct.unpack_from("<QII10III", head, 0)
+        frame_index, layout = info[0], info[1]
+        eyes = [info[3:8], info[8:13]]
+        sizes = info[13:15]
+        metadata = FrameMetadata.unpack(head[STEREO_FRAME_INFO_SIZE:])
+
+        if layout == STEREO_SIDE_BY_SIDE:
+            (left_width, height, _, codec, fmt), (right_width, _, _, _, _) = eyes
+            frames = [Frame(width=left_width + right_width, height=height, eye=0, data=payload, codec=codec, format=fmt,
+                            metadata=metadata)]
+        else:
+            frames = []
+            offset = 0
+            for (width, height, eye, codec, fmt), size in zip(eyes, sizes):
+                frames.append(Frame(width=width, height=height, eye=eye, data=payload[offset:offset + size],
+                                    codec=codec, format=fmt, metadata=metadata))
+                offset += size
+
+        return StereoFrame(frame_index=frame_index, layout=layout, frames=frames, metadata=metadata)
+
+    def get_stats(self) -> dict:
+        """Fetch a snapshot of the driver's metrics: counters, gauges and latency histograms.
+
+        Frames arriving before the reply are discarded.
+        """
+        self._send(MSG_TYPE_STATS_REQUEST, b"")
+        while True:
+            msg_type, payload, _ = self._recv_message()
+            if msg_type == MSG_TYPE_STATS:
+                return json.loads(payload.decode())
+
+    def control(self, command: str) -> str:
+        """Run a driver control command and return its reply, e.g. "list", "get pose.hmd_rate_hz"
+        or "set pose.hmd_rate_hz=120 subscription.eyes=1". Replies to failed commands start with "error:".
+
+        Frames arriving before the reply are discarded.
+        """
+        self._send(MSG_TYPE_CONTROL, command.encode())
+        while True:
+            msg_type, payload, _ = self._recv_message()
+            if msg_type == MSG_TYPE_CONTROL_REPLY:
+                return payload.decode()
+
+    def start_trace(self) -> None:
+        """Start recording a timeline of the driver's pipeline threads; see stop_trace."""
+        self._send(MSG_TYPE_TRACE_REQUEST, struct.pack("<I", 1))
+
+    def stop_trace(self, path: Optional[str] = None) -> dict:
+        """Stop tracing and return the Chrome trace events, also written to path if given.
+
+        The file opens in chrome://tracing or ui.perfetto.dev. Frames arriving before the reply
+        are discarded.
+        """
+        self._send(MSG_TYPE_TRACE_REQUEST, struct.pack("<I", 0))
+        while True:
+            msg_type, payload, _ = self._recv_message()
+            if msg_type == MSG_TYPE_TRACE:
+                if path:
+                    with open(path, "wb") as out:
+                        out.write(payload)
+                return json.loads(payload.decode())
+
+    def record_frames(self, path: str, count: int) -> None:
+        """Dump the next count Frame messages as received, e.g. for ovd_tile_bench."""
+        with open(path, "wb") as out:
+            recorded = 0
+            while recorded < count:
+                msg_type, head, pixels = self._recv_message()
+                if msg_type == MSG_TYPE_FRAME:
+                    out.write(struct.pack("<II", msg_type, len(head) + len(pixels)))
+                    out.write(head)
+                    out.write(pixels)
+                    recorded += 1
+
     def get_frame(self) -> Frame:
         """Receive a frame from the driver (blocking)."""
-        header = self._recv_exact(MSG_HEADER_SIZE)
-        msg_type, msg_size = struct.unpack("<II", header)
+        if self._ring:
+            return self._ring.next_frame()
+
+        msg_type, head, pixels = self._recv_message()
 
         if msg_type != MSG_TYPE_FRAME:
             raise ValueError(f"Expected frame message, got type {msg_type}")
 
-        frame_info = self._recv_exact(FRAME_INFO_SIZE)
-        width, height, eye = struct.unpack("<III", frame_info)
-
-        pixel_size = msg_size - FRAME_INFO_SIZE
-        pixel_data = self._recv_exact(pixel_size)
+        width, height, eye, codec, fmt = struct.unpack_from("<IIIII", head, 0)
+        metadata = FrameMetadata.unpack(head[FRAME_INFO_SIZE:])
 
-        return Frame(width=width, height=height, eye=eye, data=pixel_data)
+        return Frame(width=width, height=height, eye=eye, data=pixels, codec=codec, format=fmt, metadata=metadata)
 
     def play(
         self,
@@ -218,7 +771,7 @@ class Client:
         - P: Play/Pause VMD, R: Reset VMD
         - ESC: Quit
         """
-        if self._socket is None:
+        if self._socket is None and self._connection is None:
             raise ConnectionError("Not connected")
 
         pygame.init()
@@ -256,6 +809,9 @@ class Client:
         yaw, pitch = 0.0, 0.0
         right_yaw, right_pitch = 0.0, 0.0
 
+        # Only the left eye is shown, don't make the driver capture the right one
+        self.subscribe(eyes=EYE_LEFT)
+
         # Send initial T-pose
         self._send_tpose(pos_x, pos_y, pos_z, yaw, pitch)
 
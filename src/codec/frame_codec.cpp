@@ -0,0 +1,532 @@
+#include "frame_codec.h"
+#include "../thread/worker_pool.h"
+#include "../image/tile_hash.h"
+#include "../trace/trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace codec {
+
+static constexpr uint8_t kQoiOpIndex = 0x00;
+static constexpr uint8_t kQoiOpDiff = 0x40;
+static constexpr uint8_t kQoiOpLuma = 0x80;
+static constexpr uint8_t kQoiOpRun = 0xC0;
+static constexpr uint8_t kQoiOpRgb = 0xFE;
+static constexpr uint8_t kQoiOpRgba = 0xFF;
+static constexpr uint8_t kQoiMask = 0xC0;
+
+struct Bgra {
+    uint8_t b, g, r, a;
+    bool operator==(const Bgra&) const = default;
+};
+
+static inline uint32_t QoiHash(const Bgra& px)
+{
+    return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+}
+
+static inline void PutVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static inline bool GetVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        if (p >= end)
+            return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void EncodeQoiStripe(const uint8_t* pixels, uint32_t count, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(static_cast<size_t>(count) * 2);
+
+    Bgra index[64] = {};
+    Bgra prev { 0, 0, 0, 255 };
+    uint32_t run = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Bgra px;
+        std::memcpy(&px, pixels + i * 4, 4);
+
+        if (px == prev)
+        {
+            if (++run == 62)
+            {
+                out.push_back(kQoiOpRun | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0)
+        {
+            out.push_back(kQoiOpRun | (run - 1));
+            run = 0;
+        }
+
+        uint32_t hash = QoiHash(px);
+        if (index[hash] == px)
+        {
+            out.push_back(kQoiOpIndex | hash);
+        }
+        else
+        {
+            index[hash] = px;
+
+            if (px.a == prev.a)
+            {
+                int8_t vr = static_cast<int8_t>(px.r - prev.r);
+                int8_t vg = static_cast<int8_t>(px.g - prev.g);
+                int8_t vb = static_cast<int8_t>(px.b - prev.b);
+                int8_t vgR = static_cast<int8_t>(vr - vg);
+                int8_t vgB = static_cast<int8_t>(vb - vg);
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                {
+                    out.push_back(kQoiOpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                }
+                else if (vgR > -9 && vgR < 8 && vg > -33 && vg < 32 && vgB > -9 && vgB < 8)
+                {
+                    out.push_back(kQoiOpLuma | (vg + 32));
+                    out.push_back((vgR + 8) << 4 | (vgB + 8));
+                }
+                else
+                {
+                    out.push_back(kQoiOpRgb);
+                    out.push_back(px.r);
+                    out.push_back(px.g);
+                    out.push_back(px.b);
+                }
+            }
+            else
+            {
+                out.push_back(kQoiOpRgba);
+                out.push_back(px.r);
+                out.push_back(px.g);
+                out.push_back(px.b);
+                out.push_back(px.a);
+            }
+        }
+        prev = px;
+    }
+
+    if (run > 0)
+    {
+        out.push_back(kQoiOpRun | (run - 1));
+    }
+}
+
+static bool DecodeQoiStripe(const uint8_t* data, const uint8_t* end, uint32_t count, uint8_t* pixels)
+{
+    Bgra index[64] = {};
+    Bgra px { 0, 0, 0, 255 };
+    uint32_t run = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (run > 0)
+        {
+            run--;
+        }
+        else
+        {
+            if (data >= end)
+                return false;
+            uint8_t b1 = *data++;
+
+            if (b1 == kQoiOpRgb)
+            {
+                if (end - data < 3)
+                    return false;
+                px.r = data[0];
+                px.g = data[1];
+                px.b = data[2];
+                data += 3;
+            }
+            else if (b1 == kQoiOpRgba)
+            {
+                if (end - data < 4)
+                    return false;
+                px.r = data[0];
+                px.g = data[1];
+                px.b = data[2];
+                px.a = data[3];
+                data += 4;
+            }
+            else if ((b1 & kQoiMask) == kQoiOpIndex)
+            {
+                px = index[b1];
+            }
+            else if ((b1 & kQoiMask) == kQoiOpDiff)
+            {
+                px.r += ((b1 >> 4) & 0x03) - 2;
+                px.g += ((b1 >> 2) & 0x03) - 2;
+                px.b += (b1 & 0x03) - 2;
+            }
+            else if ((b1 & kQoiMask) == kQoiOpLuma)
+            {
+                if (data >= end)
+                    return false;
+                uint8_t b2 = *data++;
+                int vg = (b1 & 0x3F) - 32;
+                px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                px.g += vg;
+                px.b += vg - 8 + (b2 & 0x0F);
+            }
+            else
+            {
+                // Run of the previous pixel, this one included
+                run = b1 & 0x3F;
+                std::memcpy(pixels + i * 4, &px, 4);
+                continue;
+            }
+
+            index[QoiHash(px)] = px;
+        }
+        std::memcpy(pixels + i * 4, &px, 4);
+    }
+    return true;
+}
+
+static void EncodeDeltaRleStripe(const uint8_t* pixels, const uint8_t* previous, uint32_t count, std::vector<uint8_t>& out)
+{
+    out.clear();
+
+    uint32_t i = 0;
+    while (i < count)
+    {
+        // Unchanged span, compared two pixels at a time
+        uint32_t start = i;
+        while (i + 2 <= count && std::memcmp(pixels + i * 4, previous + i * 4, 8) == 0)
+            i += 2;
+        while (i < count && std::memcmp(pixels + i * 4, previous + i * 4, 4) == 0)
+            i++;
+        uint32_t unchanged = i - start;
+
+        start = i;
+        while (i < count && std::memcmp(pixels + i * 4, previous + i * 4, 4) != 0)
+            i++;
+        uint32_t changed = i - start;
+
+        PutVarint(out, unchanged);
+        PutVarint(out, changed);
+
+        size_t offset = out.size();
+        out.resize(offset + static_cast<size_t>(changed) * 4);
+        uint8_t* dst = out.data() + offset;
+        for (uint32_t j = start; j < i; j++)
+        {
+            uint32_t cur, prev;
+            std::memcpy(&cur, pixels + j * 4, 4);
+            std::memcpy(&prev, previous + j * 4, 4);
+            uint32_t x = cur ^ prev;
+            std::memcpy(dst, &x, 4);
+            dst += 4;
+        }
+    }
+}
+
+static bool DecodeDeltaRleStripe(const uint8_t* data, const uint8_t* end, uint32_t count, uint8_t* pixels)
+{
+    uint32_t i = 0;
+    while (i < count)
+    {
+        uint32_t unchanged, changed;
+        if (!GetVarint(data, end, unchanged) || !GetVarint(data, end, changed))
+            return false;
+        if (unchanged > count - i || changed > count - i - unchanged)
+            return false;
+        if (static_cast<size_t>(end - data) < static_cast<size_t>(changed) * 4)
+            return false;
+
+        i += unchanged;
+        for (uint32_t j = 0; j < changed; j++, i++)
+        {
+            uint32_t cur, x;
+            std::memcpy(&cur, pixels + i * 4, 4);
+            std::memcpy(&x, data, 4);
+            cur ^= x;
+            std::memcpy(pixels + i * 4, &cur, 4);
+            data += 4;
+        }
+    }
+    return true;
+}
+
+// Splits the image into row stripes, encodes them concurrently and assembles the payload
+template<typename EncodeStripeFn>
+static void EncodeStriped(uint32_t width, uint32_t height, std::vector<uint8_t>& out, EncodeStripeFn encodeStripe)
+{
+    uint32_t stripeCount = std::min(kMaxStripes, height);
+    uint32_t stripeRows = stripeCount > 0 ? (height + stripeCount - 1) / stripeCount : 0;
+    if (stripeRows > 0)
+        stripeCount = (height + stripeRows - 1) / stripeRows;
+
+    std::vector<uint8_t> stripes[kMaxStripes];
+    WorkerPool::Shared().Run(stripeCount, [&](uint32_t s) {
+        uint32_t firstRow = s * stripeRows;
+        uint32_t rows = std::min(stripeRows, height - firstRow);
+        encodeStripe(static_cast<size_t>(firstRow) * width * 4, width * rows, stripes[s]);
+    });
+
+    size_t total = 8 + stripeCount * 4;
+    for (uint32_t s = 0; s < stripeCount; s++)
+        total += stripes[s].size();
+
+    out.resize(total);
+    uint8_t* dst = out.data();
+    std::memcpy(dst, &stripeCount, 4);
+    std::memcpy(dst + 4, &stripeRows, 4);
+    dst += 8;
+    for (uint32_t s = 0; s < stripeCount; s++)
+    {
+        uint32_t size = static_cast<uint32_t>(stripes[s].size());
+        std::memcpy(dst, &size, 4);
+        dst += 4;
+    }
+    for (uint32_t s = 0; s < stripeCount; s++)
+    {
+        std::memcpy(dst, stripes[s].data(), stripes[s].size());
+        dst += stripes[s].size();
+    }
+}
+
+template<typename DecodeStripeFn>
+static bool DecodeStriped(const uint8_t* data, size_t size, uint32_t width, uint32_t height, DecodeStripeFn decodeStripe)
+{
+    if (size < 8)
+        return false;
+
+    uint32_t stripeCount, stripeRows;
+    std::memcpy(&stripeCount, data, 4);
+    std::memcpy(&stripeRows, data + 4, 4);
+    if (stripeCount > kMaxStripes || size < 8 + static_cast<size_t>(stripeCount) * 4)
+        return false;
+    if (static_cast<uint64_t>(stripeCount) * stripeRows < height)
+        return false;
+
+    const uint8_t* stripeData = data + 8 + stripeCount * 4;
+    const uint8_t* end = data + size;
+    for (uint32_t s = 0; s < stripeCount; s++)
+    {
+        uint32_t stripeSize;
+        std::memcpy(&stripeSize, data + 8 + s * 4, 4);
+        if (static_cast<size_t>(end - stripeData) < stripeSize)
+            return false;
+
+        uint32_t firstRow = s * stripeRows;
+        uint32_t rows = firstRow < height ? std::min(stripeRows, height - firstRow) : 0;
+        if (!decodeStripe(stripeData, stripeData + stripeSize, static_cast<size_t>(firstRow) * width * 4, width * rows))
+            return false;
+        stripeData += stripeSize;
+    }
+    return true;
+}
+
+void EncodeQoi(const uint8_t* pixels, uint32_t width, uint32_t height, std::vector<uint8_t>& out)
+{
+    EncodeStriped(width, height, out, [&](size_t offset, uint32_t count, std::vector<uint8_t>& stripe) {
+        EncodeQoiStripe(pixels + offset, count, stripe);
+    });
+}
+
+bool DecodeQoi(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels)
+{
+    return DecodeStriped(data, size, width, height, [&](const uint8_t* begin, const uint8_t* end, size_t offset, uint32_t count) {
+        return DecodeQoiStripe(begin, end, count, pixels + offset);
+    });
+}
+
+void EncodeDeltaRle(const uint8_t* pixels, const uint8_t* previous, uint32_t width, uint32_t height, std::vector<uint8_t>& out)
+{
+    EncodeStriped(width, height, out, [&](size_t offset, uint32_t count, std::vector<uint8_t>& stripe) {
+        EncodeDeltaRleStripe(pixels + offset, previous + offset, count, stripe);
+    });
+}
+
+bool DecodeDeltaRle(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels)
+{
+    return DecodeStriped(data, size, width, height, [&](const uint8_t* begin, const uint8_t* end, size_t offset, uint32_t count) {
+        return DecodeDeltaRleStripe(begin, end, count, pixels + offset);
+    });
+}
+
+uint32_t EncodeTiles(const uint8_t* pixels, uint32_t width, uint32_t height, const uint64_t* tileHashes, const uint64_t* previousHashes, std::vector<uint8_t>& out)
+{
+    uint32_t columns = GetTileColumns(width);
+    uint32_t tileCount = GetTileCount(width, height);
+
+    out.resize(8);
+    size_t pixelBytes = 0;
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        if (tileHashes[i] == previousHashes[i])
+            continue;
+
+        uint32_t tx = i % columns;
+        uint32_t ty = i / columns;
+        pixelBytes += static_cast<size_t>(std::min(kTileSize, width - tx * kTileSize)) * std::min(kTileSize, height - ty * kTileSize) * 4;
+        size_t offset = out.size();
+        out.resize(offset + 4);
+        std::memcpy(out.data() + offset, &i, 4);
+    }
+
+    uint32_t changed = static_cast<uint32_t>((out.size() - 8) / 4);
+    std::memcpy(out.data(), &kTileSize, 4);
+    std::memcpy(out.data() + 4, &changed, 4);
+
+    size_t offset = out.size();
+    out.resize(offset + pixelBytes);
+    uint8_t* dst = out.data() + offset;
+    for (uint32_t n = 0; n < changed; n++)
+    {
+        uint32_t i;
+        std::memcpy(&i, out.data() + 8 + n * 4, 4);
+        uint32_t x = (i % columns) * kTileSize;
+        uint32_t y = (i / columns) * kTileSize;
+        size_t rowBytes = static_cast<size_t>(std::min(kTileSize, width - x)) * 4;
+        uint32_t rows = std::min(kTileSize, height - y);
+        for (uint32_t row = 0; row < rows; row++)
+        {
+            std::memcpy(dst, pixels + (static_cast<size_t>(y + row) * width + x) * 4, rowBytes);
+            dst += rowBytes;
+        }
+    }
+    return changed;
+}
+
+bool DecodeTiles(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels)
+{
+    uint32_t tileSize, changed;
+    if (size < 8)
+        return false;
+    std::memcpy(&tileSize, data, 4);
+    std::memcpy(&changed, data + 4, 4);
+    if (tileSize == 0 || changed > (size - 8) / 4)
+        return false;
+
+    uint32_t columns = (width + tileSize - 1) / tileSize;
+    uint32_t tileCount = columns * ((height + tileSize - 1) / tileSize);
+    const uint8_t* src = data + 8 + static_cast<size_t>(changed) * 4;
+    const uint8_t* end = data + size;
+    for (uint32_t n = 0; n < changed; n++)
+    {
+        uint32_t i;
+        std::memcpy(&i, data + 8 + n * 4, 4);
+        if (i >= tileCount)
+            return false;
+
+        uint32_t x = (i % columns) * tileSize;
+        uint32_t y = (i / columns) * tileSize;
+        size_t rowBytes = static_cast<size_t>(std::min(tileSize, width - x)) * 4;
+        uint32_t rows = std::min(tileSize, height - y);
+        if (static_cast<size_t>(end - src) < rowBytes * rows)
+            return false;
+
+        for (uint32_t row = 0; row < rows; row++)
+        {
+            std::memcpy(pixels + (static_cast<size_t>(y + row) * width + x) * 4, src, rowBytes);
+            src += rowBytes;
+        }
+    }
+    return src == end;
+}
+
+} // namespace codec
+
+FrameEncoder::Result FrameEncoder::Encode(FrameCodec codec, const uint8_t* pixels, size_t size, uint32_t width, uint32_t height, uint32_t eye)
+{
+    OVD_TRACE_SCOPE_ARG("codec.encode", "codec", static_cast<uint64_t>(codec));
+    std::vector<uint8_t>& output = m_outputs[eye & 1];
+    switch (codec)
+    {
+        case FrameCodec::Qoi:
+            // The client's previous frame of this eye is now this one, not the delta reference
+            m_references[eye & 1].width = 0;
+            codec::EncodeQoi(pixels, width, height, output);
+            return Result{ FrameCodec::Qoi, output.data(), static_cast<uint32_t>(output.size()), false };
+
+        case FrameCodec::DeltaRle:
+        {
+            Reference& ref = m_references[eye & 1];
+            bool keyframe = ref.width != width || ref.height != height || ref.framesSinceKey >= kKeyframeInterval;
+
+            FrameCodec used;
+            if (keyframe)
+            {
+                codec::EncodeQoi(pixels, width, height, output);
+                ref.framesSinceKey = 0;
+                used = FrameCodec::Qoi;
+            }
+            else
+            {
+                codec::EncodeDeltaRle(pixels, ref.pixels.data(), width, height, output);
+                ref.framesSinceKey++;
+                used = FrameCodec::DeltaRle;
+            }
+
+            ref.pixels.assign(pixels, pixels + size);
+            ref.width = width;
+            ref.height = height;
+            return Result{ used, output.data(), static_cast<uint32_t>(output.size()), false };
+        }
+
+        case FrameCodec::Tiles:
+        {
+            Reference& ref = m_references[eye & 1];
+            m_tileHashes.resize(GetTileCount(width, height));
+            HashTiles(pixels, width * 4, width, height, m_tileHashes.data());
+
+            bool keyframe = ref.width != width || ref.height != height || ref.framesSinceKey >= kKeyframeInterval;
+            std::swap(ref.tileHashes, m_tileHashes);
+            ref.width = width;
+            ref.height = height;
+
+            if (keyframe)
+            {
+                ref.framesSinceKey = 0;
+                return Result{ FrameCodec::Raw, pixels, static_cast<uint32_t>(size), false };
+            }
+
+            uint32_t changed = codec::EncodeTiles(pixels, width, height, ref.tileHashes.data(), m_tileHashes.data(), output);
+            // Skipped frames don't count towards the keyframe interval, the client saw nothing
+            if (changed > 0)
+                ref.framesSinceKey++;
+            return Result{ FrameCodec::Tiles, output.data(), static_cast<uint32_t>(output.size()), changed == 0 };
+        }
+
+        case FrameCodec::Raw:
+        default:
+            // Also taken for formats the codecs can't handle; the next delta must be a keyframe
+            m_references[eye & 1].width = 0;
+            return Result{ FrameCodec::Raw, pixels, static_cast<uint32_t>(size), false };
+    }
+}
+
+void FrameEncoder::Reset()
+{
+    for (auto& ref : m_references)
+    {
+        ref.pixels.clear();
+        ref.tileHashes.clear();
+        ref.width = 0;
+        ref.height = 0;
+        ref.framesSinceKey = 0;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Wire IDs, carried in the frame info so clients know how to decode the payload
+enum class FrameCodec : uint32_t {
+    Raw = 0,      // Tightly packed BGRA
+    Qoi = 1,      // Lossless QOI-style intra coding
+    DeltaRle = 2, // XOR against the previous frame of the same eye, zero runs collapsed
+    Tiles = 3     // Only the tiles that changed since the previous frame of the same eye
+};
+
+// Encoded payload layout (Qoi and DeltaRle):
+//   uint32_t stripeCount
+//   uint32_t stripeRows            rows per stripe, the last stripe may be shorter
+//   uint32_t stripeSizes[stripeCount]
+//   stripe data, back to back
+// Stripes are coded independently so they can be encoded and decoded in parallel.
+//
+// Qoi stripes follow the QOI op set (INDEX, DIFF, LUMA, RUN, RGB, RGBA) over BGRA bytes,
+// without the QOI file header and end marker, with encoder state reset per stripe.
+//
+// DeltaRle stripes are a sequence of (varint unchangedPixels, varint changedPixels,
+// changedPixels x uint32 xor) groups covering every pixel of the stripe.
+//
+// Tiles payload layout:
+//   uint32_t tileSize
+//   uint32_t tileCount             changed tiles in this frame
+//   uint32_t tileIndices[tileCount] row-major index in the image's grid of tileSize squares
+//   tile pixels, back to back, each tile's rows tightly packed; edge tiles are cropped to the image
+// Tiles are pasted over the previous frame of the same eye. Keyframes are sent as Raw.
+
+namespace codec {
+
+// Number of stripes an image is split into for parallel coding
+static constexpr uint32_t kMaxStripes = 8;
+
+void EncodeQoi(const uint8_t* pixels, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+bool DecodeQoi(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels);
+
+// previous and pixels must both be width * height BGRA
+void EncodeDeltaRle(const uint8_t* pixels, const uint8_t* previous, uint32_t width, uint32_t height, std::vector<uint8_t>& out);
+// Applies the delta in place on top of the previous frame
+bool DecodeDeltaRle(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels);
+
+// Writes the tiles whose hash differs between tileHashes and previousHashes (GetTileCount entries each)
+uint32_t EncodeTiles(const uint8_t* pixels, uint32_t width, uint32_t height, const uint64_t* tileHashes, const uint64_t* previousHashes, std::vector<uint8_t>& out);
+// Pastes the tiles over the previous frame in place
+bool DecodeTiles(const uint8_t* data, size_t size, uint32_t width, uint32_t height, uint8_t* pixels);
+
+} // namespace codec
+
+// Per-connection encoder state. Delta coding keeps the last frame sent for each eye
+// and falls back to a Qoi keyframe whenever that reference is missing or stale.
+// Tile coding only keeps the last frame's tile hashes and uses Raw keyframes.
+class FrameEncoder
+{
+public:
+    struct Result {
+        FrameCodec codec;
+        const uint8_t* data;
+        uint32_t size;
+        bool unchanged;  // Tiles found nothing new; the frame need not be sent at all
+    };
+
+    // pixels stays owned by the caller; the result may point into it (Raw) or into the encoder.
+    // Encoder output is kept per eye, so a left and right result can be sent together.
+    Result Encode(FrameCodec codec, const uint8_t* pixels, size_t size, uint32_t width, uint32_t height, uint32_t eye);
+
+    // Forget delta references, e.g. when a new client connects. Raw and Qoi frames forget their
+    // eye's reference too, as the client decodes the next delta against them instead
+    void Reset();
+
+private:
+    struct Reference {
+        std::vector<uint8_t> pixels;
+        std::vector<uint64_t> tileHashes;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t framesSinceKey = 0;
+    };
+
+    // Force a keyframe every second at 90 Hz so late decoders resynchronize
+    static constexpr uint32_t kKeyframeInterval = 90;
+
+    std::vector<uint8_t> m_outputs[2];
+    std::vector<uint64_t> m_tileHashes;
+    Reference m_references[2];
+};
@@ -0,0 +1,246 @@
+#include "control.h"
+#include "../metrics/metrics.h"
+#include "../trace/trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace control {
+
+static Setting& s_traceEnabled = [] () -> Setting& {
+    Setting& setting = Registry::Get().AddBool("trace.enabled", false, "Record pipeline trace events");
+    setting.OnChange([](const Setting& changed) { trace::SetEnabled(changed.GetBool()); });
+    return setting;
+}();
+
+Setting::Setting(std::string_view name, SettingType type, double value, double min, double max, std::string_view help)
+    : m_name(name)
+    , m_help(help)
+    , m_type(type)
+    , m_min(min)
+    , m_max(max)
+    , m_value(value)
+{
+}
+
+void Setting::OnChange(std::function<void(const Setting&)> callback)
+{
+    m_onChange = std::move(callback);
+}
+
+static std::string FormatNumber(double value)
+{
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    return std::string(text, result.ptr);
+}
+
+std::string Setting::Format() const
+{
+    switch (m_type)
+    {
+        case SettingType::Bool:
+            return GetBool() ? "true" : "false";
+        case SettingType::Int:
+            return std::to_string(GetInt());
+        case SettingType::Float:
+            return FormatNumber(Get());
+    }
+    return {};
+}
+
+bool Setting::Parse(std::string_view text, double& value) const
+{
+    if (m_type == SettingType::Bool)
+    {
+        if (text == "1" || text == "true" || text == "on")
+            value = 1.0;
+        else if (text == "0" || text == "false" || text == "off")
+            value = 0.0;
+        else
+            return false;
+        return true;
+    }
+
+    if (m_type == SettingType::Int)
+    {
+        int64_t parsed = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), parsed);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+            return false;
+        value = static_cast<double>(parsed);
+    }
+    else
+    {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size() || !std::isfinite(value))
+            return false;
+    }
+    return value >= m_min && value <= m_max;
+}
+
+void Setting::Set(double value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+    if (m_onChange)
+        m_onChange(*this);
+}
+
+Registry& Registry::Get()
+{
+    static Registry registry;
+    return registry;
+}
+
+Setting& Registry::Add(std::string_view name, SettingType type, double value, double min, double max, std::string_view help)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (Setting& setting : m_settings)
+    {
+        if (setting.GetName() == name)
+            return setting;
+    }
+    return m_settings.emplace_back(name, type, value, min, max, help);
+}
+
+Setting& Registry::AddBool(std::string_view name, bool value, std::string_view help)
+{
+    return Add(name, SettingType::Bool, value ? 1.0 : 0.0, 0.0, 1.0, help);
+}
+
+Setting& Registry::AddInt(std::string_view name, int64_t value, int64_t min, int64_t max, std::string_view help)
+{
+    return Add(name, SettingType::Int, static_cast<double>(value), static_cast<double>(min), static_cast<double>(max), help);
+}
+
+Setting& Registry::AddFloat(std::string_view name, double value, double min, double max, std::string_view help)
+{
+    return Add(name, SettingType::Float, value, min, max, help);
+}
+
+Setting* Registry::Find(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (Setting& setting : m_settings)
+    {
+        if (setting.GetName() == name)
+            return &setting;
+    }
+    return nullptr;
+}
+
+static std::vector<std::string_view> SplitWords(std::string_view text)
+{
+    std::vector<std::string_view> words;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t start = text.find_first_not_of(" \t\r\n", pos);
+        if (start == std::string_view::npos)
+            break;
+        size_t end = text.find_first_of(" \t\r\n", start);
+        if (end == std::string_view::npos)
+            end = text.size();
+        words.push_back(text.substr(start, end - start));
+        pos = end;
+    }
+    return words;
+}
+
+static std::string FormatRange(const Setting& setting)
+{
+    switch (setting.GetType())
+    {
+        case SettingType::Bool:
+            return "bool";
+        case SettingType::Int:
+            return "int " + std::to_string(static_cast<int64_t>(setting.GetMin())) + ".." + std::to_string(static_cast<int64_t>(setting.GetMax()));
+        case SettingType::Float:
+            return "float " + FormatNumber(setting.GetMin()) + ".." + FormatNumber(setting.GetMax());
+    }
+    return {};
+}
+
+std::string Registry::Execute(std::string_view command, CommandSource source)
+{
+    std::vector<std::string_view> words = SplitWords(command);
+    if (words.empty())
+        return "error: empty command";
+
+    std::string_view verb = words[0];
+    if (verb == "list" && words.size() == 1)
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        std::string reply;
+        for (const Setting& setting : m_settings)
+            reply += setting.GetName() + " = " + setting.Format() + " (" + FormatRange(setting) + ") " + setting.GetHelp() + "\n";
+        return reply;
+    }
+
+    if (verb == "get" && words.size() == 2)
+    {
+        Setting* setting = Find(words[1]);
+        return setting ? setting->Format() : "error: unknown setting " + std::string(words[1]);
+    }
+
+    if (verb == "set" && words.size() >= 2)
+    {
+        // Nothing changes unless every pair is valid
+        std::vector<std::pair<Setting*, double>> changes;
+        for (size_t i = 1; i < words.size(); i++)
+        {
+            size_t equals = words[i].find('=');
+            if (equals == std::string_view::npos)
+                return "error: expected name=value, got " + std::string(words[i]);
+
+            std::string_view name = words[i].substr(0, equals);
+            Setting* setting = Find(name);
+            if (!setting)
+                return "error: unknown setting " + std::string(name);
+
+            double value;
+            if (!setting->Parse(words[i].substr(equals + 1), value))
+                return "error: " + std::string(name) + " takes " + FormatRange(*setting);
+            changes.emplace_back(setting, value);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto& [setting, value] : changes)
+            setting->Set(value);
+        return "ok";
+    }
+
+    if (verb == "metrics" && words.size() == 1)
+        return metrics::Registry::Get().FormatText();
+    if (verb == "metrics" && words.size() == 2 && words[1] == "json")
+        return metrics::Registry::Get().FormatJson();
+
+    if (verb == "trace" && words.size() == 2 && (words[1] == "start" || words[1] == "stop"))
+        return Execute(words[1] == "start" ? "set trace.enabled=1" : "set trace.enabled=0");
+
+    if (verb == "trace" && words.size() <= 3 && words.size() >= 2 && words[1] == "dump")
+    {
+        if (words.size() == 3 && source == CommandSource::Remote)
+            return "error: trace dump takes no path over the socket, use TraceRequest to get the trace";
+        std::string path = words.size() == 3 ? std::string(words[2]) : (std::filesystem::temp_directory_path() / "ovd_trace.json").string();
+        return trace::WriteChromeTrace(path) ? path : "error: failed to write " + path;
+    }
+
+    return "error: unknown command " + std::string(command);
+}
+
+void Registry::Execute(const char* command, char* response, uint32_t responseSize)
+{
+    if (!response || responseSize == 0)
+        return;
+
+    std::string reply = Execute(command ? command : "");
+    size_t length = std::min<size_t>(reply.size(), responseSize - 1);
+    std::memcpy(response, reply.data(), length);
+    response[length] = '\0';
+}
+
+} // namespace control
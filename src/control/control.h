@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Runtime settings. Modules declare their knobs once at file scope and read them where they are
+// used; a read is one relaxed atomic load, so hot paths never lock. Commands arrive as text
+// through DebugRequest or the socket's Control message, see Execute.
+
+namespace control {
+
+// Where a command came from. Remote commands arrive over the network from whoever can reach the
+// socket, so they may not pick files to write.
+enum class CommandSource {
+    Local,   // DebugRequest, tools in the same process
+    Remote   // The socket's Control message
+};
+
+enum class SettingType {
+    Bool,
+    Int,
+    Float
+};
+
+class Setting
+{
+public:
+    Setting(std::string_view name, SettingType type, double value, double min, double max, std::string_view help);
+
+    double Get() const { return m_value.load(std::memory_order_relaxed); }
+    bool GetBool() const { return Get() != 0.0; }
+    int64_t GetInt() const { return static_cast<int64_t>(Get()); }
+    float GetFloat() const { return static_cast<float>(Get()); }
+
+    const std::string& GetName() const { return m_name; }
+    const std::string& GetHelp() const { return m_help; }
+    SettingType GetType() const { return m_type; }
+    double GetMin() const { return m_min; }
+    double GetMax() const { return m_max; }
+
+    // Runs on the thread that changed the value, after the change
+    void OnChange(std::function<void(const Setting&)> callback);
+
+    std::string Format() const;
+    // Checks type and range without changing anything
+    bool Parse(std::string_view text, double& value) const;
+    void Set(double value);
+
+private:
+    std::string m_name;
+    std::string m_help;
+    SettingType m_type;
+    double m_min;
+    double m_max;
+    std::atomic<double> m_value;
+    std::function<void(const Setting&)> m_onChange;
+};
+
+class Registry
+{
+public:
+    static Registry& Get();
+
+    // Adding a name twice returns the first setting. References stay valid for the process lifetime.
+    Setting& AddBool(std::string_view name, bool value, std::string_view help);
+    Setting& AddInt(std::string_view name, int64_t value, int64_t min, int64_t max, std::string_view help);
+    Setting& AddFloat(std::string_view name, double value, double min, double max, std::string_view help);
+
+    Setting* Find(std::string_view name);
+
+    // Commands:
+    //   list                          every setting with its value, range and help
+    //   get <name>                    current value
+    //   set <name>=<value> ...        validates every pair, then applies them in order
+    //   metrics [json]                metrics snapshot
+    //   trace start|stop              same as set trace.enabled=1|0
+    //   trace dump [path]             writes a Chrome trace, default in the temp directory;
+    //                                 remote commands only get the default
+    // Replies are text; failures start with "error:".
+    std::string Execute(std::string_view command, CommandSource source = CommandSource::Local);
+    // For DebugRequest: the reply is truncated to the buffer and always terminated
+    void Execute(const char* command, char* response, uint32_t responseSize);
+
+private:
+    Setting& Add(std::string_view name, SettingType type, double value, double min, double max, std::string_view help);
+
+    std::deque<Setting> m_settings;
+    std::mutex m_mtx;
+};
+
+} // namespace control
@@ -1,5 +1,8 @@
 #include "controller_device_driver.h"
 #include <chrono>
+#include <optional>
+
+static control::Setting& s_poseRate = control::Registry::Get().AddFloat("pose.controller_rate_hz", 90.0, 1.0, 1000.0, "Controller pose updates per second");
 
 ControllerDriver::ControllerDriver(vr::ETrackedControllerRole role,
                                    mpsc::Receiver<ControllerInput> inputReceiver,
@@ -76,7 +79,8 @@ void ControllerDriver::InputUpdateThreadFunc(std::stop_token st)
 {
     while (!st.stop_requested())
     {
-        if (auto input = m_inputReceiver.recv())
+        // Woken by Deactivate too, which SteamVR calls while the socket still holds the sender
+        if (auto input = m_inputReceiver.recv(st))
         {
             vr::VRDriverInput()->UpdateScalarComponent(m_joystickXHandle, input->joystickX, 0);
             vr::VRDriverInput()->UpdateScalarComponent(m_joystickYHandle, input->joystickY, 0);
@@ -100,7 +104,7 @@ void ControllerDriver::InputUpdateThreadFunc(std::stop_token st)
         }
         else
         {
-            break; // Channel closed
+            break; // Channel closed or stopping
         }
     }
 }
@@ -119,11 +123,19 @@ void ControllerDriver::PoseUpdateThreadFunc(std::stop_token st)
     pose.vecPosition[2] = 0.0;
     pose.qRotation.w = 1.0;
 
+    PoseMetrics poseMetrics(m_serialNumber);
+    DeviceIdleTimer idleTimer(m_serialNumber);
+    trace::SetThreadName("Pose " + m_serialNumber);
+
     while (!st.stop_requested())
     {
-        // Check for new pose (non-blocking)
-        if (auto p = m_poseReceiver.try_recv())
+        // Newest pose since the last tick (non-blocking), or wait for one while parked
+        poseMetrics.RecordQueueDepth(m_poseReceiver.size());
+        std::optional<Pose> p = idleTimer.IsParked() ? m_poseReceiver.recv(st) : m_poseReceiver.try_recv_latest();
+        if (p)
         {
+            poseMetrics.RecordPose();
+            idleTimer.RecordPose();
             pose.vecPosition[0] = p->posX;
             pose.vecPosition[1] = p->posY;
             pose.vecPosition[2] = p->posZ;
@@ -138,10 +150,30 @@ void ControllerDriver::PoseUpdateThreadFunc(std::stop_token st)
             }
         }
 
-        // Always send current pose
-        vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_deviceIndex, pose, sizeof(vr::DriverPose_t));
+        else if (idleTimer.IsParked())
+        {
+            break;  // Stopped or channel closed
+        }
+
+        poseMetrics.RecordAge();
+
+        // The client stopped sending this device, so drop it out of range and stop publishing
+        if (idleTimer.ShouldPark())
+        {
+            vr::DriverPose_t parkedPose = pose;
+            parkedPose.poseIsValid = false;
+            parkedPose.result = vr::TrackingResult_Running_OutOfRange;
+            vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_deviceIndex, parkedPose, sizeof(vr::DriverPose_t));
+            continue;
+        }
+
+        // Send current pose
+        {
+            OVD_TRACE_SCOPE("pose.publish");
+            vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_deviceIndex, pose, sizeof(vr::DriverPose_t));
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(11)); // ~90Hz
+        std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / s_poseRate.Get()));
     }
 }
 
@@ -169,10 +201,10 @@ void* ControllerDriver::GetComponent(const char* pchComponentNameAndVersion)
     return nullptr;
 }
 
+// Runtime control commands, see control::Registry::Execute
 void ControllerDriver::DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize)
 {
-    if (unResponseBufferSize >= 1)
-        pchResponseBuffer[0] = 0;
+    control::Registry::Get().Execute(pchRequest, pchResponseBuffer, unResponseBufferSize);
 }
 
 vr::DriverPose_t ControllerDriver::GetPose()
@@ -5,6 +5,10 @@
 #include <thread>
 #include "../socket/socket_manager.h"
 #include "../mpsc/channel.h"
+#include "../metrics/pose_metrics.h"
+#include "../trace/trace.h"
+#include "../control/control.h"
+#include "../provider/device_activity.h"
 
 class ControllerDriver : public vr::ITrackedDeviceServerDriver
 {
@@ -24,6 +28,8 @@ public:
 
     // Public methods
     const char* GetSerialNumber() const { return m_serialNumber.c_str(); }
+    // What games name in VREvent_Input_HapticVibration to buzz this controller
+    vr::VRInputComponentHandle_t GetHapticHandle() const { return m_hapticHandle; }
 
 private:
     uint32_t m_deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
@@ -0,0 +1,49 @@
+#include "eye_writer.h"
+#include <vector>
+
+void WriteEye(WorkerPool& pool, const uint8_t* srcData, uint32_t rowPitch, const EyeLayout& layout, uint8_t* dst)
+{
+    // Crop and convert in a single pass over the mapped texture
+    if (!layout.resample)
+    {
+        pool.RunStripes(layout.source.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+            ConvertImageRows(srcData, rowPitch, layout.source, layout.sourceFormat, layout.format, dst, rowBegin, rowEnd);
+        });
+        return;
+    }
+
+    // Intermediates belong to the calling thread; stripes get plain pointers into them
+    static thread_local std::vector<uint8_t> unpacked;
+    static thread_local std::vector<uint8_t> scaled;
+
+    PixelRect source = layout.source;
+    if (layout.sourceFormat != SourceFormat::Bgra8)
+    {
+        // Resampling a 10-bit source happens at 8 bits; unscaled Rgba16F output keeps all 10
+        unpacked.resize(static_cast<size_t>(source.width) * source.height * 4);
+        uint8_t* unpackedData = unpacked.data();
+        pool.RunStripes(source.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+            ConvertImageRows(srcData, rowPitch, source, layout.sourceFormat, PixelFormat::Bgra8, unpackedData, rowBegin, rowEnd);
+        });
+        srcData = unpackedData;
+        rowPitch = source.width * 4;
+        source = { 0, 0, source.width, source.height };
+    }
+
+    // The resampler only produces BGRA, other formats convert each stripe right after scaling it
+    uint8_t* scaledData = dst;
+    if (layout.format != PixelFormat::Bgra8)
+    {
+        scaled.resize(static_cast<size_t>(layout.width) * layout.height * 4);
+        scaledData = scaled.data();
+    }
+
+    pool.RunStripes(layout.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+        ResampleBgraRows(srcData, rowPitch, source, scaledData, layout.width, layout.height, layout.filter, rowBegin, rowEnd);
+        if (scaledData != dst)
+        {
+            PixelRect scaledRect { 0, 0, layout.width, layout.height };
+            ConvertBgraRows(scaledData, layout.width * 4, scaledRect, layout.format, dst, rowBegin, rowEnd);
+        }
+    });
+}
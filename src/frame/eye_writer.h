@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include "../image/convert.h"
+#include "../image/resample.h"
+#include "../thread/worker_pool.h"
+
+// Where an eye's pixels come from in the staging texture and the size they are sent at
+struct EyeLayout {
+    PixelRect source;
+    uint32_t width;
+    uint32_t height;
+    ResampleFilter filter;
+    SourceFormat sourceFormat;
+    PixelFormat format;
+    bool resample;
+};
+
+// Crops, scales and converts one eye from mapped memory into dst, which must hold
+// GetPixelFormatSize(layout.format, layout.width, layout.height) bytes. The work is split
+// into row stripes across the pool; returns once every stripe is done.
+void WriteEye(WorkerPool& pool, const uint8_t* srcData, uint32_t rowPitch, const EyeLayout& layout, uint8_t* dst);
@@ -0,0 +1,158 @@
+#include "frame_buffer_pool.h"
+#include <new>
+
+FrameBufferRef::FrameBufferRef(const FrameBufferRef& other)
+    : m_buffer(other.m_buffer)
+{
+    if (m_buffer)
+        m_buffer->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameBufferRef::FrameBufferRef(FrameBufferRef&& other) noexcept
+    : m_buffer(other.m_buffer)
+{
+    other.m_buffer = nullptr;
+}
+
+FrameBufferRef& FrameBufferRef::operator=(const FrameBufferRef& other)
+{
+    if (this != &other)
+    {
+        if (other.m_buffer)
+            other.m_buffer->refs.fetch_add(1, std::memory_order_relaxed);
+        Release();
+        m_buffer = other.m_buffer;
+    }
+    return *this;
+}
+
+FrameBufferRef& FrameBufferRef::operator=(FrameBufferRef&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_buffer = other.m_buffer;
+        other.m_buffer = nullptr;
+    }
+    return *this;
+}
+
+FrameBufferRef::~FrameBufferRef()
+{
+    Release();
+}
+
+const uint8_t* FrameBufferRef::GetData() const
+{
+    return m_buffer ? m_buffer->data : nullptr;
+}
+
+size_t FrameBufferRef::GetSize() const
+{
+    return m_buffer ? m_buffer->size : 0;
+}
+
+uint8_t* FrameBufferRef::GetMutableData()
+{
+    return m_buffer ? m_buffer->data : nullptr;
+}
+
+uint32_t FrameBufferRef::GetUseCount() const
+{
+    return m_buffer ? m_buffer->refs.load(std::memory_order_relaxed) : 0;
+}
+
+void FrameBufferRef::Release()
+{
+    if (!m_buffer)
+        return;
+
+    // Last owner hands the memory back; acq_rel orders every reader's use before reuse
+    if (m_buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        m_buffer->pool->Recycle(m_buffer);
+    m_buffer = nullptr;
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    for (auto* buffer : m_free)
+        Destroy(buffer);
+}
+
+FrameBufferPool& FrameBufferPool::Shared()
+{
+    static FrameBufferPool pool;
+    return pool;
+}
+
+FrameBufferRef FrameBufferPool::Acquire(size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        // Best fit, but never more than twice the request so a size change doesn't pin huge buffers
+        size_t best = m_free.size();
+        for (size_t i = 0; i < m_free.size(); i++)
+        {
+            size_t capacity = m_free[i]->capacity;
+            if (capacity >= size && capacity <= size * 2 && (best == m_free.size() || capacity < m_free[best]->capacity))
+                best = i;
+        }
+
+        if (best < m_free.size())
+        {
+            FrameBufferRef::Buffer* buffer = m_free[best];
+            m_free.erase(m_free.begin() + best);
+            buffer->size = size;
+            buffer->refs.store(1, std::memory_order_relaxed);
+            m_reuses++;
+            m_outstanding++;
+            return FrameBufferRef(buffer);
+        }
+
+        m_allocations++;
+        m_outstanding++;
+    }
+
+    size_t capacity = (size + kPageSize - 1) / kPageSize * kPageSize;
+    auto* buffer = new FrameBufferRef::Buffer{
+        this,
+        static_cast<uint8_t*>(::operator new(capacity > 0 ? capacity : kPageSize, std::align_val_t{ kPageSize })),
+        capacity,
+        size,
+        1
+    };
+    return FrameBufferRef(buffer);
+}
+
+void FrameBufferPool::Recycle(FrameBufferRef::Buffer* buffer)
+{
+    FrameBufferRef::Buffer* evicted = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_outstanding--;
+
+        // The oldest free buffer is the one least likely to match current frame sizes
+        if (m_free.size() >= kMaxFreeBuffers)
+        {
+            evicted = m_free.front();
+            m_free.erase(m_free.begin());
+        }
+        m_free.push_back(buffer);
+    }
+
+    if (evicted)
+        Destroy(evicted);
+}
+
+void FrameBufferPool::Destroy(FrameBufferRef::Buffer* buffer)
+{
+    ::operator delete(buffer->data, std::align_val_t{ kPageSize });
+    delete buffer;
+}
+
+FrameBufferPoolStats FrameBufferPool::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return FrameBufferPoolStats{ m_allocations, m_reuses, m_outstanding, static_cast<uint32_t>(m_free.size()) };
+}
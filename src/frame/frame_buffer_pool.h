@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+class FrameBufferPool;
+
+// Shared handle to a pooled, page-aligned pixel buffer. Copies share the same memory and
+// the buffer goes back to its pool when the last copy is released. Once a buffer has been
+// handed to more than one owner it must be treated as read-only.
+class FrameBufferRef
+{
+public:
+    FrameBufferRef() = default;
+    FrameBufferRef(const FrameBufferRef& other);
+    FrameBufferRef(FrameBufferRef&& other) noexcept;
+    FrameBufferRef& operator=(const FrameBufferRef& other);
+    FrameBufferRef& operator=(FrameBufferRef&& other) noexcept;
+    ~FrameBufferRef();
+
+    explicit operator bool() const { return m_buffer != nullptr; }
+
+    const uint8_t* GetData() const;
+    size_t GetSize() const;
+
+    // For filling the buffer right after Acquire, while this is the only reference
+    uint8_t* GetMutableData();
+
+    uint32_t GetUseCount() const;
+
+private:
+    friend class FrameBufferPool;
+
+    struct Buffer {
+        FrameBufferPool* pool;
+        uint8_t* data;
+        size_t capacity;
+        size_t size;
+        std::atomic<uint32_t> refs;
+    };
+
+    explicit FrameBufferRef(Buffer* buffer) : m_buffer(buffer) {}
+    void Release();
+
+    Buffer* m_buffer = nullptr;
+};
+
+struct FrameBufferPoolStats {
+    uint64_t allocations;  // Buffers created because nothing suitable was free
+    uint64_t reuses;       // Acquires served from the free list
+    uint32_t outstanding;  // Buffers currently referenced
+    uint32_t free;         // Buffers waiting in the free list
+};
+
+// Recycles frame-sized buffers so Present does not allocate and zero megabytes per eye
+// per frame. Buffers are page-aligned and keep their pages mapped between uses.
+// The pool must outlive every FrameBufferRef it handed out.
+class FrameBufferPool
+{
+public:
+    FrameBufferPool() = default;
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    // Contents are left over from the previous user
+    FrameBufferRef Acquire(size_t size);
+
+    FrameBufferPoolStats GetStats();
+
+    static FrameBufferPool& Shared();
+
+private:
+    friend class FrameBufferRef;
+
+    static constexpr size_t kPageSize = 4096;
+    // Enough for a few stereo frames in flight across every consumer
+    static constexpr size_t kMaxFreeBuffers = 8;
+
+    void Recycle(FrameBufferRef::Buffer* buffer);
+    static void Destroy(FrameBufferRef::Buffer* buffer);
+
+    std::vector<FrameBufferRef::Buffer*> m_free;
+    std::mutex m_mtx;
+    uint64_t m_allocations = 0;
+    uint64_t m_reuses = 0;
+    uint32_t m_outstanding = 0;
+};
@@ -0,0 +1,50 @@
+#include "frame_fanout.h"
+#include <algorithm>
+
+void FrameFanout::Subscribe(FrameSubscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (std::find(m_subscribers.begin(), m_subscribers.end(), subscriber) == m_subscribers.end())
+        m_subscribers.push_back(subscriber);
+}
+
+void FrameFanout::Unsubscribe(FrameSubscriber* subscriber)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::erase(m_subscribers, subscriber);
+}
+
+uint32_t FrameFanout::GetWantedEyes(uint64_t frameIndex, const FrameSubscriber* except)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    uint32_t eyes = 0;
+    for (auto* subscriber : m_subscribers)
+    {
+        if (subscriber == except)
+            continue;
+        eyes |= subscriber->GetWantedEyes(frameIndex);
+        if (eyes == 3)
+            break;
+    }
+    return eyes;
+}
+
+void FrameFanout::Publish(const FramePacket& packet, const FrameSubscriber* except)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (auto* subscriber : m_subscribers)
+    {
+        if (subscriber != except)
+            subscriber->OnFrame(packet);
+    }
+}
+
+void FrameFanout::PublishStereo(const FramePacket& left, const FramePacket& right, const FrameSubscriber* except)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (auto* subscriber : m_subscribers)
+    {
+        if (subscriber != except)
+            subscriber->OnStereoFrame(left, right);
+    }
+}
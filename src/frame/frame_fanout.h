@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "frame_buffer_pool.h"
+#include "frame_metadata.h"
+#include "../image/convert.h"
+
+// A cropped eye image. Copies share the pooled pixel buffer read-only.
+struct FramePacket {
+    FrameBufferRef pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t eye;
+    PixelFormat format;
+    uint64_t frameIndex;
+    FrameMetadata metadata;
+};
+
+// Outbound consumer of published frames (socket sender, recorder, ...). Called on the
+// compositor thread, so implementations should only take a copy of the packet and return.
+class FrameSubscriber
+{
+public:
+    virtual ~FrameSubscriber() = default;
+    virtual void OnFrame(const FramePacket& packet) = 0;
+    // Both eyes of the same Present, for consumers that want matched pairs
+    virtual void OnStereoFrame(const FramePacket& left, const FramePacket& right) = 0;
+    // Eye mask (bit 0 left, bit 1 right) this subscriber wants from the given frame
+    virtual uint32_t GetWantedEyes(uint64_t frameIndex) { return 3; }
+};
+
+// Hands every frame to all subscribers without copying pixels. The buffer returns to the
+// pool once the last subscriber drops its packet.
+class FrameFanout
+{
+public:
+    void Subscribe(FrameSubscriber* subscriber);
+    void Unsubscribe(FrameSubscriber* subscriber);
+
+    // except, if set, is skipped: a subscriber whose frames already went out another way
+    void Publish(const FramePacket& packet, const FrameSubscriber* except = nullptr);
+    void PublishStereo(const FramePacket& left, const FramePacket& right, const FrameSubscriber* except = nullptr);
+
+    // Union of what the subscribers but except want; Present skips readback of everything else
+    uint32_t GetWantedEyes(uint64_t frameIndex, const FrameSubscriber* except = nullptr);
+
+private:
+    std::vector<FrameSubscriber*> m_subscribers;
+    std::mutex m_mtx;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Microseconds on the driver's monotonic clock. Only differences between stamps are meaningful.
+inline uint64_t GetDriverTimeUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// What a frame was rendered from and when it moved through the driver. Sent with every Frame and
+// StereoFrame message so clients can reproject and measure motion-to-photon latency.
+//
+// poseSequence numbers the client's BodyPosition messages on the current connection from 1; it is
+// the newest one the HMD had published when the frame was submitted, 0 before any arrived.
+// The *Us stamps are driver time (GetDriverTimeUs).
+struct FrameMetadata {
+    uint64_t frameIndex;
+    uint64_t poseSequence;
+    uint64_t poseReceivedUs;
+    uint64_t submitUs;
+    uint64_t presentUs;
+    uint64_t sendUs;       // Stamped just before the message goes out
+    float hmdPose[3][4];   // mHmdPose of the submitted layer, row-major 3x4 world-from-head
+};
+
+static_assert(sizeof(FrameMetadata) == 96, "FrameMetadata layout is shared with clients");
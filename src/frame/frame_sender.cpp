@@ -0,0 +1,218 @@
+#include "frame_sender.h"
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+FrameSender::FrameSender(SocketManager* socketManager, FrameTimer* frameTimer)
+    : m_pSocketManager(socketManager)
+    , m_pFrameTimer(frameTimer)
+{
+}
+
+FrameSender::~FrameSender()
+{
+    Stop();
+}
+
+void FrameSender::Start()
+{
+    if (m_sendThread.joinable())
+        return;
+
+    m_sendThread = std::jthread([this](std::stop_token st) { SendThreadFunc(st); });
+}
+
+void FrameSender::Stop()
+{
+    if (m_sendThread.joinable())
+    {
+        m_sendThread.request_stop();
+        m_sendThread.join();
+    }
+    m_framesDropped.Add(m_mailbox.clear());
+}
+
+void FrameSender::Submit(FramePacket packet)
+{
+    m_framesProduced.Add();
+    size_t evicted = m_mailbox.push(FrameSubmission{ { std::move(packet), {} }, false, GetDriverTimeUs() });
+    m_framesDropped.Add(evicted);
+    m_pendingEvictions.fetch_add(static_cast<uint32_t>(evicted), std::memory_order_relaxed);
+}
+
+void FrameSender::SubmitStereo(FramePacket left, FramePacket right)
+{
+    m_framesProduced.Add();
+    size_t evicted = m_mailbox.push(FrameSubmission{ { std::move(left), std::move(right) }, true, GetDriverTimeUs() });
+    m_framesDropped.Add(evicted);
+    m_pendingEvictions.fetch_add(static_cast<uint32_t>(evicted), std::memory_order_relaxed);
+}
+
+void FrameSender::OnFrame(const FramePacket& packet)
+{
+    // Other subscribers may have asked for eyes or frames this client didn't
+    if ((GetWantedEyes(packet.frameIndex) >> packet.eye) & 1 && !m_pSocketManager->IsStereoEnabled())
+        Submit(packet);
+}
+
+void FrameSender::OnStereoFrame(const FramePacket& left, const FramePacket& right)
+{
+    if (GetWantedEyes(left.frameIndex) != 0 && m_pSocketManager->IsStereoEnabled())
+        SubmitStereo(left, right);
+}
+
+uint32_t FrameSender::GetWantedEyes(uint64_t frameIndex)
+{
+    if (!m_pSocketManager || !m_pSocketManager->IsConnected())
+        return 0;
+
+    // The quality controller thins frames on top of whatever rate the client asked for
+    FrameSubscription subscription = m_pSocketManager->GetFrameSubscription();
+    subscription.frameDivisor = std::max(subscription.frameDivisor, 1u) * m_quality.GetQuality().frameDivisor;
+
+    double displayFrequency = m_pFrameTimer ? m_pFrameTimer->GetDisplayFrequency() : 0.0;
+    uint32_t eyes = SelectSubscribedEyes(subscription, frameIndex, displayFrequency);
+
+    // A stereo message needs both eyes of the frame
+    if (eyes != 0 && m_pSocketManager->IsStereoEnabled())
+        eyes = 3;
+    return eyes;
+}
+
+FrameSenderStats FrameSender::GetStats() const
+{
+    return FrameSenderStats{
+        m_framesProduced.Get(),
+        m_framesSent.Get(),
+        m_framesDropped.Get(),
+        m_framesUnchanged.Get()
+    };
+}
+
+void FrameSender::SendThreadFunc(std::stop_token st)
+{
+    trace::SetThreadName("Frame sender");
+    while (!st.stop_requested())
+    {
+        auto submission = m_mailbox.recv(st);
+        if (!submission)
+            break; // Stop requested
+
+        if (!m_pSocketManager || !m_pSocketManager->IsConnected())
+        {
+            m_framesDropped.Add();
+            continue;
+        }
+
+        // A new client starts at full quality
+        uint64_t connectionId = m_pSocketManager->GetConnectionId();
+        if (connectionId != m_encoderConnectionId)
+        {
+            m_quality.Reset();
+            m_pendingEvictions = 0;
+        }
+
+        FrameCodec codec = m_pSocketManager->GetFrameCodec();
+        if (codec == FrameCodec::Raw && m_quality.GetQuality().compress)
+            codec = FrameCodec::Qoi;
+
+        // A new client, or one that just switched codec, has no delta references yet
+        if (connectionId != m_encoderConnectionId || codec != m_encoderCodec)
+        {
+            m_encoder.Reset();
+            m_encoderConnectionId = connectionId;
+            m_encoderCodec = codec;
+        }
+
+        auto sendStart = std::chrono::steady_clock::now();
+        SendResult result;
+        {
+            OVD_TRACE_SCOPE_ARG("sender.frame", "frame", submission->eyes[0].frameIndex);
+            result = submission->stereo
+                ? SendStereo(submission->eyes[0], submission->eyes[1], codec)
+                : SendEye(submission->eyes[0], codec);
+        }
+        m_sendTime.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sendStart).count()));
+
+        if (result != SendResult::Failed)
+            m_quality.RecordFrame(GetDriverTimeUs() - submission->queuedUs, m_pendingEvictions.exchange(0, std::memory_order_relaxed));
+
+        if (result == SendResult::Unchanged)
+        {
+            m_framesUnchanged.Add();
+        }
+        else if (result == SendResult::Sent)
+        {
+            m_framesSent.Add();
+
+            if (m_pFrameTimer)
+            {
+                uint64_t frameIndex = submission->eyes[0].frameIndex;
+                m_pFrameTimer->MarkSent(frameIndex);
+                if (m_pSocketManager->IsTimingEnabled())
+                    m_pSocketManager->SendFrameTiming(m_pFrameTimer->GetReport(frameIndex));
+            }
+        }
+        else
+        {
+            m_framesDropped.Add();
+        }
+    }
+}
+
+FrameSender::SendResult FrameSender::SendEye(const FramePacket& packet, FrameCodec codec)
+{
+    // The codecs work on whole BGRA/RGBA pixels, anything else goes out raw
+    if (!IsFourBytePixelFormat(packet.format))
+        codec = FrameCodec::Raw;
+
+    auto encoded = m_encoder.Encode(codec, packet.pixels.GetData(), packet.pixels.GetSize(), packet.width, packet.height, packet.eye);
+    if (encoded.unchanged)
+        return SendResult::Unchanged;
+
+    Frame frame { encoded.data, packet.width, packet.height, packet.eye, encoded.codec, packet.format, encoded.size };
+    return m_pSocketManager->SendFrame(frame, packet.metadata) ? SendResult::Sent : SendResult::Failed;
+}
+
+FrameSender::SendResult FrameSender::SendStereo(const FramePacket& left, const FramePacket& right, FrameCodec codec)
+{
+    if (!IsFourBytePixelFormat(left.format) || !IsFourBytePixelFormat(right.format))
+        codec = FrameCodec::Raw;
+
+    StereoLayout layout = m_pSocketManager->GetStereoLayout();
+    if (layout == StereoLayout::SideBySide && (left.height != right.height || left.format != right.format || IsPlanarPixelFormat(left.format)))
+        layout = StereoLayout::Sequential;
+
+    if (layout == StereoLayout::Sequential)
+    {
+        auto leftEncoded = m_encoder.Encode(codec, left.pixels.GetData(), left.pixels.GetSize(), left.width, left.height, 0);
+        auto rightEncoded = m_encoder.Encode(codec, right.pixels.GetData(), right.pixels.GetSize(), right.width, right.height, 1);
+        // One changed eye still goes out as a pair, the other with an empty tile list
+        if (leftEncoded.unchanged && rightEncoded.unchanged)
+            return SendResult::Unchanged;
+
+        Frame leftFrame { leftEncoded.data, left.width, left.height, 0, leftEncoded.codec, left.format, leftEncoded.size };
+        Frame rightFrame { rightEncoded.data, right.width, right.height, 1, rightEncoded.codec, right.format, rightEncoded.size };
+        return m_pSocketManager->SendStereoFrame(left.metadata, layout, leftFrame, rightFrame) ? SendResult::Sent : SendResult::Failed;
+    }
+
+    // Interleave rows so the pair is one image; the combined width forces a keyframe on switch
+    size_t pixelSize = GetPixelFormatSize(left.format, 1, 1);
+    size_t leftRow = left.width * pixelSize;
+    size_t rightRow = right.width * pixelSize;
+    m_stereoPixels.resize((leftRow + rightRow) * left.height);
+    for (uint32_t y = 0; y < left.height; y++)
+    {
+        uint8_t* row = m_stereoPixels.data() + y * (leftRow + rightRow);
+        std::memcpy(row, left.pixels.GetData() + y * leftRow, leftRow);
+        std::memcpy(row + leftRow, right.pixels.GetData() + y * rightRow, rightRow);
+    }
+
+    auto encoded = m_encoder.Encode(codec, m_stereoPixels.data(), m_stereoPixels.size(), left.width + right.width, left.height, 0);
+    if (encoded.unchanged)
+        return SendResult::Unchanged;
+
+    Frame leftFrame { encoded.data, left.width, left.height, 0, encoded.codec, left.format, encoded.size };
+    Frame rightFrame { nullptr, right.width, right.height, 1, encoded.codec, right.format, 0 };
+    return m_pSocketManager->SendStereoFrame(left.metadata, layout, leftFrame, rightFrame) ? SendResult::Sent : SendResult::Failed;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "../socket/socket_manager.h"
+#include "frame_fanout.h"
+#include "../mpsc/mailbox.h"
+#include "../codec/frame_codec.h"
+#include "quality_controller.h"
+#include "../timing/frame_timer.h"
+#include "../metrics/metrics.h"
+#include "../trace/trace.h"
+
+// One mailbox entry: a single eye, or both eyes of the same Present for stereo clients
+struct FrameSubmission {
+    FramePacket eyes[2];
+    bool stereo;
+    uint64_t queuedUs;  // GetDriverTimeUs
+};
+
+// Counted per submission, so a stereo pair counts once
+struct FrameSenderStats {
+    uint64_t produced;
+    uint64_t sent;
+    uint64_t dropped;
+    uint64_t unchanged;  // Not sent because tile coding found no change
+};
+
+// Moves frame transmission off the compositor thread. Present only enqueues;
+// a dedicated thread drains the mailbox and blocks on the socket instead.
+class FrameSender : public FrameSubscriber
+{
+public:
+    // frameTimer may be null; when set, each sent frame is stamped and reported to timing clients
+    FrameSender(SocketManager* socketManager, FrameTimer* frameTimer);
+    ~FrameSender();
+
+    void Start();
+    void Stop();
+
+    // Never blocks on the network. Stale frames are dropped if the client falls behind.
+    void Submit(FramePacket packet);
+    // Both eyes go out together in one StereoFrame message
+    void SubmitStereo(FramePacket left, FramePacket right);
+
+    // Follows the client's choice between per-eye and stereo messages
+    void OnFrame(const FramePacket& packet) override;
+    void OnStereoFrame(const FramePacket& left, const FramePacket& right) override;
+    // Follows the client's subscription; nothing while no client is connected
+    uint32_t GetWantedEyes(uint64_t frameIndex) override;
+
+    FrameSenderStats GetStats() const;
+    // Output resolution factor Present should apply for the adaptive quality controller
+    float GetQualityScale() const { return m_quality.GetQuality().scale; }
+
+private:
+    enum class SendResult { Sent, Unchanged, Failed };
+
+    void SendThreadFunc(std::stop_token st);
+    SendResult SendEye(const FramePacket& packet, FrameCodec codec);
+    SendResult SendStereo(const FramePacket& left, const FramePacket& right, FrameCodec codec);
+
+    SocketManager* m_pSocketManager;
+    FrameTimer* m_pFrameTimer;
+
+    // Encoding happens here rather than in Present, only touched by the send thread
+    FrameEncoder m_encoder;
+    uint64_t m_encoderConnectionId = 0;
+    FrameCodec m_encoderCodec = FrameCodec::Raw;
+    // Side by side stereo images are assembled here
+    std::vector<uint8_t> m_stereoPixels;
+
+    // Two slots so a left/right pair can be in flight together
+    mpsc::Mailbox<FrameSubmission> m_mailbox{2};
+    // Evictions since the send thread last looked, for the quality controller
+    std::atomic<uint32_t> m_pendingEvictions{0};
+    QualityController m_quality;
+    std::jthread m_sendThread;
+
+    // Shared with the metrics snapshot
+    metrics::Counter& m_framesProduced = metrics::Registry::Get().GetCounter("sender.frames_produced");
+    metrics::Counter& m_framesSent = metrics::Registry::Get().GetCounter("sender.frames_sent");
+    metrics::Counter& m_framesDropped = metrics::Registry::Get().GetCounter("sender.frames_dropped");
+    metrics::Counter& m_framesUnchanged = metrics::Registry::Get().GetCounter("sender.frames_unchanged");
+    metrics::Histogram& m_sendTime = metrics::Registry::Get().GetHistogram("sender.encode_send_us");
+};
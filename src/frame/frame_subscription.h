@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Which eyes of which frames a consumer wants. Also the payload of a Subscription message.
+struct FrameSubscription {
+    uint32_t eyeMask;       // Bit 0 left eye, bit 1 right eye
+    uint32_t frameDivisor;  // Every Nth frame; 0 and 1 take every frame
+    float maxFps;           // Rounded down to a whole divisor of the display rate; 0 for no limit
+    uint32_t paused;
+};
+
+static constexpr FrameSubscription kDefaultFrameSubscription{ 3, 1, 0.0f, 0 };
+
+// Eyes of frameIndex the subscription asks for. Stateless, so whether a frame was wanted
+// can be asked again when its pixels come back from the pipelined readback.
+inline uint32_t SelectSubscribedEyes(const FrameSubscription& subscription, uint64_t frameIndex, double displayFrequency)
+{
+    if (subscription.paused)
+        return 0;
+
+    uint64_t divisor = subscription.frameDivisor > 1 ? subscription.frameDivisor : 1;
+    if (subscription.maxFps > 0.0f && displayFrequency > subscription.maxFps)
+        divisor = std::max<uint64_t>(divisor, static_cast<uint64_t>(std::ceil(displayFrequency / subscription.maxFps - 1e-3)));
+
+    return frameIndex % divisor == 0 ? (subscription.eyeMask & 3) : 0;
+}
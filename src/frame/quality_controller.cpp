@@ -0,0 +1,143 @@
+#include "quality_controller.h"
+#include "../control/control.h"
+#include "../metrics/metrics.h"
+#include "../trace/trace.h"
+#include <algorithm>
+#include <cmath>
+
+static control::Setting& s_enabled = control::Registry::Get().AddBool("adaptive.enabled", true, "Lower frame quality when sends fall behind");
+static control::Setting& s_targetLatency = control::Registry::Get().AddFloat("adaptive.target_latency_ms", 20.0, 1.0, 1000.0, "Queue-to-sent latency the controller holds frames under");
+static control::Setting& s_minScale = control::Registry::Get().AddFloat("adaptive.min_scale", 0.5, 0.1, 1.0, "Smallest output resolution factor");
+static control::Setting& s_maxDivisor = control::Registry::Get().AddInt("adaptive.max_divisor", 3, 1, 16, "Largest frame rate divisor");
+static control::Setting& s_compress = control::Registry::Get().AddBool("adaptive.compress", false, "Allow switching raw clients to QOI");
+
+static metrics::Counter& s_stepsDown = metrics::Registry::Get().GetCounter("quality.steps_down");
+static metrics::Counter& s_stepsUp = metrics::Registry::Get().GetCounter("quality.steps_up");
+static metrics::Gauge& s_levelGauge = metrics::Registry::Get().GetGauge("quality.level");
+static metrics::Gauge& s_scaleGauge = metrics::Registry::Get().GetGauge("quality.scale_pct");
+static metrics::Gauge& s_divisorGauge = metrics::Registry::Get().GetGauge("quality.frame_divisor");
+static metrics::Gauge& s_compressGauge = metrics::Registry::Get().GetGauge("quality.compress");
+static metrics::Histogram& s_windowLatency = metrics::Registry::Get().GetHistogram("quality.window_latency_us");
+
+static constexpr float kScaleStep = 0.75f;
+// Sent frames per decision
+static constexpr uint32_t kWindowFrames = 15;
+// Stepping up needs this many windows in a row under kHeadroom of the target. One resolution
+// step is ~1.8x the bytes, so anything much above half the target would bounce straight back.
+static constexpr uint32_t kFastWindowsToStepUp = 4;
+static constexpr double kHeadroom = 0.5;
+
+// The ladder is rebuilt from the current bounds on every read, so changing them takes effect at once
+struct Ladder {
+    uint32_t compressSteps;
+    uint32_t scaleSteps;
+    uint32_t divisorSteps;
+
+    uint32_t GetMaxLevel() const { return compressSteps + scaleSteps + divisorSteps; }
+};
+
+static Ladder GetLadder()
+{
+    double minScale = s_minScale.Get();
+    uint32_t scaleSteps = minScale < 1.0 ? static_cast<uint32_t>(std::floor(std::log(minScale) / std::log(kScaleStep) + 1e-6)) : 0;
+    return Ladder{ s_compress.GetBool() ? 1u : 0u, scaleSteps, static_cast<uint32_t>(s_maxDivisor.GetInt() - 1) };
+}
+
+void QualityController::Reset()
+{
+    m_windowFrames = 0;
+    m_windowLatencyUs = 0;
+    m_windowEvicted = 0;
+    m_fastWindows = 0;
+    m_settling = false;
+    Step(0);
+}
+
+uint32_t QualityController::GetLevel() const
+{
+    return s_enabled.GetBool() ? std::min(m_level.load(std::memory_order_relaxed), GetLadder().GetMaxLevel()) : 0;
+}
+
+QualityLevel QualityController::GetQuality() const
+{
+    Ladder ladder = GetLadder();
+    uint32_t level = GetLevel();
+
+    uint32_t compressStep = std::min(level, ladder.compressSteps);
+    level -= compressStep;
+    uint32_t scaleStep = std::min(level, ladder.scaleSteps);
+    level -= scaleStep;
+
+    return QualityLevel{ compressStep > 0, std::pow(kScaleStep, static_cast<float>(scaleStep)), 1 + level };
+}
+
+void QualityController::Step(uint32_t level)
+{
+    uint32_t previous = m_level.exchange(level, std::memory_order_relaxed);
+    if (level > previous)
+        s_stepsDown.Add();
+    else if (level < previous)
+        s_stepsUp.Add();
+    if (level != previous)
+        OVD_TRACE_INSTANT("quality.step", "level", level);
+
+    QualityLevel quality = GetQuality();
+    s_levelGauge.Set(GetLevel());
+    s_scaleGauge.Set(static_cast<int64_t>(std::lround(quality.scale * 100.0f)));
+    s_divisorGauge.Set(quality.frameDivisor);
+    s_compressGauge.Set(quality.compress ? 1 : 0);
+}
+
+void QualityController::RecordFrame(uint64_t latencyUs, uint32_t evicted)
+{
+    if (!s_enabled.GetBool())
+    {
+        if (m_level.load(std::memory_order_relaxed) != 0)
+            Reset();
+        return;
+    }
+
+    m_windowFrames++;
+    m_windowLatencyUs += latencyUs;
+    m_windowEvicted += evicted;
+    if (m_windowFrames < kWindowFrames)
+        return;
+
+    uint64_t meanLatencyUs = m_windowLatencyUs / m_windowFrames;
+    uint32_t evictedInWindow = m_windowEvicted;
+    bool settling = m_settling;
+    m_windowFrames = 0;
+    m_windowLatencyUs = 0;
+    m_windowEvicted = 0;
+    m_settling = false;
+    s_windowLatency.Record(meanLatencyUs);
+
+    // The window right after a step still holds frames queued at the old level
+    if (settling)
+        return;
+
+    double targetUs = s_targetLatency.Get() * 1000.0;
+    uint32_t level = std::min(m_level.load(std::memory_order_relaxed), GetLadder().GetMaxLevel());
+    if (meanLatencyUs > targetUs || evictedInWindow > kWindowFrames / 4)
+    {
+        m_fastWindows = 0;
+        if (level < GetLadder().GetMaxLevel())
+        {
+            Step(level + 1);
+            m_settling = true;
+        }
+    }
+    else if (meanLatencyUs < targetUs * kHeadroom && evictedInWindow == 0 && level > 0)
+    {
+        if (++m_fastWindows >= kFastWindowsToStepUp)
+        {
+            m_fastWindows = 0;
+            Step(level - 1);
+            m_settling = true;
+        }
+    }
+    else
+    {
+        m_fastWindows = 0;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// What the controller currently allows the frame path to send
+struct QualityLevel {
+    bool compress;          // Raw clients get QOI instead
+    float scale;            // Output resolution factor on top of the client's OutputSpec
+    uint32_t frameDivisor;  // Extra divisor on top of the client's subscription
+};
+
+// Holds a target latency for one connection by trading frame quality for throughput.
+// The send thread reports every frame; the compositor thread reads the current level.
+//
+// Levels step down in the order that costs least: lossless compression (if allowed), then
+// resolution in 0.75 steps, then frame rate. One slow window steps down, several fast ones in
+// a row step back up. Bounds and the target are control settings (adaptive.*) and apply at once.
+class QualityController
+{
+public:
+    // Back to full quality, e.g. for a new connection
+    void Reset();
+
+    // latencyUs: from the frame being queued until its send completed.
+    // evicted: frames dropped from the queue since the last call.
+    void RecordFrame(uint64_t latencyUs, uint32_t evicted);
+
+    uint32_t GetLevel() const;
+    QualityLevel GetQuality() const;
+
+private:
+    void Step(uint32_t level);
+
+    std::atomic<uint32_t> m_level{0};
+
+    // Send thread only
+    uint32_t m_windowFrames = 0;
+    uint64_t m_windowLatencyUs = 0;
+    uint32_t m_windowEvicted = 0;
+    uint32_t m_fastWindows = 0;
+    bool m_settling = false;
+};
@@ -5,50 +5,38 @@
 #include <fstream>
 #include <algorithm>
 
-#pragma comment(lib, "ws2_32.lib")
-
-Driver::Driver(mpsc::Receiver<Pose> poseReceiver, SocketManager* socketManager)
-    : m_poseReceiver(std::move(poseReceiver))
+static metrics::Histogram& s_presentTime = metrics::Registry::Get().GetHistogram("present.duration_us");
+// Includes waiting on the GPU when an eye's readback ring is full
+static metrics::Histogram& s_acquireTime = metrics::Registry::Get().GetHistogram("present.readback_acquire_us");
+static metrics::Histogram& s_writeEyeTime = metrics::Registry::Get().GetHistogram("present.write_eye_us");
+static metrics::Counter& s_eyesConverted = metrics::Registry::Get().GetCounter("present.eyes_converted");
+static metrics::Histogram& s_compositeTime = metrics::Registry::Get().GetHistogram("present.composite_us");
+static metrics::Counter& s_layersComposited = metrics::Registry::Get().GetCounter("present.layers_composited");
+// Overlays that could not be blended: another size or pixel format than the base, or another frame
+static metrics::Counter& s_layersSkipped = metrics::Registry::Get().GetCounter("present.layers_skipped");
+// Layers past kMaxReadbackLayers in one frame
+static metrics::Counter& s_layersDropped = metrics::Registry::Get().GetCounter("present.layers_dropped");
+
+static control::Setting& s_poseRate = control::Registry::Get().AddFloat("pose.hmd_rate_hz", 90.0, 1.0, 1000.0, "HMD pose updates per second");
+
+Driver::Driver(mpsc::Receiver<PoseSample> poseReceiver, SocketManager* socketManager, std::unique_ptr<TextureDevice> textureDevice)
+    : m_pTextureDevice(std::move(textureDevice))
     , m_pSocketManager(socketManager)
+    , m_frameSender(socketManager, &m_frameTimer)
+    , m_poseReceiver(std::move(poseReceiver))
 {
-    InitD3D11();
+    m_pReadback = m_pTextureDevice->CreateReadback(kReadbackDepth);
 }
 
 Driver::~Driver()
 {
-    CleanupD3D11();
-}
-
-bool Driver::InitD3D11()
-{
-    D3D_FEATURE_LEVEL featureLevel;
-    UINT createDeviceFlags = 0;
-
-#ifdef _DEBUG
-    createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-    HRESULT hr = D3D11CreateDevice(
-        nullptr,
-        D3D_DRIVER_TYPE_HARDWARE,
-        nullptr,
-        createDeviceFlags,
-        nullptr,
-        0,
-        D3D11_SDK_VERSION,
-        &m_pD3DDevice,
-        &featureLevel,
-        &m_pD3DContext);
-
-    return SUCCEEDED(hr);
-}
-
-void Driver::CleanupD3D11()
-{
-    m_pStagingTexture.Reset();
+    for (const auto& set : m_swapTextureSets)
+    {
+        DestroySwapTextures(set.sharedHandles);
+    }
     m_swapTextureSets.clear();
-    m_pD3DContext.Reset();
-    m_pD3DDevice.Reset();
+    m_pTextureDevice->ReleaseReadback(m_pReadback.get());
+    m_pReadback.reset();
 }
 
 vr::EVRInitError Driver::Activate(uint32_t unObjectId)
@@ -83,6 +71,10 @@ vr::EVRInitError Driver::Activate(uint32_t unObjectId)
     // Start pose update thread
     m_poseThread = std::jthread([this](std::stop_token st) { PoseUpdateThreadFunc(st); });
 
+    // Start frame sender thread
+    m_frameSender.Start();
+    m_frameFanout.Subscribe(&m_frameSender);
+
     return vr::VRInitError_None;
 }
 
@@ -100,24 +92,35 @@ void Driver::PoseUpdateThreadFunc(std::stop_token st)
     pose.vecPosition[2] = 0.0;
     pose.qRotation.w = 1.0;
 
+    PoseMetrics poseMetrics(m_serialNumber);
+    trace::SetThreadName("Pose " + m_serialNumber);
+
     while (!st.stop_requested())
     {
-        // Check for new pose (non-blocking)
-        if (auto p = m_poseReceiver.try_recv())
+        // Newest pose since the last tick (non-blocking); older ones are already stale
+        poseMetrics.RecordQueueDepth(m_poseReceiver.size());
+        if (auto p = m_poseReceiver.try_recv_latest())
         {
-            pose.vecPosition[0] = p->posX;
-            pose.vecPosition[1] = p->posY;
-            pose.vecPosition[2] = p->posZ;
-            pose.qRotation.w = p->rotW;
-            pose.qRotation.x = p->rotX;
-            pose.qRotation.y = p->rotY;
-            pose.qRotation.z = p->rotZ;
+            poseMetrics.RecordPose();
+            pose.vecPosition[0] = p->pose.posX;
+            pose.vecPosition[1] = p->pose.posY;
+            pose.vecPosition[2] = p->pose.posZ;
+            pose.qRotation.w = p->pose.rotW;
+            pose.qRotation.x = p->pose.rotX;
+            pose.qRotation.y = p->pose.rotY;
+            pose.qRotation.z = p->pose.rotZ;
+            m_appliedPose.Store(AppliedPose{ p->sequence, p->receivedUs });
         }
 
+        poseMetrics.RecordAge();
+
         // Always send current pose
-        vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, pose, sizeof(vr::DriverPose_t));
+        {
+            OVD_TRACE_SCOPE("pose.publish");
+            vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, pose, sizeof(vr::DriverPose_t));
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(11)); // ~90Hz
+        std::this_thread::sleep_for(std::chrono::duration<double>(1.0 / s_poseRate.Get()));
     }
 }
 
@@ -128,6 +131,8 @@ void Driver::Deactivate()
         m_poseThread.request_stop();
         m_poseThread.join();
     }
+    m_frameFanout.Unsubscribe(&m_frameSender);
+    m_frameSender.Stop();
     m_unObjectId = vr::k_unTrackedDeviceIndexInvalid;
 }
 
@@ -150,12 +155,10 @@ void* Driver::GetComponent(const char* pchComponentNameAndVersion)
     return nullptr;
 }
 
+// Runtime control commands, see control::Registry::Execute
 void Driver::DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize)
 {
-    if (unResponseBufferSize > 0)
-    {
-        pchResponseBuffer[0] = '\0';
-    }
+    control::Registry::Get().Execute(pchRequest, pchResponseBuffer, unResponseBufferSize);
 }
 
 vr::DriverPose_t Driver::GetPose()
@@ -239,66 +242,45 @@ bool Driver::ComputeInverseDistortion(vr::HmdVector2_t* pResult, vr::EVREye eEye
 
 void Driver::CreateSwapTextureSet(uint32_t unPid, const SwapTextureSetDesc_t* pSwapTextureSetDesc, SwapTextureSet_t* pOutSwapTextureSet)
 {
-    if (!m_pD3DDevice || !pSwapTextureSetDesc || !pOutSwapTextureSet)
+    if (!pSwapTextureSetDesc || !pOutSwapTextureSet)
         return;
 
     SwapTextureSetData setData = {};
     setData.pid = unPid;
     setData.currentIndex = 0;
 
-    D3D11_TEXTURE2D_DESC desc = {};
-    desc.Width = pSwapTextureSetDesc->nWidth;
-    desc.Height = pSwapTextureSetDesc->nHeight;
-    desc.MipLevels = 1;
-    desc.ArraySize = 1;
-    desc.Format = static_cast<DXGI_FORMAT>(pSwapTextureSetDesc->nFormat);
-    desc.SampleDesc.Count = pSwapTextureSetDesc->nSampleCount > 0 ? pSwapTextureSetDesc->nSampleCount : 1;
-    desc.SampleDesc.Quality = 0;
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-    desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
-
-    for (int i = 0; i < 3; i++)
-    {
-        HRESULT hr = m_pD3DDevice->CreateTexture2D(&desc, nullptr, &setData.textures[i]);
-        if (FAILED(hr))
-            return;
+    SwapTextureDesc desc { pSwapTextureSetDesc->nWidth, pSwapTextureSetDesc->nHeight, pSwapTextureSetDesc->nFormat, pSwapTextureSetDesc->nSampleCount };
+    if (!m_pTextureDevice->CreateSwapTextures(desc, setData.sharedHandles))
+        return;
 
-        ComPtr<IDXGIResource> dxgiResource;
-        hr = setData.textures[i].As(&dxgiResource);
-        if (SUCCEEDED(hr))
-        {
-            dxgiResource->GetSharedHandle(&setData.sharedHandles[i]);
-            pOutSwapTextureSet->rSharedTextureHandles[i] = reinterpret_cast<vr::SharedTextureHandle_t>(setData.sharedHandles[i]);
-        }
+    for (uint32_t i = 0; i < TextureDevice::kSwapTextureCount; i++)
+    {
+        pOutSwapTextureSet->rSharedTextureHandles[i] = setData.sharedHandles[i];
     }
 
-    m_swapTextureSets.push_back(std::move(setData));
+    m_swapTextureSets.push_back(setData);
+}
+
+void Driver::DestroySwapTextures(const uint64_t (&sharedHandles)[TextureDevice::kSwapTextureCount])
+{
+    // The readback keeps submitted textures open; a handle can be reused once it is destroyed
+    if (m_pReadback)
+    {
+        for (uint64_t handle : sharedHandles)
+            m_pReadback->ForgetTexture(handle);
+    }
+    m_pTextureDevice->DestroySwapTextures(sharedHandles);
 }
 
 void Driver::DestroySwapTextureSet(vr::SharedTextureHandle_t sharedTextureHandle)
 {
-    auto it = m_swapTextureSets.begin();
-    while (it != m_swapTextureSets.end())
+    auto it = std::find_if(m_swapTextureSets.begin(), m_swapTextureSets.end(), [&](const SwapTextureSetData& set) {
+        return std::find(std::begin(set.sharedHandles), std::end(set.sharedHandles), sharedTextureHandle) != std::end(set.sharedHandles);
+    });
+    if (it != m_swapTextureSets.end())
     {
-        bool found = false;
-        for (int i = 0; i < 3; i++)
-        {
-            if (reinterpret_cast<vr::SharedTextureHandle_t>(it->sharedHandles[i]) == sharedTextureHandle)
-            {
-                found = true;
-                break;
-            }
-        }
-        if (found)
-        {
-            it = m_swapTextureSets.erase(it);
-            return;
-        }
-        else
-        {
-            ++it;
-        }
+        DestroySwapTextures(it->sharedHandles);
+        m_swapTextureSets.erase(it);
     }
 }
 
@@ -309,6 +291,7 @@ void Driver::DestroyAllSwapTextureSets(uint32_t unPid)
     {
         if (it->pid == unPid)
         {
+            DestroySwapTextures(it->sharedHandles);
             it = m_swapTextureSets.erase(it);
         }
         else
@@ -324,9 +307,9 @@ void Driver::GetNextSwapTextureSetIndex(vr::SharedTextureHandle_t sharedTextureH
     {
         for (int eye = 0; eye < 2; eye++)
         {
-            for (int i = 0; i < 3; i++)
+            for (uint32_t i = 0; i < TextureDevice::kSwapTextureCount; i++)
             {
-                if (reinterpret_cast<vr::SharedTextureHandle_t>(set.sharedHandles[i]) == sharedTextureHandles[eye])
+                if (set.sharedHandles[i] == sharedTextureHandles[eye])
                 {
                     set.currentIndex = (set.currentIndex + 1) % 3;
                     (*pIndices)[eye] = set.currentIndex;
@@ -337,114 +320,336 @@ void Driver::GetNextSwapTextureSetIndex(vr::SharedTextureHandle_t sharedTextureH
     }
 }
 
-static vr::SharedTextureHandle_t s_lastSubmittedTextures[2] = { 0, 0 };
-static vr::VRTextureBounds_t s_lastSubmittedBounds[2] = {};
+// scale shrinks whatever size the spec asks for, for the adaptive quality controller
+static EyeLayout ComputeEyeLayout(const PixelRect& crop, SourceFormat sourceFormat, const OutputSpec& spec, float scale)
+{
+    EyeLayout layout { crop, crop.width, crop.height, spec.filter, sourceFormat, spec.format, false };
 
-void Driver::SubmitLayer(const SubmitLayerPerEye_t (&perEye)[2])
+    // Region of interest, normalized to the submitted eye crop
+    if (spec.roiMaxU > spec.roiMinU && spec.roiMaxV > spec.roiMinV)
+    {
+        float minU = std::clamp(spec.roiMinU, 0.0f, 1.0f);
+        float minV = std::clamp(spec.roiMinV, 0.0f, 1.0f);
+        float maxU = std::clamp(spec.roiMaxU, minU, 1.0f);
+        float maxV = std::clamp(spec.roiMaxV, minV, 1.0f);
+
+        uint32_t x0 = std::min(static_cast<uint32_t>(minU * crop.width), crop.width - 1);
+        uint32_t y0 = std::min(static_cast<uint32_t>(minV * crop.height), crop.height - 1);
+        uint32_t x1 = std::clamp(static_cast<uint32_t>(maxU * crop.width), x0 + 1, crop.width);
+        uint32_t y1 = std::clamp(static_cast<uint32_t>(maxV * crop.height), y0 + 1, crop.height);
+        layout.source = { crop.x + x0, crop.y + y0, x1 - x0, y1 - y0 };
+    }
+
+    // A zero dimension follows the region's aspect ratio
+    uint32_t width = spec.width;
+    uint32_t height = spec.height;
+    if (width == 0 && height == 0)
+    {
+        width = layout.source.width;
+        height = layout.source.height;
+    }
+    else if (width == 0)
+    {
+        width = std::max(1u, static_cast<uint32_t>(static_cast<uint64_t>(height) * layout.source.width / layout.source.height));
+    }
+    else if (height == 0)
+    {
+        height = std::max(1u, static_cast<uint32_t>(static_cast<uint64_t>(width) * layout.source.height / layout.source.width));
+    }
+
+    // Kept even so the chroma planes of I420/NV12 stay whole
+    if (scale < 1.0f)
+    {
+        width = std::max(2u, static_cast<uint32_t>(width * scale) & ~1u);
+        height = std::max(2u, static_cast<uint32_t>(height * scale) & ~1u);
+    }
+
+    layout.width = width;
+    layout.height = height;
+    layout.resample = width != layout.source.width || height != layout.source.height;
+    return layout;
+}
+
+FrameMetadata Driver::GetFrameMetadata(uint64_t frameIndex) const
 {
-    s_lastSubmittedTextures[0] = perEye[0].hTexture;
-    s_lastSubmittedTextures[1] = perEye[1].hTexture;
-    s_lastSubmittedBounds[0] = perEye[0].bounds;
-    s_lastSubmittedBounds[1] = perEye[1].bounds;
+    const FrameMetadata& metadata = m_frameMetadata[frameIndex % kFrameMetadataHistory];
+    if (metadata.frameIndex == frameIndex)
+        return metadata;
+
+    // Readback lagged past the history; better no pose than the wrong one
+    FrameMetadata unknown{};
+    unknown.frameIndex = frameIndex;
+    return unknown;
 }
 
-void Driver::Present(vr::SharedTextureHandle_t syncTexture)
+void Driver::SubmitLayer(const SubmitLayerPerEye_t (&perEye)[2])
 {
-    m_frameCount++;
+    m_frameTimer.MarkSubmitLayer();
+    OVD_TRACE_INSTANT("SubmitLayer", "frame", m_frameCount);
+
+    // The first layer after a Present starts the next frame
+    if (m_layersPresented)
+    {
+        m_layerCount = 0;
+        m_layersPresented = false;
+    }
+    if (m_layerCount == kMaxReadbackLayers)
+    {
+        s_layersDropped.Add();
+        return;
+    }
 
-    if (!m_pD3DDevice || !m_pSocketManager)
+    SubmittedLayer& layer = m_layers[m_layerCount++];
+    for (uint32_t eye = 0; eye < 2; eye++)
+    {
+        layer.textures[eye] = perEye[eye].hTexture;
+        layer.bounds[eye] = perEye[eye].bounds;
+    }
+    if (m_layerCount > 1)
         return;
 
-    for (int eye = 0; eye < 2; eye++)
+    // Metadata comes from the first layer, the scene; both eyes are rendered from its head pose
+    FrameMetadata& metadata = m_submittedMetadata;
+    std::memcpy(metadata.hmdPose, perEye[0].mHmdPose.m, sizeof(metadata.hmdPose));
+    AppliedPose appliedPose = m_appliedPose.Load();
+    metadata.poseSequence = appliedPose.sequence;
+    metadata.poseReceivedUs = appliedPose.receivedUs;
+    metadata.submitUs = GetDriverTimeUs();
+}
+
+// Hashing is only worth it when the same texture comes back; a new handle is taken as new content
+bool Driver::IsUnchangedReadback(uint32_t eye, const ReadbackResult& readback)
+{
+    LastReadback& last = m_lastReadback[eye];
+    uint64_t settingsVersion = m_pSocketManager->GetSettingsVersion();
+    if (readback.texture != last.texture || readback.width != last.width || readback.height != last.height || settingsVersion != last.settingsVersion)
     {
-        if (s_lastSubmittedTextures[eye] == 0)
+        last = LastReadback{ readback.texture, readback.width, readback.height, settingsVersion, 0, false };
+        return false;
+    }
+
+    uint64_t hash = HashImage(readback.data, readback.rowPitch, readback.width, readback.height);
+    bool unchanged = last.hashed && hash == last.contentHash;
+    last.contentHash = hash;
+    last.hashed = true;
+    return unchanged;
+}
+
+static bool IsBlendable(SourceFormat format)
+{
+    return format == SourceFormat::Bgra8 || format == SourceFormat::Rgba8;
+}
+
+// Overlay rings are acquired every Present like the base ones, so their copies stay in step.
+// Returns base unchanged while composite is left empty, i.e. when nothing was blended.
+ReadbackResult Driver::CompositeLayers(uint32_t eye, const ReadbackResult& base, FrameBufferRef& composite)
+{
+    ReadbackResult result = base;
+    for (uint32_t layer = 1; layer < kMaxReadbackLayers; layer++)
+    {
+        std::optional<ReadbackResult> overlay = m_pReadback->Acquire(eye, layer);
+        if (!overlay)
             continue;
 
-        ComPtr<ID3D11Texture2D> pTexture;
-        HRESULT hr = m_pD3DDevice->OpenSharedResource(
-            reinterpret_cast<HANDLE>(s_lastSubmittedTextures[eye]),
-            __uuidof(ID3D11Texture2D),
-            reinterpret_cast<void**>(pTexture.GetAddressOf()));
+        if (overlay->frameIndex != base.frameIndex || overlay->format != base.format || !IsBlendable(base.format) ||
+            overlay->width != base.width || overlay->height != base.height)
+        {
+            m_pReadback->Release(eye, layer);
+            s_layersSkipped.Add();
+            continue;
+        }
+
+        // The first overlay reads the base straight from its mapping, later ones stack in place
+        const uint8_t* below = result.data;
+        uint32_t belowPitch = result.rowPitch;
+        if (!composite)
+        {
+            composite = FrameBufferPool::Shared().Acquire(static_cast<size_t>(base.width) * base.height * 4);
+            result.data = composite.GetData();
+            result.rowPitch = base.width * 4;
+        }
+
+        uint8_t* out = composite.GetMutableData();
+        {
+            OVD_TRACE_SCOPE_ARG("eye.composite", "layer", layer);
+            metrics::ScopedTimer compositeTimer(s_compositeTime);
+            WorkerPool::Shared().RunStripes(base.height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+                BlendImageOver(overlay->data, overlay->rowPitch, below, belowPitch, out, result.rowPitch, base.width, rowBegin, rowEnd);
+            });
+        }
+        m_pReadback->Release(eye, layer);
+        s_layersComposited.Add();
+    }
+    return result;
+}
 
-        if (FAILED(hr) || !pTexture)
+// For Presents where the eye's base layer had no finished copy
+void Driver::DropLayers(uint32_t eye)
+{
+    for (uint32_t layer = 1; layer < kMaxReadbackLayers; layer++)
+    {
+        if (m_pReadback->Acquire(eye, layer))
+        {
+            m_pReadback->Release(eye, layer);
+            s_layersSkipped.Add();
+        }
+    }
+}
+
+void Driver::Present(vr::SharedTextureHandle_t syncTexture)
+{
+    metrics::ScopedTimer presentTimer(s_presentTime);
+    uint64_t frameIndex = m_frameCount++;
+    trace::SetThreadName("Compositor");
+    OVD_TRACE_SCOPE_ARG("Present", "frame", frameIndex);
+
+    FrameMetadata& metadata = m_frameMetadata[frameIndex % kFrameMetadataHistory];
+    metadata = m_submittedMetadata;
+    metadata.frameIndex = frameIndex;
+    metadata.presentUs = GetDriverTimeUs();
+    m_frameTimer.MarkPresent(frameIndex);
+
+    m_layersPresented = true;
+    if (!m_pReadback || !m_pSocketManager)
+        return;
+
+    // Only eyes some subscriber wants from this frame are copied off the GPU at all
+    uint32_t wantedEyes = m_frameFanout.GetWantedEyes(frameIndex);
+
+    // Queue this frame's copies; what gets converted below is the newest copy the GPU has finished
+    for (uint32_t eye = 0; eye < 2; eye++)
+    {
+        if (!((wantedEyes >> eye) & 1))
             continue;
 
-        D3D11_TEXTURE2D_DESC desc;
-        pTexture->GetDesc(&desc);
+        for (uint32_t layer = 0; layer < m_layerCount; layer++)
+        {
+            vr::SharedTextureHandle_t texture = m_layers[layer].textures[eye];
+            const auto& bounds = m_layers[layer].bounds[eye];
+            if (texture != 0)
+                m_pReadback->Submit(ReadbackRequest{ texture, bounds.uMin, bounds.vMin, bounds.uMax, bounds.vMax, eye, frameIndex, layer });
+        }
+    }
+
+    OutputSpec outputSpec = m_pSocketManager->GetOutputSpec();
+    float qualityScale = m_frameSender.GetQualityScale();
+
+    // Kept so subscribers that want matched pairs get both eyes of one frame together
+    FramePacket eyePackets[2];
+    uint32_t eyeMask = 0;
+    // Set once an eye reached the socket client through the shared ring instead of the sender
+    bool sharedRingUsed = false;
 
-        if (!m_pStagingTexture || m_stagingWidth != desc.Width || m_stagingHeight != desc.Height || m_stagingFormat != desc.Format)
+    for (uint32_t eye = 0; eye < 2; eye++)
+    {
+        std::optional<ReadbackResult> readback;
+        {
+            OVD_TRACE_SCOPE_ARG("readback.acquire", "eye", eye);
+            metrics::ScopedTimer acquireTimer(s_acquireTime);
+            readback = m_pReadback->Acquire(eye);
+        }
+        if (!readback)
         {
-            m_pStagingTexture.Reset();
-
-            D3D11_TEXTURE2D_DESC stagingDesc = {};
-            stagingDesc.Width = desc.Width;
-            stagingDesc.Height = desc.Height;
-            stagingDesc.MipLevels = 1;
-            stagingDesc.ArraySize = 1;
-            if (desc.Format == DXGI_FORMAT_R10G10B10A2_TYPELESS)
-                stagingDesc.Format = DXGI_FORMAT_R10G10B10A2_UNORM;
-            else if (desc.Format == DXGI_FORMAT_R8G8B8A8_TYPELESS)
-                stagingDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            else
-                stagingDesc.Format = desc.Format;
-            stagingDesc.SampleDesc.Count = 1;
-            stagingDesc.Usage = D3D11_USAGE_STAGING;
-            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-
-            if (FAILED(m_pD3DDevice->CreateTexture2D(&stagingDesc, nullptr, &m_pStagingTexture)))
-                continue;
-
-            m_stagingWidth = desc.Width;
-            m_stagingHeight = desc.Height;
-            m_stagingFormat = desc.Format;
+            DropLayers(eye);
+            continue;
         }
 
-        m_pD3DContext->CopyResource(m_pStagingTexture.Get(), pTexture.Get());
+        // Overlays blended into a pooled copy; without any, readback is the base layer's mapping
+        FrameBufferRef composite;
+        {
+            ReadbackResult composited = CompositeLayers(eye, *readback, composite);
+            if (composite)
+            {
+                // Done with the mapping early; the Release calls below are then no-ops
+                m_pReadback->Release(eye);
+                readback = composited;
+            }
+        }
 
-        D3D11_MAPPED_SUBRESOURCE mapped;
-        if (FAILED(m_pD3DContext->Map(m_pStagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped)))
+        if (IsUnchangedReadback(eye, *readback))
+        {
+            m_pReadback->Release(eye);
+            m_unchangedFrames.Add();
             continue;
+        }
 
-        const auto& bounds = s_lastSubmittedBounds[eye];
-        uint32_t cropX = static_cast<uint32_t>(bounds.uMin * m_stagingWidth);
-        uint32_t cropY = static_cast<uint32_t>(bounds.vMin * m_stagingHeight);
-        uint32_t cropW = static_cast<uint32_t>((bounds.uMax - bounds.uMin) * m_stagingWidth);
-        uint32_t cropH = static_cast<uint32_t>((bounds.vMax - bounds.vMin) * m_stagingHeight);
+        EyeLayout layout = ComputeEyeLayout(PixelRect{ 0, 0, readback->width, readback->height }, readback->format, outputSpec, qualityScale);
 
-        if (cropW == 0) cropW = m_stagingWidth;
-        if (cropH == 0) cropH = m_stagingHeight;
-        if (cropX + cropW > m_stagingWidth) cropW = m_stagingWidth - cropX;
-        if (cropY + cropH > m_stagingHeight) cropH = m_stagingHeight - cropY;
+        // Same-host clients get the crop written straight into the shared ring
+        FrameRing* ring = (m_frameSender.GetWantedEyes(readback->frameIndex) >> eye) & 1 ? m_pSocketManager->GetSharedFrameRing() : nullptr;
+        size_t frameSize = GetPixelFormatSize(layout.format, layout.width, layout.height);
+        if (uint8_t* slot = ring ? ring->BeginWrite(layout.width, layout.height, eye, static_cast<uint32_t>(layout.format), frameSize) : nullptr)
+        {
+            {
+                OVD_TRACE_SCOPE_ARG("eye.crop", "frame", readback->frameIndex);
+                metrics::ScopedTimer writeTimer(s_writeEyeTime);
+                WriteEye(WorkerPool::Shared(), readback->data, readback->rowPitch, layout, slot);
+            }
+            s_eyesConverted.Add();
+            m_pReadback->Release(eye);
+            m_frameTimer.MarkReadbackDone(readback->frameIndex);
+
+            // The ring replaces the socket sender only; other subscribers get a pooled copy
+            FramePacket packet{};
+            bool othersWant = (m_frameFanout.GetWantedEyes(readback->frameIndex, &m_frameSender) >> eye) & 1;
+            if (othersWant)
+            {
+                packet = FramePacket{ FrameBufferPool::Shared().Acquire(frameSize), layout.width, layout.height, eye, layout.format, readback->frameIndex, GetFrameMetadata(readback->frameIndex) };
+                std::memcpy(packet.pixels.GetMutableData(), slot, frameSize);
+            }
+            ring->EndWrite();
+            m_frameTimer.MarkSent(readback->frameIndex);
+            sharedRingUsed = true;
 
-        uint8_t* srcData = static_cast<uint8_t*>(mapped.pData);
-        std::vector<uint8_t> buffer(cropW * cropH * 4);
+            if (othersWant)
+            {
+                OVD_TRACE_INSTANT("frame.publish", "frame", readback->frameIndex);
+                m_frameFanout.Publish(packet, &m_frameSender);
+                eyePackets[eye] = std::move(packet);
+                eyeMask |= 1u << eye;
+            }
+            continue;
+        }
 
-        for (uint32_t y = 0; y < cropH; y++)
+        // Recycled buffer, shared read-only by every subscriber once published
+        FramePacket packet { FrameBufferPool::Shared().Acquire(frameSize), layout.width, layout.height, eye, layout.format, readback->frameIndex, GetFrameMetadata(readback->frameIndex) };
         {
-            const uint8_t* srcRow = srcData + (cropY + y) * mapped.RowPitch + cropX * 4;
-            uint8_t* dstRow = buffer.data() + y * cropW * 4;
-            std::copy(srcRow, srcRow + cropW * 4, dstRow);
+            OVD_TRACE_SCOPE_ARG("eye.crop", "frame", readback->frameIndex);
+            metrics::ScopedTimer writeTimer(s_writeEyeTime);
+            WriteEye(WorkerPool::Shared(), readback->data, readback->rowPitch, layout, packet.pixels.GetMutableData());
         }
+        s_eyesConverted.Add();
 
-        m_pD3DContext->Unmap(m_pStagingTexture.Get(), 0);
+        m_pReadback->Release(eye);
+        m_frameTimer.MarkReadbackDone(readback->frameIndex);
 
-        Frame frame { buffer.data(), cropW, cropH, static_cast<uint32_t>(eye) };
-        m_pSocketManager->SendFrame(frame);
+        // Subscribers only queue the packet; Present never waits on a client
+        OVD_TRACE_INSTANT("frame.publish", "frame", readback->frameIndex);
+        m_frameFanout.Publish(packet);
+        eyePackets[eye] = std::move(packet);
+        eyeMask |= 1u << eye;
     }
+
+    if (eyeMask == 3 && eyePackets[0].frameIndex == eyePackets[1].frameIndex)
+        m_frameFanout.PublishStereo(eyePackets[0], eyePackets[1], sharedRingUsed ? &m_frameSender : nullptr);
 }
 
 void Driver::PostPresent(const Throttling_t* pThrottling)
 {
+    // There is no real scanout, so the compositor is held to the advertised refresh rate here
+    OVD_TRACE_SCOPE("vsync.wait");
+    m_frameTimer.WaitForVsync(pThrottling ? pThrottling->nFramesToThrottle : 0);
 }
 
 void Driver::GetFrameTiming(vr::DriverDirectMode_FrameTiming* pFrameTiming)
 {
     if (pFrameTiming)
     {
+        PresentTiming timing = m_frameTimer.GetPresentTiming();
         pFrameTiming->m_nSize = sizeof(vr::DriverDirectMode_FrameTiming);
-        pFrameTiming->m_nNumFramePresents = 1;
-        pFrameTiming->m_nNumMisPresented = 0;
-        pFrameTiming->m_nNumDroppedFrames = 0;
+        pFrameTiming->m_nNumFramePresents = timing.numFramePresents;
+        pFrameTiming->m_nNumMisPresented = timing.numMisPresented;
+        pFrameTiming->m_nNumDroppedFrames = timing.numDroppedFrames;
         pFrameTiming->m_nReprojectionFlags = 0;
     }
 }
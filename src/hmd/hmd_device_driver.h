@@ -1,24 +1,32 @@
 #pragma once
 
 #include <openvr_driver.h>
-#include <d3d11.h>
-#include <wrl/client.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <vector>
+#include <memory>
 #include <thread>
 #include <atomic>
 #include "../socket/socket_manager.h"
+#include "../frame/frame_sender.h"
+#include "../frame/frame_fanout.h"
+#include "../frame/eye_writer.h"
+#include "../readback/texture_device.h"
+#include "../timing/frame_timer.h"
+#include "../image/tile_hash.h"
+#include "../image/convert.h"
+#include "../image/blend.h"
 #include "../mpsc/channel.h"
-
-using Microsoft::WRL::ComPtr;
+#include "../thread/seqlock.h"
+#include "../metrics/metrics.h"
+#include "../metrics/pose_metrics.h"
+#include "../trace/trace.h"
+#include "../control/control.h"
 
 class Driver : public vr::ITrackedDeviceServerDriver,
                public vr::IVRDisplayComponent,
                public vr::IVRDriverDirectModeComponent
 {
 public:
-    Driver(mpsc::Receiver<Pose> poseReceiver, SocketManager* socketManager);
+    Driver(mpsc::Receiver<PoseSample> poseReceiver, SocketManager* socketManager, std::unique_ptr<TextureDevice> textureDevice);
     ~Driver();
 
     // ITrackedDeviceServerDriver interface
@@ -52,11 +60,20 @@ public:
     // Public methods
     const char* GetSerialNumber() const { return m_serialNumber.c_str(); }
     void ProcessEvent(const vr::VREvent_t& event);
+    FrameSenderStats GetFrameStats() const { return m_frameSender.GetStats(); }
+    // Presents skipped before conversion because the eye image had not changed
+    uint64_t GetUnchangedFrameCount() const { return m_unchangedFrames.Get(); }
+    FrameFanout& GetFrameFanout() { return m_frameFanout; }
+    FrameTimingReport GetFrameTimingReport() const { return m_frameTimer.GetReport(m_frameCount.load() - 1); }
+    void StopFrameSender() { m_frameSender.Stop(); }
 
 private:
-    bool InitD3D11();
-    void CleanupD3D11();
     void PoseUpdateThreadFunc(std::stop_token st);
+    bool IsUnchangedReadback(uint32_t eye, const ReadbackResult& readback);
+    ReadbackResult CompositeLayers(uint32_t eye, const ReadbackResult& base, FrameBufferRef& composite);
+    void DropLayers(uint32_t eye);
+    void DestroySwapTextures(const uint64_t (&sharedHandles)[TextureDevice::kSwapTextureCount]);
+    FrameMetadata GetFrameMetadata(uint64_t frameIndex) const;
 
     uint32_t m_unObjectId = vr::k_unTrackedDeviceIndexInvalid;
     std::string m_serialNumber = "OVD-HMD-001";
@@ -67,33 +84,74 @@ private:
     float m_displayFrequency = 90.0f;
     float m_ipd = 0.063f; // 63mm
 
-    // D3D11 resources
-    ComPtr<ID3D11Device> m_pD3DDevice;
-    ComPtr<ID3D11DeviceContext> m_pD3DContext;
-
-    // Staging texture for CPU readback
-    ComPtr<ID3D11Texture2D> m_pStagingTexture;
-    uint32_t m_stagingWidth = 0;
-    uint32_t m_stagingHeight = 0;
-    DXGI_FORMAT m_stagingFormat = DXGI_FORMAT_UNKNOWN;
+    // Swap textures and their readback; D3D11 in SteamVR, synthetic when headless
+    std::unique_ptr<TextureDevice> m_pTextureDevice;
+
+    // Pipelined GPU -> CPU copies of the submitted eye regions. A frame is converted up to
+    // kReadbackDepth - 1 Presents after its copy was queued instead of stalling Present on it.
+    static constexpr uint32_t kReadbackDepth = 2;
+    std::unique_ptr<ReadbackBackend> m_pReadback;
+
+    // What each eye's last readback was, to drop frames where the compositor presented the
+    // same texture with identical pixels and the client's settings haven't changed since
+    struct LastReadback {
+        uint64_t texture = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t settingsVersion = 0;
+        uint64_t contentHash = 0;
+        bool hashed = false;
+    };
+    LastReadback m_lastReadback[2];
+    metrics::Counter& m_unchangedFrames = metrics::Registry::Get().GetCounter("present.unchanged");
 
     // Texture management
     struct SwapTextureSetData
     {
         uint32_t pid;
-        ComPtr<ID3D11Texture2D> textures[3];
-        HANDLE sharedHandles[3];
+        uint64_t sharedHandles[TextureDevice::kSwapTextureCount];
         uint32_t currentIndex;
     };
     std::vector<SwapTextureSetData> m_swapTextureSets;
 
+    // Stage timestamps and virtual vsync pacing, declared before the sender that reports from it
+    FrameTimer m_frameTimer{ m_displayFrequency };
+
     // Networking
     SocketManager* m_pSocketManager;
+    FrameSender m_frameSender;
+    // Present publishes here; the sender is one subscriber, recorders etc. can add themselves
+    FrameFanout m_frameFanout;
 
     // Head pose channel
-    mpsc::Receiver<Pose> m_poseReceiver;
+    mpsc::Receiver<PoseSample> m_poseReceiver;
     std::jthread m_poseThread;
 
+    // Newest client pose handed to SteamVR. Written by the pose thread, read at SubmitLayer.
+    struct AppliedPose
+    {
+        uint64_t sequence;
+        uint64_t receivedUs;
+    };
+    SeqLock<AppliedPose> m_appliedPose;
+
+    // Compositor thread only: the layers submitted for the frame, first one at the bottom. Kept
+    // until the next frame's first SubmitLayer, so a Present without new layers repeats them.
+    struct SubmittedLayer
+    {
+        vr::SharedTextureHandle_t textures[2];
+        vr::VRTextureBounds_t bounds[2];
+    };
+    SubmittedLayer m_layers[kMaxReadbackLayers]{};
+    uint32_t m_layerCount = 0;
+    bool m_layersPresented = false;
+
+    // Compositor thread only: what SubmitLayer saw, and the last few Presents by frame index
+    // so frames still in the readback pipeline find theirs
+    static constexpr uint32_t kFrameMetadataHistory = 16;
+    FrameMetadata m_submittedMetadata{};
+    FrameMetadata m_frameMetadata[kFrameMetadataHistory]{};
+
     // Frame counter
     std::atomic<uint64_t> m_frameCount{0};
 };
@@ -3,11 +3,18 @@
 */
 
 #include <openvr_driver.h>
+#include <cstring>
 #include "provider/device_provider.h"
 
+#ifdef _WIN32
+#define OVD_DRIVER_EXPORT extern "C" __declspec(dllexport)
+#else
+#define OVD_DRIVER_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
 AIVRDeviceProvider g_deviceProvider;
 
-extern "C" __declspec(dllexport) void* HmdDriverFactory(const char* pInterfaceName, int* pReturnCode)
+OVD_DRIVER_EXPORT void* HmdDriverFactory(const char* pInterfaceName, int* pReturnCode)
 {
     if (0 == strcmp(vr::IServerTrackedDeviceProvider_Version, pInterfaceName))
     {
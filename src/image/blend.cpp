@@ -0,0 +1,209 @@
+#include "blend.h"
+#include "simd.h"
+#include <cstring>
+
+// (t + 128 + ((t + 128) >> 8)) >> 8 is t / 255 rounded for every t up to 255 * 255, and only
+// needs 16-bit lanes, so all kernels produce the same bytes
+static inline uint8_t BlendChannel(uint32_t s, uint32_t d, uint32_t a)
+{
+    uint32_t t = s * a + d * (255 - a) + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+static void BlendRowOverScalar(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t* s = src + i * 4;
+        const uint8_t* d = dst + i * 4;
+        uint8_t* o = out + i * 4;
+        uint32_t a = s[3];
+        if (a == 0)
+        {
+            if (o != d)
+                std::memcpy(o, d, 4);
+        }
+        else if (a == 255)
+        {
+            std::memcpy(o, s, 4);
+        }
+        else
+        {
+            o[0] = BlendChannel(s[0], d[0], a);
+            o[1] = BlendChannel(s[1], d[1], a);
+            o[2] = BlendChannel(s[2], d[2], a);
+            o[3] = BlendChannel(s[3], d[3], a);
+        }
+    }
+}
+
+#if defined(OVD_SIMD_X86)
+
+// Two pixels widened to 16-bit lanes, each pixel's alpha copied to all four of its lanes
+static inline __m128i BlendOver2Sse2(__m128i s, __m128i d)
+{
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i round = _mm_set1_epi16(128);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(c255, a))), round);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static void BlendRowOverSse2(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        __m128i alpha = _mm_and_si128(s, alphaMask);
+        __m128i result;
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF)
+        {
+            if (out == dst)
+                continue;
+            result = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+        }
+        else if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF)
+        {
+            result = s;
+        }
+        else
+        {
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+            result = _mm_packus_epi16(BlendOver2Sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero)),
+                                      BlendOver2Sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), result);
+    }
+    BlendRowOverScalar(src + i * 4, dst + i * 4, out + i * 4, count - i);
+}
+
+OVD_TARGET("avx2")
+static inline __m256i BlendOver4Avx2(__m256i s, __m256i d)
+{
+    const __m256i c255 = _mm256_set1_epi16(255);
+    const __m256i round = _mm256_set1_epi16(128);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m256i t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(c255, a))), round);
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+OVD_TARGET("avx2")
+static void BlendRowOverAvx2(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        __m256i alpha = _mm256_and_si256(s, alphaMask);
+        __m256i result;
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, zero)) == -1)
+        {
+            if (out == dst)
+                continue;
+            result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i * 4));
+        }
+        else if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alphaMask)) == -1)
+        {
+            result = s;
+        }
+        else
+        {
+            // Unpack and pack both work within 128-bit lanes, so pixel order comes back unchanged
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i * 4));
+            result = _mm256_packus_epi16(BlendOver4Avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero)),
+                                         BlendOver4Avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), result);
+    }
+    BlendRowOverScalar(src + i * 4, dst + i * 4, out + i * 4, count - i);
+}
+
+#endif // OVD_SIMD_X86
+
+#if defined(OVD_SIMD_NEON)
+
+static void BlendRowOverNeon(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t s = vld4_u8(src + i * 4);
+        uint64_t alpha = vget_lane_u64(vreinterpret_u64_u8(s.val[3]), 0);
+        if (alpha == 0)
+        {
+            if (out != dst)
+                std::memcpy(out + i * 4, dst + i * 4, 32);
+            continue;
+        }
+        if (alpha == ~0ull)
+        {
+            vst4_u8(out + i * 4, s);
+            continue;
+        }
+
+        uint8x8x4_t d = vld4_u8(dst + i * 4);
+        uint8x8_t a = s.val[3];
+        uint8x8_t inverse = vmvn_u8(a);
+        uint8x8x4_t result;
+        for (int c = 0; c < 4; c++)
+        {
+            // vraddhn adds the rounding 128 itself
+            uint16x8_t t = vmlal_u8(vmull_u8(s.val[c], a), d.val[c], inverse);
+            result.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        }
+        vst4_u8(out + i * 4, result);
+    }
+    BlendRowOverScalar(src + i * 4, dst + i * 4, out + i * 4, count - i);
+}
+
+#endif // OVD_SIMD_NEON
+
+struct BlendKernel {
+    void (*blendRowOver)(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count);
+    const char* name;
+};
+
+static BlendKernel SelectBlendKernel()
+{
+#if defined(OVD_SIMD_X86)
+    if (CpuHasAvx2())
+        return BlendKernel{ BlendRowOverAvx2, "avx2" };
+    return BlendKernel{ BlendRowOverSse2, "sse2" };
+#elif defined(OVD_SIMD_NEON)
+    return BlendKernel{ BlendRowOverNeon, "neon" };
+#else
+    return BlendKernel{ BlendRowOverScalar, "scalar" };
+#endif
+}
+
+static const BlendKernel& GetBlendKernel()
+{
+    static const BlendKernel kernel = SelectBlendKernel();
+    return kernel;
+}
+
+void BlendRowOver(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count)
+{
+    GetBlendKernel().blendRowOver(src, dst, out, count);
+}
+
+void BlendImageOver(const uint8_t* src, uint32_t srcPitch, const uint8_t* dst, uint32_t dstPitch,
+                    uint8_t* out, uint32_t outPitch, uint32_t width, uint32_t rowBegin, uint32_t rowEnd)
+{
+    auto blendRowOver = GetBlendKernel().blendRowOver;
+    for (uint32_t y = rowBegin; y < rowEnd; y++)
+    {
+        blendRowOver(src + static_cast<size_t>(y) * srcPitch, dst + static_cast<size_t>(y) * dstPitch,
+                     out + static_cast<size_t>(y) * outPitch, width);
+    }
+}
+
+const char* GetBlendKernelName()
+{
+    return GetBlendKernel().name;
+}
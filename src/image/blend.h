@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// "Over" compositing of 4-byte pixels with straight alpha in byte 3, so the same kernels serve
+// BGRA and RGBA as long as both images share a channel order. Every channel, alpha included,
+// becomes (src * a + dst * (255 - a)) / 255 rounded to nearest, which keeps an opaque dst opaque.
+// Runs of fully transparent or fully opaque src pixels are copied instead of blended.
+
+// out may be dst, so several layers can be stacked onto one image in place
+void BlendRowOver(const uint8_t* src, const uint8_t* dst, uint8_t* out, uint32_t count);
+
+// Rows [rowBegin, rowEnd) of width x height images, so disjoint ranges can run on different threads
+void BlendImageOver(const uint8_t* src, uint32_t srcPitch, const uint8_t* dst, uint32_t dstPitch,
+                    uint8_t* out, uint32_t outPitch, uint32_t width, uint32_t rowBegin, uint32_t rowEnd);
+
+// Instruction set the kernel picked for this CPU, for benchmarks
+const char* GetBlendKernelName();
@@ -0,0 +1,531 @@
+#include "convert.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Fixed point weights, scaled by 128, in BGRA order
+// Full range luma: 0.114 B + 0.587 G + 0.299 R
+static constexpr int kGrayB = 15, kGrayG = 75, kGrayR = 38;
+// BT.601 limited range
+static constexpr int kYB = 13, kYG = 64, kYR = 33;
+static constexpr int kUB = 56, kUG = -37, kUR = -19;
+static constexpr int kVB = -9, kVG = -47, kVR = 56;
+
+// Scalar kernels, also used for the tails of the vector ones
+
+static inline uint8_t ClampByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void SwapRedBlueScalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t* p = src + i * 4;
+        uint8_t* q = dst + i * 4;
+        uint8_t b = p[0];
+        q[1] = p[1];
+        q[0] = p[2];
+        q[2] = b;
+        q[3] = p[3];
+    }
+}
+
+static void ToRgbScalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dst[i * 3 + 0] = src[i * 4 + 2];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 0];
+    }
+}
+
+static void ToGrayScalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t* p = src + i * 4;
+        dst[i] = static_cast<uint8_t>((p[0] * kGrayB + p[1] * kGrayG + p[2] * kGrayR + 64) >> 7);
+    }
+}
+
+static void ToYScalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t* p = src + i * 4;
+        dst[i] = static_cast<uint8_t>(((p[0] * kYB + p[1] * kYG + p[2] * kYR + 64) >> 7) + 16);
+    }
+}
+
+static void ToUvScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, uint32_t count, bool interleaved)
+{
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        // Odd widths reuse the last pixel as its own neighbour
+        uint32_t j = (i + 1 < count) ? i + 1 : i;
+        int avg[3];
+        for (int c = 0; c < 3; c++)
+        {
+            int left = (row0[i * 4 + c] + row1[i * 4 + c] + 1) >> 1;
+            int right = (row0[j * 4 + c] + row1[j * 4 + c] + 1) >> 1;
+            avg[c] = (left + right + 1) >> 1;
+        }
+
+        // Arithmetic shift, matching the vector kernels
+        uint8_t cu = ClampByte(((avg[0] * kUB + avg[1] * kUG + avg[2] * kUR + 64) >> 7) + 128);
+        uint8_t cv = ClampByte(((avg[0] * kVB + avg[1] * kVG + avg[2] * kVR + 64) >> 7) + 128);
+        if (interleaved)
+        {
+            u[i] = cu;
+            u[i + 1] = cv;
+        }
+        else
+        {
+            u[i / 2] = cu;
+            v[i / 2] = cv;
+        }
+    }
+}
+
+#if defined(OVD_SIMD_X86)
+
+OVD_TARGET("ssse3")
+static void SwapRedBlueSsse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(px, mask));
+    }
+    SwapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+OVD_TARGET("avx2")
+static void SwapRedBlueAvx2(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(px, mask));
+    }
+    SwapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+OVD_TARGET("ssse3")
+static void ToRgbSsse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    uint32_t i = 0;
+    // Each store writes 16 bytes of which 12 are valid; stop while the overhang stays in the row
+    for (; i + 6 <= count; i += 4)
+    {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm_shuffle_epi8(px, mask));
+    }
+    ToRgbScalar(src + i * 4, dst + i * 3, count - i);
+}
+
+// Weighted sum of B, G, R for 8 pixels, (sum + 64) >> 7 as 8 int16 lanes
+OVD_TARGET("ssse3")
+static inline __m128i WeightedSum8Ssse3(const uint8_t* src, __m128i weights)
+{
+    __m128i a = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), weights);
+    __m128i b = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)), weights);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_hadd_epi16(a, b), _mm_set1_epi16(64)), 7);
+}
+
+OVD_TARGET("ssse3")
+static void ToGraySsse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m128i weights = _mm_setr_epi8(
+        kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0,
+        kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i sum = WeightedSum8Ssse3(src + i * 4, weights);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(sum, sum));
+    }
+    ToGrayScalar(src + i * 4, dst + i, count - i);
+}
+
+OVD_TARGET("ssse3")
+static void ToYSsse3(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m128i weights = _mm_setr_epi8(
+        kYB, kYG, kYR, 0, kYB, kYG, kYR, 0,
+        kYB, kYG, kYR, 0, kYB, kYG, kYR, 0);
+    const __m128i offset = _mm_set1_epi16(16);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i sum = _mm_add_epi16(WeightedSum8Ssse3(src + i * 4, weights), offset);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(sum, sum));
+    }
+    ToYScalar(src + i * 4, dst + i, count - i);
+}
+
+// Weighted luma over 16 pixels, permuted back into pixel order after the in-lane hadd
+OVD_TARGET("avx2")
+static inline __m128i WeightedSum16Avx2(const uint8_t* src, __m256i weights, __m256i offset)
+{
+    __m256i a = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), weights);
+    __m256i b = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)), weights);
+    __m256i sum = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(a, b), _mm256_set1_epi16(64)), 7);
+    sum = _mm256_permute4x64_epi64(_mm256_add_epi16(sum, offset), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+}
+
+OVD_TARGET("avx2")
+static void ToGrayAvx2(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m256i weights = _mm256_setr_epi8(
+        kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0,
+        kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0, kGrayB, kGrayG, kGrayR, 0);
+    const __m256i offset = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), WeightedSum16Avx2(src + i * 4, weights, offset));
+    }
+    ToGrayScalar(src + i * 4, dst + i, count - i);
+}
+
+OVD_TARGET("avx2")
+static void ToYAvx2(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m256i weights = _mm256_setr_epi8(
+        kYB, kYG, kYR, 0, kYB, kYG, kYR, 0, kYB, kYG, kYR, 0, kYB, kYG, kYR, 0,
+        kYB, kYG, kYR, 0, kYB, kYG, kYR, 0, kYB, kYG, kYR, 0, kYB, kYG, kYR, 0);
+    const __m256i offset = _mm256_set1_epi16(16);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), WeightedSum16Avx2(src + i * 4, weights, offset));
+    }
+    ToYScalar(src + i * 4, dst + i, count - i);
+}
+
+OVD_TARGET("ssse3")
+static void ToUvSsse3(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, uint32_t count, bool interleaved)
+{
+    const __m128i weightsU = _mm_setr_epi8(
+        kUB, kUG, kUR, 0, kUB, kUG, kUR, 0, kUB, kUG, kUR, 0, kUB, kUG, kUR, 0);
+    const __m128i weightsV = _mm_setr_epi8(
+        kVB, kVG, kVR, 0, kVB, kVG, kVR, 0, kVB, kVG, kVR, 0, kVB, kVG, kVR, 0);
+    const __m128i round = _mm_set1_epi16(64);
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i interleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // Vertical then horizontal pair average, 8 source pixels down to 4
+        __m128i a = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i * 4)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i * 4)));
+        __m128i b = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i * 4 + 16)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i * 4 + 16)));
+        __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i avg = _mm_avg_epu8(even, odd);
+
+        // Lanes 0-3 hold U, lanes 4-7 hold V
+        __m128i uv = _mm_hadd_epi16(_mm_maddubs_epi16(avg, weightsU), _mm_maddubs_epi16(avg, weightsV));
+        uv = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(uv, round), 7), bias);
+        uv = _mm_packus_epi16(uv, uv);
+
+        if (interleaved)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(u + i), _mm_shuffle_epi8(uv, interleave));
+        }
+        else
+        {
+            int packed = _mm_cvtsi128_si32(uv);
+            std::memcpy(u + i / 2, &packed, 4);
+            packed = _mm_cvtsi128_si32(_mm_srli_si128(uv, 4));
+            std::memcpy(v + i / 2, &packed, 4);
+        }
+    }
+
+    if (i < count)
+    {
+        if (interleaved)
+            ToUvScalar(row0 + i * 4, row1 + i * 4, u + i, nullptr, count - i, true);
+        else
+            ToUvScalar(row0 + i * 4, row1 + i * 4, u + i / 2, v + i / 2, count - i, false);
+    }
+}
+
+#endif // OVD_SIMD_X86
+
+#if defined(OVD_SIMD_NEON)
+
+static void SwapRedBlueNeon(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        uint8x16_t b = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = b;
+        vst4q_u8(dst + i * 4, px);
+    }
+    SwapRedBlueScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+static void ToRgbNeon(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        uint8x16x3_t rgb;
+        rgb.val[0] = px.val[2];
+        rgb.val[1] = px.val[1];
+        rgb.val[2] = px.val[0];
+        vst3q_u8(dst + i * 3, rgb);
+    }
+    ToRgbScalar(src + i * 4, dst + i * 3, count - i);
+}
+
+// (B * wb + G * wg + R * wr + 64) >> 7 + offset for 8 pixels
+static inline uint8x8_t WeightedSum8Neon(const uint8_t* src, uint8_t wb, uint8_t wg, uint8_t wr, uint8_t offset)
+{
+    uint8x8x4_t px = vld4_u8(src);
+    uint16x8_t sum = vmull_u8(px.val[0], vdup_n_u8(wb));
+    sum = vmlal_u8(sum, px.val[1], vdup_n_u8(wg));
+    sum = vmlal_u8(sum, px.val[2], vdup_n_u8(wr));
+    return vadd_u8(vrshrn_n_u16(sum, 7), vdup_n_u8(offset));
+}
+
+static void ToGrayNeon(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1_u8(dst + i, WeightedSum8Neon(src + i * 4, kGrayB, kGrayG, kGrayR, 0));
+    }
+    ToGrayScalar(src + i * 4, dst + i, count - i);
+}
+
+static void ToYNeon(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1_u8(dst + i, WeightedSum8Neon(src + i * 4, kYB, kYG, kYR, 16));
+    }
+    ToYScalar(src + i * 4, dst + i, count - i);
+}
+
+#endif // OVD_SIMD_NEON
+
+std::vector<ConvertKernels> GetConvertKernelVariants()
+{
+    std::vector<ConvertKernels> variants;
+    variants.push_back(ConvertKernels{ "scalar", SwapRedBlueScalar, ToRgbScalar, ToGrayScalar, ToYScalar, ToUvScalar });
+#if defined(OVD_SIMD_X86)
+    if (CpuHasSsse3())
+    {
+        variants.push_back(ConvertKernels{ "ssse3", SwapRedBlueSsse3, ToRgbSsse3, ToGraySsse3, ToYSsse3, ToUvSsse3 });
+        // Rgb and chroma only have an SSSE3 version
+        if (CpuHasAvx2())
+            variants.push_back(ConvertKernels{ "avx2", SwapRedBlueAvx2, ToRgbSsse3, ToGrayAvx2, ToYAvx2, ToUvSsse3 });
+    }
+#elif defined(OVD_SIMD_NEON)
+    variants.push_back(ConvertKernels{ "neon", SwapRedBlueNeon, ToRgbNeon, ToGrayNeon, ToYNeon, ToUvScalar });
+#endif
+    return variants;
+}
+
+static const ConvertKernels& GetConvertKernels()
+{
+    static const ConvertKernels kernels = GetConvertKernelVariants().back();
+    return kernels;
+}
+
+bool IsValidPixelFormat(PixelFormat format)
+{
+    return static_cast<uint32_t>(format) <= static_cast<uint32_t>(PixelFormat::Rgba16F);
+}
+
+bool IsPlanarPixelFormat(PixelFormat format)
+{
+    return format == PixelFormat::I420 || format == PixelFormat::Nv12;
+}
+
+bool IsFourBytePixelFormat(PixelFormat format)
+{
+    return format == PixelFormat::Bgra8 || format == PixelFormat::Rgba8;
+}
+
+size_t GetPixelFormatSize(PixelFormat format, uint32_t width, uint32_t height)
+{
+    size_t pixels = static_cast<size_t>(width) * height;
+    size_t chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    switch (format)
+    {
+        case PixelFormat::Bgra8:
+        case PixelFormat::Rgba8: return pixels * 4;
+        case PixelFormat::Rgb8: return pixels * 3;
+        case PixelFormat::I420:
+        case PixelFormat::Nv12: return pixels + chroma * 2;
+        case PixelFormat::Gray8: return pixels;
+        case PixelFormat::Rgba16F: return pixels * 8;
+        default: return 0;
+    }
+}
+
+// Writes rows [rowBegin, rowEnd) of a width x height image at their place in dst.
+// srcRow(y) returns BGRA row y of the image.
+template<typename SrcRowFn>
+static void ConvertBgraRowRange(const ConvertKernels& kernels, SrcRowFn srcRow, uint32_t width, uint32_t height, PixelFormat format, uint8_t* dst,
+                                uint32_t rowBegin, uint32_t rowEnd)
+{
+    switch (format)
+    {
+        case PixelFormat::Bgra8:
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+                std::memcpy(dst + static_cast<size_t>(y) * width * 4, srcRow(y), width * 4);
+            break;
+
+        case PixelFormat::Rgba8:
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+                kernels.swapRedBlue(srcRow(y), dst + static_cast<size_t>(y) * width * 4, width);
+            break;
+
+        case PixelFormat::Rgb8:
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+                kernels.toRgb(srcRow(y), dst + static_cast<size_t>(y) * width * 3, width);
+            break;
+
+        case PixelFormat::Gray8:
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+                kernels.toGray(srcRow(y), dst + static_cast<size_t>(y) * width, width);
+            break;
+
+        case PixelFormat::Rgba16F:
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+                UnpackRowToHalf(SourceFormat::Bgra8, srcRow(y), reinterpret_cast<uint16_t*>(dst + static_cast<size_t>(y) * width * 8), width);
+            break;
+
+        case PixelFormat::I420:
+        case PixelFormat::Nv12:
+        {
+            bool interleaved = format == PixelFormat::Nv12;
+            uint32_t chromaWidth = (width + 1) / 2;
+            uint32_t chromaHeight = (height + 1) / 2;
+            uint8_t* planeY = dst;
+            uint8_t* planeU = dst + static_cast<size_t>(width) * height;
+            uint8_t* planeV = planeU + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+            for (uint32_t y = rowBegin; y < rowEnd; y += 2)
+            {
+                // Odd heights reuse the last row as its own neighbour
+                const uint8_t* row0 = srcRow(y);
+                const uint8_t* row1 = (y + 1 < height) ? srcRow(y + 1) : row0;
+
+                kernels.toY(row0, planeY + static_cast<size_t>(y) * width, width);
+                if (y + 1 < height)
+                    kernels.toY(row1, planeY + static_cast<size_t>(y + 1) * width, width);
+
+                size_t chromaRow = y / 2;
+                if (interleaved)
+                    kernels.toUv(row0, row1, planeU + chromaRow * chromaWidth * 2, nullptr, width, true);
+                else
+                    kernels.toUv(row0, row1, planeU + chromaRow * chromaWidth, planeV + chromaRow * chromaWidth, width, false);
+            }
+            break;
+        }
+    }
+}
+
+void ConvertBgra(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst)
+{
+    ConvertBgraRows(src, srcPitch, srcRect, format, dst, 0, srcRect.height);
+}
+
+void ConvertBgraRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst,
+                     uint32_t rowBegin, uint32_t rowEnd)
+{
+    auto srcRow = [&](uint32_t y) { return src + static_cast<size_t>(srcRect.y + y) * srcPitch + srcRect.x * 4; };
+    ConvertBgraRowRange(GetConvertKernels(), srcRow, srcRect.width, srcRect.height, format, dst, rowBegin, std::min(rowEnd, srcRect.height));
+}
+
+void ConvertBgraWithKernels(const ConvertKernels& kernels, const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst)
+{
+    auto srcRow = [&](uint32_t y) { return src + static_cast<size_t>(srcRect.y + y) * srcPitch + srcRect.x * 4; };
+    ConvertBgraRowRange(kernels, srcRow, srcRect.width, srcRect.height, format, dst, 0, srcRect.height);
+}
+
+void ConvertImage(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, SourceFormat source, PixelFormat format, uint8_t* dst)
+{
+    ConvertImageRows(src, srcPitch, srcRect, source, format, dst, 0, srcRect.height);
+}
+
+void ConvertImageRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, SourceFormat source, PixelFormat format, uint8_t* dst,
+                      uint32_t rowBegin, uint32_t rowEnd)
+{
+    if (source == SourceFormat::Bgra8)
+    {
+        ConvertBgraRows(src, srcPitch, srcRect, format, dst, rowBegin, rowEnd);
+        return;
+    }
+
+    const uint32_t width = srcRect.width;
+    const uint32_t height = srcRect.height;
+    rowEnd = std::min(rowEnd, height);
+    if (rowBegin >= rowEnd)
+        return;
+    auto srcRow = [&](uint32_t y) { return src + static_cast<size_t>(srcRect.y + y) * srcPitch + srcRect.x * 4; };
+
+    if (format == PixelFormat::Rgba16F)
+    {
+        for (uint32_t y = rowBegin; y < rowEnd; y++)
+            UnpackRowToHalf(source, srcRow(y), reinterpret_cast<uint16_t*>(dst + static_cast<size_t>(y) * width * 8), width);
+        return;
+    }
+
+    if (source == SourceFormat::Rgba8 && format == PixelFormat::Rgba8)
+    {
+        for (uint32_t y = rowBegin; y < rowEnd; y++)
+            std::memcpy(dst + static_cast<size_t>(y) * width * 4, srcRow(y), width * 4);
+        return;
+    }
+
+    // Everything else is defined on BGRA, so unpack once and reuse those paths
+    const ConvertKernels& kernels = GetConvertKernels();
+    uint8_t* bgra = dst + static_cast<size_t>(rowBegin) * width * 4;
+    thread_local std::vector<uint8_t> scratch;
+    if (format != PixelFormat::Bgra8)
+    {
+        scratch.resize(static_cast<size_t>(width) * (rowEnd - rowBegin) * 4);
+        bgra = scratch.data();
+    }
+
+    for (uint32_t y = rowBegin; y < rowEnd; y++)
+    {
+        uint8_t* row = bgra + static_cast<size_t>(y - rowBegin) * width * 4;
+        if (source == SourceFormat::Rgba8)
+            kernels.swapRedBlue(srcRow(y), row, width);
+        else
+            UnpackRowToBgra8(source, srcRow(y), row, width);
+    }
+
+    if (format != PixelFormat::Bgra8)
+    {
+        auto bgraRow = [&](uint32_t y) { return bgra + static_cast<size_t>(y - rowBegin) * width * 4; };
+        ConvertBgraRowRange(kernels, bgraRow, width, height, format, dst, rowBegin, rowEnd);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "resample.h"
+#include "unpack.h"
+
+// Output pixel formats a client can ask for. Carried in the frame info.
+enum class PixelFormat : uint32_t {
+    Bgra8 = 0,  // 4 bytes per pixel, as rendered
+    Rgba8 = 1,  // 4 bytes per pixel
+    Rgb8 = 2,   // 3 bytes per pixel, alpha dropped
+    I420 = 3,   // Planar Y, U, V with 2x2 subsampled chroma (BT.601 limited range)
+    Nv12 = 4,   // Planar Y followed by interleaved UV (BT.601 limited range)
+    Gray8 = 5,  // Full range luma
+    Rgba16F = 6 // 8 bytes per pixel, RGBA half floats in 0..1. Keeps 10-bit sources lossless.
+};
+
+bool IsValidPixelFormat(PixelFormat format);
+
+// I420 and Nv12; every other format is a single plane of whole pixels
+bool IsPlanarPixelFormat(PixelFormat format);
+
+// True for formats with 4 bytes per pixel and no planes, the ones the frame codecs accept
+bool IsFourBytePixelFormat(PixelFormat format);
+
+// Size in bytes of a tightly packed width x height image. Chroma planes round up for odd sizes.
+size_t GetPixelFormatSize(PixelFormat format, uint32_t width, uint32_t height);
+
+// Converts a rectangle of a BGRA image straight out of (mapped) source memory into a
+// tightly packed image of the requested format.
+void ConvertBgra(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst);
+
+// Same as ConvertBgra for any staging layout. Rgba16F is converted straight from the source;
+// other formats go through an 8-bit BGRA copy first unless the source already is one.
+void ConvertImage(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, SourceFormat source, PixelFormat format, uint8_t* dst);
+
+// Row range variants: only rows [rowBegin, rowEnd) of srcRect are converted, written at their
+// place in the full dst image, so disjoint ranges can run on different threads.
+// rowBegin must be even for planar formats since chroma rows cover two image rows.
+void ConvertBgraRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst,
+                     uint32_t rowBegin, uint32_t rowEnd);
+void ConvertImageRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, SourceFormat source, PixelFormat format, uint8_t* dst,
+                      uint32_t rowBegin, uint32_t rowEnd);
+
+// One implementation of the row kernels behind the conversions
+struct ConvertKernels {
+    const char* name;
+    void (*swapRedBlue)(const uint8_t* src, uint8_t* dst, uint32_t count);
+    void (*toRgb)(const uint8_t* src, uint8_t* dst, uint32_t count);
+    void (*toGray)(const uint8_t* src, uint8_t* dst, uint32_t count);
+    void (*toY)(const uint8_t* src, uint8_t* dst, uint32_t count);
+    // Averages 2x2 blocks of two source rows into count / 2 rounded up chroma samples.
+    // interleaved writes U and V alternately to u (NV12), otherwise to separate planes.
+    void (*toUv)(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, uint32_t count, bool interleaved);
+};
+
+// Every implementation this CPU can run, scalar reference first, for checks and benchmarks.
+// The Convert functions above use the last one.
+std::vector<ConvertKernels> GetConvertKernelVariants();
+
+// ConvertBgra with the given kernels instead of the ones picked for this CPU
+void ConvertBgraWithKernels(const ConvertKernels& kernels, const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect, PixelFormat format, uint8_t* dst);
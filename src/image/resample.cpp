@@ -0,0 +1,201 @@
+#include "resample.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Scratch rows, per thread so concurrent stripes never share them
+static thread_local std::vector<uint8_t> t_rowBuffer;
+static thread_local std::vector<uint32_t> t_accumulator;
+
+// dst = (a * (256 - weight) + b * weight) / 256, per byte
+static void LerpRow(const uint8_t* a, const uint8_t* b, uint32_t weight, uint8_t* dst, uint32_t bytes)
+{
+    uint32_t i = 0;
+#ifdef OVD_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(static_cast<short>(256 - weight));
+    const __m128i wb = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i round = _mm_set1_epi16(128);
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa), _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa), _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < bytes; i++)
+    {
+        dst[i] = static_cast<uint8_t>((a[i] * (256 - weight) + b[i] * weight + 128) >> 8);
+    }
+}
+
+// acc[i] += row[i] for every byte of the row
+static void AccumulateRow(const uint8_t* row, uint32_t* acc, uint32_t bytes)
+{
+    uint32_t i = 0;
+#ifdef OVD_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a + 0, _mm_add_epi32(_mm_loadu_si128(a + 0), _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_unpackhi_epi16(hi, zero)));
+    }
+#endif
+    for (; i < bytes; i++)
+    {
+        acc[i] += row[i];
+    }
+}
+
+static void ResampleBilinear(const uint8_t* src, uint32_t srcPitch, const PixelRect& rect,
+                             uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t rowBegin, uint32_t rowEnd)
+{
+    // Column taps: left source pixel and the weight of its right neighbour, sampled at pixel centers
+    struct Tap { uint32_t x; uint32_t weight; };
+    std::vector<Tap> columns(dstWidth);
+    float scaleX = static_cast<float>(rect.width) / dstWidth;
+    for (uint32_t dx = 0; dx < dstWidth; dx++)
+    {
+        float sx = std::clamp((dx + 0.5f) * scaleX - 0.5f, 0.0f, static_cast<float>(rect.width - 1));
+        uint32_t x = static_cast<uint32_t>(sx);
+        columns[dx] = { x, static_cast<uint32_t>((sx - x) * 256.0f + 0.5f) };
+    }
+
+    // One spare pixel past the end so the right tap of the last column is always readable
+    uint32_t rowBytes = rect.width * 4;
+    t_rowBuffer.resize(rowBytes + 4);
+    uint8_t* row = t_rowBuffer.data();
+
+    float scaleY = static_cast<float>(rect.height) / dstHeight;
+    for (uint32_t dy = rowBegin; dy < rowEnd; dy++)
+    {
+        float sy = std::clamp((dy + 0.5f) * scaleY - 0.5f, 0.0f, static_cast<float>(rect.height - 1));
+        uint32_t y0 = static_cast<uint32_t>(sy);
+        uint32_t y1 = std::min(y0 + 1, rect.height - 1);
+        uint32_t weightY = static_cast<uint32_t>((sy - y0) * 256.0f + 0.5f);
+
+        const uint8_t* row0 = src + static_cast<size_t>(rect.y + y0) * srcPitch + rect.x * 4;
+        const uint8_t* row1 = src + static_cast<size_t>(rect.y + y1) * srcPitch + rect.x * 4;
+        if (weightY == 0)
+            std::memcpy(row, row0, rowBytes);
+        else
+            LerpRow(row0, row1, weightY, row, rowBytes);
+        std::memcpy(row + rowBytes, row + rowBytes - 4, 4);
+
+        uint8_t* dstRow = dst + static_cast<size_t>(dy) * dstWidth * 4;
+#ifdef OVD_SIMD_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        for (uint32_t dx = 0; dx < dstWidth; dx++)
+        {
+            const Tap& tap = columns[dx];
+            short wl = static_cast<short>(256 - tap.weight);
+            short wr = static_cast<short>(tap.weight);
+            __m128i weights = _mm_setr_epi16(wl, wl, wl, wl, wr, wr, wr, wr);
+            __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + tap.x * 4)), zero);
+            __m128i v = _mm_mullo_epi16(pair, weights);
+            v = _mm_add_epi16(v, _mm_srli_si128(v, 8));
+            v = _mm_srli_epi16(_mm_add_epi16(v, round), 8);
+            int packed = _mm_cvtsi128_si32(_mm_packus_epi16(v, zero));
+            std::memcpy(dstRow + dx * 4, &packed, 4);
+        }
+#else
+        for (uint32_t dx = 0; dx < dstWidth; dx++)
+        {
+            const Tap& tap = columns[dx];
+            const uint8_t* left = row + tap.x * 4;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                dstRow[dx * 4 + c] = static_cast<uint8_t>((left[c] * (256 - tap.weight) + left[c + 4] * tap.weight + 128) >> 8);
+            }
+        }
+#endif
+    }
+}
+
+static void ResampleBox(const uint8_t* src, uint32_t srcPitch, const PixelRect& rect,
+                        uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, uint32_t rowBegin, uint32_t rowEnd)
+{
+    // Each destination pixel averages the source pixels its footprint covers (at least one)
+    std::vector<uint32_t> columnStart(dstWidth + 1);
+    for (uint32_t dx = 0; dx <= dstWidth; dx++)
+    {
+        columnStart[dx] = static_cast<uint32_t>(static_cast<uint64_t>(dx) * rect.width / dstWidth);
+    }
+
+    uint32_t rowBytes = rect.width * 4;
+    t_accumulator.resize(rowBytes);
+    uint32_t* acc = t_accumulator.data();
+
+    for (uint32_t dy = rowBegin; dy < rowEnd; dy++)
+    {
+        uint32_t y0 = static_cast<uint32_t>(static_cast<uint64_t>(dy) * rect.height / dstHeight);
+        uint32_t y1 = std::max(y0 + 1, static_cast<uint32_t>(static_cast<uint64_t>(dy + 1) * rect.height / dstHeight));
+
+        std::fill(acc, acc + rowBytes, 0u);
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            AccumulateRow(src + static_cast<size_t>(rect.y + y) * srcPitch + rect.x * 4, acc, rowBytes);
+        }
+
+        uint8_t* dstRow = dst + static_cast<size_t>(dy) * dstWidth * 4;
+        for (uint32_t dx = 0; dx < dstWidth; dx++)
+        {
+            uint32_t x0 = columnStart[dx];
+            uint32_t x1 = std::max(x0 + 1, columnStart[dx + 1]);
+            float scale = 1.0f / ((x1 - x0) * (y1 - y0));
+#ifdef OVD_SIMD_SSE2
+            __m128i sum = _mm_setzero_si128();
+            for (uint32_t x = x0; x < x1; x++)
+            {
+                sum = _mm_add_epi32(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + x * 4)));
+            }
+            __m128i avg = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(scale)));
+            avg = _mm_packs_epi32(avg, avg);
+            int packed = _mm_cvtsi128_si32(_mm_packus_epi16(avg, avg));
+            std::memcpy(dstRow + dx * 4, &packed, 4);
+#else
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t sum = 0;
+                for (uint32_t x = x0; x < x1; x++)
+                {
+                    sum += acc[x * 4 + c];
+                }
+                dstRow[dx * 4 + c] = static_cast<uint8_t>(std::min(255.0f, sum * scale + 0.5f));
+            }
+#endif
+        }
+    }
+}
+
+void ResampleBgra(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect,
+                  uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, ResampleFilter filter)
+{
+    ResampleBgraRows(src, srcPitch, srcRect, dst, dstWidth, dstHeight, filter, 0, dstHeight);
+}
+
+void ResampleBgraRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect,
+                      uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, ResampleFilter filter,
+                      uint32_t rowBegin, uint32_t rowEnd)
+{
+    rowEnd = std::min(rowEnd, dstHeight);
+    if (srcRect.width == 0 || srcRect.height == 0 || dstWidth == 0 || rowBegin >= rowEnd)
+        return;
+
+    if (filter == ResampleFilter::Box)
+        ResampleBox(src, srcPitch, srcRect, dst, dstWidth, dstHeight, rowBegin, rowEnd);
+    else
+        ResampleBilinear(src, srcPitch, srcRect, dst, dstWidth, dstHeight, rowBegin, rowEnd);
+}
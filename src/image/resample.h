@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+enum class ResampleFilter : uint32_t {
+    Box = 0,      // Area average, best for large downscales
+    Bilinear = 1
+};
+
+// Region of a source image, in pixels
+struct PixelRect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Resamples a rectangle of a BGRA image straight out of (mapped) source memory into a
+// tightly packed dstWidth x dstHeight BGRA buffer. Cropping and scaling happen in one pass.
+void ResampleBgra(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect,
+                  uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, ResampleFilter filter);
+
+// Produces only destination rows [rowBegin, rowEnd) of the same resample, written at their
+// place in dst. Disjoint row ranges can run on different threads.
+void ResampleBgraRows(const uint8_t* src, uint32_t srcPitch, const PixelRect& srcRect,
+                      uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, ResampleFilter filter,
+                      uint32_t rowBegin, uint32_t rowEnd);
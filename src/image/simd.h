@@ -0,0 +1,70 @@
+#pragma once
+
+// Instruction set selection for the pixel kernels. Each kernel keeps a scalar
+// path so the code still builds for targets without the vector extensions.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define OVD_SIMD_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+// SSSE3 and AVX2 are not part of the x64 baseline, so those kernels are compiled with
+// per-function target attributes and picked at runtime after checking the CPU.
+#if defined(OVD_SIMD_SSE2)
+    #define OVD_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define OVD_TARGET(isa)
+    #else
+        #include <cpuid.h>
+        #define OVD_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+    #define OVD_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(OVD_SIMD_X86)
+inline bool CpuHasSsse3()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+inline bool CpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    if (!osSavesYmm || !(info[2] & (1 << 28)))
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool CpuHasF16c()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    return osSavesYmm && (info[2] & (1 << 29)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return __builtin_cpu_supports("avx") && (ecx & (1u << 29)) != 0;
+#endif
+}
+#endif
@@ -0,0 +1,267 @@
+#include "tile_hash.h"
+#include "simd.h"
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+// Each tile keeps 8 64-bit lanes. A row is consumed in 64-byte blocks, each block with its own
+// slice of the secret, then the lanes are scrambled so row order matters.
+static constexpr uint32_t kLanes = 8;
+static constexpr uint32_t kBlockBytes = 64;
+static constexpr uint32_t kMaxRowBlocks = kTileSize * 4 / kBlockBytes;
+
+static constexpr uint64_t kPrime32 = 0x9E3779B1u;
+static constexpr uint64_t kPrime64a = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t kPrime64b = 0xC2B2AE3D27D4EB4Full;
+
+static constexpr uint64_t SplitMix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Secret words for each block of a row plus one set for the scramble
+struct Secret {
+    uint64_t words[(kMaxRowBlocks + 1) * kLanes];
+};
+
+static constexpr Secret MakeSecret()
+{
+    Secret secret{};
+    for (uint32_t i = 0; i < (kMaxRowBlocks + 1) * kLanes; i++)
+        secret.words[i] = SplitMix(i);
+    return secret;
+}
+
+alignas(64) static constexpr Secret kSecret = MakeSecret();
+static const uint64_t* kScrambleSecret = kSecret.words + kMaxRowBlocks * kLanes;
+
+#if !defined(OVD_SIMD_X86) && !defined(OVD_SIMD_NEON)
+
+static void AccumulateRowScalar(uint64_t* acc, const uint8_t* data, uint32_t blocks)
+{
+    for (uint32_t b = 0; b < blocks; b++)
+    {
+        uint64_t words[kLanes];
+        std::memcpy(words, data + b * kBlockBytes, kBlockBytes);
+        const uint64_t* key = kSecret.words + b * kLanes;
+        for (uint32_t i = 0; i < kLanes; i++)
+        {
+            uint64_t dataKey = words[i] ^ key[i];
+            acc[i] += words[i ^ 1];
+            acc[i] += (dataKey & 0xFFFFFFFFu) * (dataKey >> 32);
+        }
+    }
+
+    for (uint32_t i = 0; i < kLanes; i++)
+    {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= kScrambleSecret[i];
+        acc[i] = a * kPrime32;
+    }
+}
+
+#endif // !OVD_SIMD_X86 && !OVD_SIMD_NEON
+
+#if defined(OVD_SIMD_X86)
+
+static void AccumulateRowSse2(uint64_t* acc, const uint8_t* data, uint32_t blocks)
+{
+    __m128i a[4];
+    for (uint32_t i = 0; i < 4; i++)
+        a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+
+    for (uint32_t b = 0; b < blocks; b++)
+    {
+        const __m128i* src = reinterpret_cast<const __m128i*>(data + b * kBlockBytes);
+        const __m128i* key = reinterpret_cast<const __m128i*>(kSecret.words + b * kLanes);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            __m128i words = _mm_loadu_si128(src + i);
+            __m128i dataKey = _mm_xor_si128(words, _mm_load_si128(key + i));
+            __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(words, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(swapped, product));
+        }
+    }
+
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(kPrime32));
+    const __m128i* key = reinterpret_cast<const __m128i*>(kScrambleSecret);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        __m128i x = _mm_xor_si128(a[i], _mm_srli_epi64(a[i], 47));
+        x = _mm_xor_si128(x, _mm_load_si128(key + i));
+        __m128i lo = _mm_mul_epu32(x, prime);
+        __m128i hi = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+    }
+}
+
+OVD_TARGET("avx2") static void AccumulateRowAvx2(uint64_t* acc, const uint8_t* data, uint32_t blocks)
+{
+    __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + 1);
+
+    for (uint32_t b = 0; b < blocks; b++)
+    {
+        const __m256i* src = reinterpret_cast<const __m256i*>(data + b * kBlockBytes);
+        const __m256i* key = reinterpret_cast<const __m256i*>(kSecret.words + b * kLanes);
+
+        __m256i w0 = _mm256_loadu_si256(src);
+        __m256i w1 = _mm256_loadu_si256(src + 1);
+        __m256i k0 = _mm256_xor_si256(w0, _mm256_load_si256(key));
+        __m256i k1 = _mm256_xor_si256(w1, _mm256_load_si256(key + 1));
+        __m256i p0 = _mm256_mul_epu32(k0, _mm256_shuffle_epi32(k0, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m256i p1 = _mm256_mul_epu32(k1, _mm256_shuffle_epi32(k1, _MM_SHUFFLE(0, 3, 0, 1)));
+        a0 = _mm256_add_epi64(a0, _mm256_add_epi64(_mm256_shuffle_epi32(w0, _MM_SHUFFLE(1, 0, 3, 2)), p0));
+        a1 = _mm256_add_epi64(a1, _mm256_add_epi64(_mm256_shuffle_epi32(w1, _MM_SHUFFLE(1, 0, 3, 2)), p1));
+    }
+
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(kPrime32));
+    const __m256i* key = reinterpret_cast<const __m256i*>(kScrambleSecret);
+    __m256i lanes[2] = { a0, a1 };
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        __m256i x = _mm256_xor_si256(lanes[i], _mm256_srli_epi64(lanes[i], 47));
+        x = _mm256_xor_si256(x, _mm256_load_si256(key + i));
+        __m256i lo = _mm256_mul_epu32(x, prime);
+        __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), prime);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+    }
+}
+
+#endif // OVD_SIMD_X86
+
+#if defined(OVD_SIMD_NEON)
+
+static void AccumulateRowNeon(uint64_t* acc, const uint8_t* data, uint32_t blocks)
+{
+    uint64x2_t a[4];
+    for (uint32_t i = 0; i < 4; i++)
+        a[i] = vld1q_u64(acc + i * 2);
+
+    for (uint32_t b = 0; b < blocks; b++)
+    {
+        const uint8_t* src = data + b * kBlockBytes;
+        const uint64_t* key = kSecret.words + b * kLanes;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            uint64x2_t words = vreinterpretq_u64_u8(vld1q_u8(src + i * 16));
+            uint64x2_t dataKey = veorq_u64(words, vld1q_u64(key + i * 2));
+            a[i] = vaddq_u64(a[i], vextq_u64(words, words, 1));
+            a[i] = vmlal_u32(a[i], vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint64x2_t x = veorq_u64(a[i], vshrq_n_u64(a[i], 47));
+        x = veorq_u64(x, vld1q_u64(kScrambleSecret + i * 2));
+        uint64x2_t lo = vmull_u32(vmovn_u64(x), vdup_n_u32(static_cast<uint32_t>(kPrime32)));
+        uint64x2_t hi = vmull_u32(vshrn_n_u64(x, 32), vdup_n_u32(static_cast<uint32_t>(kPrime32)));
+        vst1q_u64(acc + i * 2, vaddq_u64(lo, vshlq_n_u64(hi, 32)));
+    }
+}
+
+#endif // OVD_SIMD_NEON
+
+using AccumulateRowFn = void (*)(uint64_t* acc, const uint8_t* data, uint32_t blocks);
+
+static AccumulateRowFn SelectAccumulateRow()
+{
+#if defined(OVD_SIMD_X86)
+    return CpuHasAvx2() ? AccumulateRowAvx2 : AccumulateRowSse2;
+#elif defined(OVD_SIMD_NEON)
+    return AccumulateRowNeon;
+#else
+    return AccumulateRowScalar;
+#endif
+}
+
+static AccumulateRowFn GetAccumulateRow()
+{
+    static const AccumulateRowFn accumulateRow = SelectAccumulateRow();
+    return accumulateRow;
+}
+
+static inline uint64_t Avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    return h ^ (h >> 32);
+}
+
+static uint64_t FinishTile(const uint64_t* acc, uint32_t width, uint32_t height)
+{
+    uint64_t h = (static_cast<uint64_t>(width) << 32 | height) * kPrime64a;
+    for (uint32_t i = 0; i < kLanes; i++)
+    {
+        h ^= Avalanche(acc[i] * kPrime64b);
+        h = ((h << 27) | (h >> 37)) * kPrime64a;
+    }
+    return Avalanche(h);
+}
+
+// Hashes one band of tile rows. Rows are walked top to bottom across all tiles of the band,
+// so the image is read once in memory order.
+static void HashTileBand(AccumulateRowFn accumulateRow, const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t bandHeight, uint64_t* acc, uint64_t* hashes)
+{
+    uint32_t columns = GetTileColumns(width);
+    std::memset(acc, 0, static_cast<size_t>(columns) * kLanes * sizeof(uint64_t));
+
+    // Edge tiles whose rows aren't whole blocks are zero padded
+    alignas(64) uint8_t padded[kTileSize * 4];
+
+    for (uint32_t y = 0; y < bandHeight; y++)
+    {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * rowPitch;
+        for (uint32_t tx = 0; tx < columns; tx++)
+        {
+            uint32_t tileWidth = std::min(kTileSize, width - tx * kTileSize);
+            uint32_t bytes = tileWidth * 4;
+            const uint8_t* tileRow = row + tx * kTileSize * 4;
+            if (bytes % kBlockBytes != 0)
+            {
+                std::memset(padded, 0, sizeof(padded));
+                std::memcpy(padded, tileRow, bytes);
+                tileRow = padded;
+            }
+            accumulateRow(acc + tx * kLanes, tileRow, (bytes + kBlockBytes - 1) / kBlockBytes);
+        }
+    }
+
+    for (uint32_t tx = 0; tx < columns; tx++)
+        hashes[tx] = FinishTile(acc + tx * kLanes, std::min(kTileSize, width - tx * kTileSize), bandHeight);
+}
+
+void HashTiles(const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height, uint64_t* hashes)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    thread_local std::vector<uint64_t> acc;
+    acc.resize(static_cast<size_t>(GetTileColumns(width)) * kLanes);
+
+    AccumulateRowFn accumulateRow = GetAccumulateRow();
+    uint32_t columns = GetTileColumns(width);
+    for (uint32_t ty = 0; ty < GetTileRows(height); ty++)
+    {
+        uint32_t bandHeight = std::min(kTileSize, height - ty * kTileSize);
+        HashTileBand(accumulateRow, pixels + static_cast<size_t>(ty) * kTileSize * rowPitch, rowPitch, width, bandHeight, acc.data(), hashes + ty * columns);
+    }
+}
+
+uint64_t HashImage(const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height)
+{
+    thread_local std::vector<uint64_t> hashes;
+    hashes.resize(GetTileCount(width, height));
+    HashTiles(pixels, rowPitch, width, height, hashes.data());
+
+    uint64_t h = (static_cast<uint64_t>(width) << 32 | height) * kPrime64b;
+    for (uint64_t tileHash : hashes)
+        h = Avalanche((h ^ tileHash) * kPrime64a);
+    return h;
+}
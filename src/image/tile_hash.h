@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Square tiles used for change detection; the right and bottom edge tiles may be smaller
+static constexpr uint32_t kTileSize = 64;
+
+inline uint32_t GetTileColumns(uint32_t width) { return (width + kTileSize - 1) / kTileSize; }
+inline uint32_t GetTileRows(uint32_t height) { return (height + kTileSize - 1) / kTileSize; }
+inline uint32_t GetTileCount(uint32_t width, uint32_t height) { return GetTileColumns(width) * GetTileRows(height); }
+
+// 64-bit hash of every tile of a 4-byte-per-pixel image, in row-major tile order.
+// hashes must hold GetTileCount(width, height) entries. Not cryptographic; an xxHash3-style
+// multiply-accumulate that only needs 32x32->64 multiplies, so it vectorizes on SSE2/AVX2/NEON.
+void HashTiles(const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height, uint64_t* hashes);
+
+// Single hash over the whole image, same kernels
+uint64_t HashImage(const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height);
@@ -0,0 +1,266 @@
+#include "unpack.h"
+#include "simd.h"
+#include <cstring>
+
+uint16_t FloatToHalf(float value)
+{
+    // Round to nearest even, same as the F16C conversion
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half;
+    if (bits >= (127u + 16u) << 23)
+    {
+        // Overflow to infinity, NaN stays NaN
+        half = bits > (255u << 23) ? 0x7E00 : 0x7C00;
+    }
+    else if (bits < (113u << 23))
+    {
+        // Subnormal half, let the FPU do the rounding via a magic add
+        const uint32_t magicBits = 126u << 23;
+        float magic, f;
+        std::memcpy(&magic, &magicBits, 4);
+        std::memcpy(&f, &bits, 4);
+        f += magic;
+        std::memcpy(&bits, &f, 4);
+        half = static_cast<uint16_t>(bits - magicBits);
+    }
+    else
+    {
+        uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFF + mantissaOdd;
+        half = static_cast<uint16_t>(bits >> 13);
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+static void Rgb10A2ToBgra8Scalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t p;
+        std::memcpy(&p, src + i * 4, 4);
+        uint32_t a = p >> 30;
+        dst[i * 4 + 0] = static_cast<uint8_t>(p >> 22);
+        dst[i * 4 + 1] = static_cast<uint8_t>(p >> 12);
+        dst[i * 4 + 2] = static_cast<uint8_t>(p >> 2);
+        dst[i * 4 + 3] = static_cast<uint8_t>(a * 85);
+    }
+}
+
+static void Rgb10A2ToHalfScalar(const uint8_t* src, uint16_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t p;
+        std::memcpy(&p, src + i * 4, 4);
+        dst[i * 4 + 0] = FloatToHalf((p & 0x3FF) * (1.0f / 1023.0f));
+        dst[i * 4 + 1] = FloatToHalf(((p >> 10) & 0x3FF) * (1.0f / 1023.0f));
+        dst[i * 4 + 2] = FloatToHalf(((p >> 20) & 0x3FF) * (1.0f / 1023.0f));
+        dst[i * 4 + 3] = FloatToHalf((p >> 30) * (1.0f / 3.0f));
+    }
+}
+
+// 8-bit sources; red is byte 2 for BGRA, byte 0 for RGBA
+static void Rgba8ToHalfScalar(const uint8_t* src, uint16_t* dst, uint32_t count, bool bgra)
+{
+    uint32_t red = bgra ? 2 : 0;
+    uint32_t blue = bgra ? 0 : 2;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t* p = src + i * 4;
+        dst[i * 4 + 0] = FloatToHalf(p[red] * (1.0f / 255.0f));
+        dst[i * 4 + 1] = FloatToHalf(p[1] * (1.0f / 255.0f));
+        dst[i * 4 + 2] = FloatToHalf(p[blue] * (1.0f / 255.0f));
+        dst[i * 4 + 3] = FloatToHalf(p[3] * (1.0f / 255.0f));
+    }
+}
+
+static void SwapRedBlueScalar(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dst[i * 4 + 0] = src[i * 4 + 2];
+        dst[i * 4 + 1] = src[i * 4 + 1];
+        dst[i * 4 + 2] = src[i * 4 + 0];
+        dst[i * 4 + 3] = src[i * 4 + 3];
+    }
+}
+
+#if defined(OVD_SIMD_X86)
+
+// Top 8 bits of each 10-bit channel, 2-bit alpha replicated to 8 bits
+static inline __m128i Rgb10A2ToBgra8x4(__m128i p)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_and_si128(_mm_srli_epi32(p, 2), mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(p, 12), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(p, 22), mask);
+    __m128i a = _mm_srli_epi32(p, 30);
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 2));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 4));
+    return _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(a, 24)));
+}
+
+static void Rgb10A2ToBgra8Sse2(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), Rgb10A2ToBgra8x4(p));
+    }
+    Rgb10A2ToBgra8Scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+OVD_TARGET("avx2")
+static void Rgb10A2ToBgra8Avx2(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 2), mask);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 12), mask);
+        __m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 22), mask);
+        __m256i a = _mm256_srli_epi32(p, 30);
+        a = _mm256_or_si256(a, _mm256_slli_epi32(a, 2));
+        a = _mm256_or_si256(a, _mm256_slli_epi32(a, 4));
+        __m256i out = _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+                                      _mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(a, 24)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), out);
+    }
+    Rgb10A2ToBgra8Scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+// Converts 4 pixels held as one float vector per channel into interleaved RGBA halves
+OVD_TARGET("f16c")
+static inline void StoreHalfRgba4(__m128 r, __m128 g, __m128 b, __m128 a, uint16_t* dst)
+{
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 0), _mm_cvtps_ph(r, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4), _mm_cvtps_ph(g, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 8), _mm_cvtps_ph(b, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 12), _mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+}
+
+OVD_TARGET("f16c")
+static void Rgb10A2ToHalfF16c(const uint8_t* src, uint16_t* dst, uint32_t count)
+{
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+    const __m128 scale = _mm_set1_ps(1.0f / 1023.0f);
+    const __m128 alphaScale = _mm_set1_ps(1.0f / 3.0f);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        __m128 r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), scale);
+        __m128 g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 10), mask)), scale);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 20), mask)), scale);
+        __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 30)), alphaScale);
+        StoreHalfRgba4(r, g, b, a, dst + i * 4);
+    }
+    Rgb10A2ToHalfScalar(src + i * 4, dst + i * 4, count - i);
+}
+
+OVD_TARGET("f16c")
+static void Rgba8ToHalfF16c(const uint8_t* src, uint16_t* dst, uint32_t count, bool bgra)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    int redShift = bgra ? 16 : 0;
+    int blueShift = bgra ? 0 : 16;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        __m128 r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(p, _mm_cvtsi32_si128(redShift)), mask)), scale);
+        __m128 g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 8), mask)), scale);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(p, _mm_cvtsi32_si128(blueShift)), mask)), scale);
+        __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 24)), scale);
+        StoreHalfRgba4(r, g, b, a, dst + i * 4);
+    }
+    Rgba8ToHalfScalar(src + i * 4, dst + i * 4, count - i, bgra);
+}
+
+#endif // OVD_SIMD_X86
+
+#if defined(OVD_SIMD_NEON)
+
+static void Rgb10A2ToBgra8Neon(const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    const uint32x4_t mask = vdupq_n_u32(0xFF);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t p = vld1q_u32(reinterpret_cast<const uint32_t*>(src + i * 4));
+        uint32x4_t r = vandq_u32(vshrq_n_u32(p, 2), mask);
+        uint32x4_t g = vandq_u32(vshrq_n_u32(p, 12), mask);
+        uint32x4_t b = vandq_u32(vshrq_n_u32(p, 22), mask);
+        uint32x4_t a = vmulq_n_u32(vshrq_n_u32(p, 30), 85);
+        uint32x4_t out = vorrq_u32(vorrq_u32(b, vshlq_n_u32(g, 8)), vorrq_u32(vshlq_n_u32(r, 16), vshlq_n_u32(a, 24)));
+        vst1q_u32(reinterpret_cast<uint32_t*>(dst + i * 4), out);
+    }
+    Rgb10A2ToBgra8Scalar(src + i * 4, dst + i * 4, count - i);
+}
+
+#endif // OVD_SIMD_NEON
+
+std::vector<UnpackKernels> GetUnpackKernelVariants()
+{
+    std::vector<UnpackKernels> variants;
+    variants.push_back(UnpackKernels{ "scalar", Rgb10A2ToBgra8Scalar, Rgb10A2ToHalfScalar, Rgba8ToHalfScalar });
+#if defined(OVD_SIMD_X86)
+    // The half kernels only have an F16C version
+    bool f16c = CpuHasF16c();
+    variants.push_back(UnpackKernels{ f16c ? "sse2+f16c" : "sse2", Rgb10A2ToBgra8Sse2,
+                                      f16c ? Rgb10A2ToHalfF16c : Rgb10A2ToHalfScalar, f16c ? Rgba8ToHalfF16c : Rgba8ToHalfScalar });
+    if (CpuHasAvx2())
+    {
+        variants.push_back(UnpackKernels{ f16c ? "avx2+f16c" : "avx2", Rgb10A2ToBgra8Avx2,
+                                          f16c ? Rgb10A2ToHalfF16c : Rgb10A2ToHalfScalar, f16c ? Rgba8ToHalfF16c : Rgba8ToHalfScalar });
+    }
+#elif defined(OVD_SIMD_NEON)
+    variants.push_back(UnpackKernels{ "neon", Rgb10A2ToBgra8Neon, Rgb10A2ToHalfScalar, Rgba8ToHalfScalar });
+#endif
+    return variants;
+}
+
+static const UnpackKernels& GetUnpackKernels()
+{
+    static const UnpackKernels kernels = GetUnpackKernelVariants().back();
+    return kernels;
+}
+
+void UnpackRowToBgra8(SourceFormat format, const uint8_t* src, uint8_t* dst, uint32_t count)
+{
+    switch (format)
+    {
+        case SourceFormat::Bgra8:
+            std::memcpy(dst, src, static_cast<size_t>(count) * 4);
+            break;
+        case SourceFormat::Rgba8:
+            SwapRedBlueScalar(src, dst, count);
+            break;
+        case SourceFormat::Rgb10A2:
+            GetUnpackKernels().rgb10a2ToBgra8(src, dst, count);
+            break;
+    }
+}
+
+void UnpackRowToHalf(SourceFormat format, const uint8_t* src, uint16_t* dst, uint32_t count)
+{
+    switch (format)
+    {
+        case SourceFormat::Bgra8:
+        case SourceFormat::Rgba8:
+            GetUnpackKernels().rgba8ToHalf(src, dst, count, format == SourceFormat::Bgra8);
+            break;
+        case SourceFormat::Rgb10A2:
+            GetUnpackKernels().rgb10a2ToHalf(src, dst, count);
+            break;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Layouts the staging texture can hold, derived from the submitted DXGI format
+enum class SourceFormat : uint32_t {
+    Bgra8,   // B8G8R8A8 / B8G8R8X8
+    Rgba8,   // R8G8B8A8
+    Rgb10A2  // R10G10B10A2, packed little endian: R in bits 0-9, A in bits 30-31
+};
+
+// Unpacks count source pixels to 8-bit BGRA
+void UnpackRowToBgra8(SourceFormat format, const uint8_t* src, uint8_t* dst, uint32_t count);
+
+// Unpacks count source pixels to RGBA half floats in 0..1, keeping full 10-bit precision
+void UnpackRowToHalf(SourceFormat format, const uint8_t* src, uint16_t* dst, uint32_t count);
+
+uint16_t FloatToHalf(float value);
+
+// One implementation of the vectorized unpack kernels; Rgba8 to Bgra8 is a plain swap
+struct UnpackKernels {
+    const char* name;
+    void (*rgb10a2ToBgra8)(const uint8_t* src, uint8_t* dst, uint32_t count);
+    void (*rgb10a2ToHalf)(const uint8_t* src, uint16_t* dst, uint32_t count);
+    void (*rgba8ToHalf)(const uint8_t* src, uint16_t* dst, uint32_t count, bool bgra);
+};
+
+// Every implementation this CPU can run, scalar reference first, for checks and benchmarks.
+// The Unpack functions above use the last one.
+std::vector<UnpackKernels> GetUnpackKernelVariants();
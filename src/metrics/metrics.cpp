@@ -0,0 +1,156 @@
+#include "metrics.h"
+#include <bit>
+#include <cstdio>
+#include <algorithm>
+
+namespace metrics {
+
+uint32_t GetThreadShard()
+{
+    static std::atomic<uint32_t> nextShard{0};
+    thread_local uint32_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+uint64_t Counter::Get() const
+{
+    uint64_t total = 0;
+    for (const auto& cell : m_cells)
+        total += cell.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void Histogram::Record(uint64_t value)
+{
+    uint32_t bucket = std::min<uint32_t>(static_cast<uint32_t>(std::bit_width(value)), kBuckets - 1);
+    Cell& cell = m_cells[GetThreadShard()];
+    cell.sum.fetch_add(value, std::memory_order_relaxed);
+    cell.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const
+{
+    Snapshot snapshot{};
+    for (const auto& cell : m_cells)
+    {
+        snapshot.sum += cell.sum.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < kBuckets; i++)
+        {
+            uint64_t bucket = cell.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += bucket;
+            snapshot.count += bucket;
+        }
+    }
+    return snapshot;
+}
+
+uint64_t Histogram::Snapshot::GetQuantile(double quantile) const
+{
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(quantile * (count - 1));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBuckets; i++)
+    {
+        seen += buckets[i];
+        if (seen > rank)
+            return i == 0 ? 0 : (uint64_t{1} << i) - 1;
+    }
+    return UINT64_MAX;
+}
+
+Registry& Registry::Get()
+{
+    static Registry registry;
+    return registry;
+}
+
+template <typename T>
+T& Registry::Find(std::deque<Entry<T>>& entries, std::string_view name)
+{
+    for (auto& entry : entries)
+    {
+        if (entry.name == name)
+            return entry.metric;
+    }
+    return entries.emplace_back(std::string(name)).metric;
+}
+
+Counter& Registry::GetCounter(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return Find(m_counters, name);
+}
+
+Gauge& Registry::GetGauge(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return Find(m_gauges, name);
+}
+
+Histogram& Registry::GetHistogram(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return Find(m_histograms, name);
+}
+
+static void Append(std::string& out, const char* format, auto... args)
+{
+    char line[256];
+    int length = std::snprintf(line, sizeof(line), format, args...);
+    if (length > 0)
+        out.append(line, std::min<size_t>(static_cast<size_t>(length), sizeof(line) - 1));
+}
+
+std::string Registry::FormatText() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::string out;
+    for (const auto& entry : m_counters)
+        Append(out, "%s %llu\n", entry.name.c_str(), static_cast<unsigned long long>(entry.metric.Get()));
+    for (const auto& entry : m_gauges)
+        Append(out, "%s %lld\n", entry.name.c_str(), static_cast<long long>(entry.metric.Get()));
+    for (const auto& entry : m_histograms)
+    {
+        Histogram::Snapshot snapshot = entry.metric.GetSnapshot();
+        Append(out, "%s count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu\n", entry.name.c_str(),
+               static_cast<unsigned long long>(snapshot.count),
+               snapshot.count ? static_cast<double>(snapshot.sum) / snapshot.count : 0.0,
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.5)),
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.9)),
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.99)));
+    }
+    return out;
+}
+
+std::string Registry::FormatJson() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::string out = "{\"counters\":{";
+    for (size_t i = 0; i < m_counters.size(); i++)
+        Append(out, "%s\"%s\":%llu", i ? "," : "", m_counters[i].name.c_str(), static_cast<unsigned long long>(m_counters[i].metric.Get()));
+
+    out += "},\"gauges\":{";
+    for (size_t i = 0; i < m_gauges.size(); i++)
+        Append(out, "%s\"%s\":%lld", i ? "," : "", m_gauges[i].name.c_str(), static_cast<long long>(m_gauges[i].metric.Get()));
+
+    out += "},\"histograms\":{";
+    for (size_t i = 0; i < m_histograms.size(); i++)
+    {
+        Histogram::Snapshot snapshot = m_histograms[i].metric.GetSnapshot();
+        Append(out, "%s\"%s\":{\"count\":%llu,\"sum\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"buckets\":[",
+               i ? "," : "", m_histograms[i].name.c_str(),
+               static_cast<unsigned long long>(snapshot.count), static_cast<unsigned long long>(snapshot.sum),
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.5)),
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.9)),
+               static_cast<unsigned long long>(snapshot.GetQuantile(0.99)));
+        for (uint32_t b = 0; b < Histogram::kBuckets; b++)
+            Append(out, "%s%llu", b ? "," : "", static_cast<unsigned long long>(snapshot.buckets[b]));
+        out += "]}";
+    }
+    out += "}}";
+    return out;
+}
+
+} // namespace metrics
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace metrics {
+
+// Recording threads are spread over this many cache-line sized cells, so concurrent
+// writers never contend; readers sum the cells when taking a snapshot.
+static constexpr uint32_t kShards = 16;
+
+// Shard of the calling thread, assigned round robin on first use
+uint32_t GetThreadShard();
+
+class Counter
+{
+public:
+    void Add(uint64_t value = 1) { m_cells[GetThreadShard()].value.fetch_add(value, std::memory_order_relaxed); }
+    uint64_t Get() const;
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    Cell m_cells[kShards];
+};
+
+// Last value wins, for levels like queue depths
+class Gauge
+{
+public:
+    void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    int64_t Get() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<int64_t> m_value{0};
+};
+
+// Power-of-two buckets: bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i).
+// The last bucket takes everything larger.
+class Histogram
+{
+public:
+    static constexpr uint32_t kBuckets = 32;
+
+    struct Snapshot {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t buckets[kBuckets];
+
+        // Upper bound of the bucket holding the given quantile (0..1)
+        uint64_t GetQuantile(double quantile) const;
+    };
+
+    void Record(uint64_t value);
+    Snapshot GetSnapshot() const;
+
+private:
+    // The count is the bucket total, so a record is two relaxed adds
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> buckets[kBuckets] = {};
+    };
+    Cell m_cells[kShards];
+};
+
+// Process-wide named metrics. Lookups take a lock and belong in constructors or setup code;
+// the returned references stay valid for the life of the process and are lock-free to record.
+class Registry
+{
+public:
+    static Registry& Get();
+
+    Counter& GetCounter(std::string_view name);
+    Gauge& GetGauge(std::string_view name);
+    Histogram& GetHistogram(std::string_view name);
+
+    // One metric per line: "name value", histograms with count, mean and quantiles
+    std::string FormatText() const;
+    // {"counters": {...}, "gauges": {...}, "histograms": {"name": {"count", "sum", "p50", "p90", "p99", "buckets"}}}
+    std::string FormatJson() const;
+
+private:
+    template <typename T>
+    struct Entry {
+        std::string name;
+        T metric;
+    };
+
+    template <typename T>
+    static T& Find(std::deque<Entry<T>>& entries, std::string_view name);
+
+    mutable std::mutex m_mtx;
+    // deque keeps addresses stable as metrics are added
+    std::deque<Entry<Counter>> m_counters;
+    std::deque<Entry<Gauge>> m_gauges;
+    std::deque<Entry<Histogram>> m_histograms;
+};
+
+// Records the scope's duration in microseconds
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : m_histogram(histogram)
+        , m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        m_histogram.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count()));
+    }
+
+private:
+    Histogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace metrics
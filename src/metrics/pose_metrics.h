@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include "metrics.h"
+
+// Pose health of one tracked device, recorded by its pose update thread
+class PoseMetrics
+{
+public:
+    explicit PoseMetrics(const std::string& serialNumber)
+        : m_queueDepth(metrics::Registry::Get().GetGauge("pose." + serialNumber + ".queue_depth"))
+        , m_age(metrics::Registry::Get().GetGauge("pose." + serialNumber + ".age_us"))
+        , m_received(metrics::Registry::Get().GetCounter("pose.received"))
+        , m_lastPose(std::chrono::steady_clock::now())
+    {
+    }
+
+    // Poses still queued for the device when it polls
+    void RecordQueueDepth(size_t depth) { m_queueDepth.Set(static_cast<int64_t>(depth)); }
+    void RecordPose() { m_lastPose = std::chrono::steady_clock::now(); m_received.Add(); }
+    // How long the pose reported to SteamVR has gone without a client update
+    void RecordAge()
+    {
+        m_age.Set(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_lastPose).count());
+    }
+
+private:
+    metrics::Gauge& m_queueDepth;
+    metrics::Gauge& m_age;
+    metrics::Counter& m_received;
+    std::chrono::steady_clock::time_point m_lastPose;
+};
@@ -6,6 +6,7 @@
 #include <optional>
 #include <memory>
 #include <atomic>
+#include <stop_token>
 
 namespace mpsc {
 
@@ -19,7 +20,7 @@ template<typename T>
 struct Channel {
     std::queue<T> queue;
     std::mutex mtx;
-    std::condition_variable cv;
+    std::condition_variable_any cv;
     std::atomic<size_t> sender_count{0};
     std::atomic<bool> receiver_alive{true};
 };
@@ -137,6 +138,24 @@ public:
         return value;
     }
 
+    // Blocks until value available. Returns nullopt if all senders are gone or stop is requested.
+    std::optional<T> recv(std::stop_token st) {
+        if (!m_channel) return std::nullopt;
+
+        std::unique_lock<std::mutex> lock(m_channel->mtx);
+        m_channel->cv.wait(lock, st, [this] {
+            return !m_channel->queue.empty() || m_channel->sender_count == 0;
+        });
+
+        if (m_channel->queue.empty()) {
+            return std::nullopt;
+        }
+
+        T value = std::move(m_channel->queue.front());
+        m_channel->queue.pop();
+        return value;
+    }
+
     // Non-blocking. Returns nullopt if no value available.
     std::optional<T> try_recv() {
         if (!m_channel) return std::nullopt;
@@ -151,6 +170,29 @@ public:
         return value;
     }
 
+    // Non-blocking. Discards everything queued but the newest value, which it returns; nullopt
+    // if no value available. For samples where only the latest matters, like poses.
+    std::optional<T> try_recv_latest() {
+        if (!m_channel) return std::nullopt;
+
+        std::lock_guard<std::mutex> lock(m_channel->mtx);
+        if (m_channel->queue.empty()) {
+            return std::nullopt;
+        }
+
+        T value = std::move(m_channel->queue.back());
+        m_channel->queue = {};
+        return value;
+    }
+
+    // Values waiting to be received
+    size_t size() const {
+        if (!m_channel) return 0;
+
+        std::lock_guard<std::mutex> lock(m_channel->mtx);
+        return m_channel->queue.size();
+    }
+
 private:
     std::shared_ptr<Channel<T>> m_channel;
 };
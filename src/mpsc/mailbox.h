@@ -0,0 +1,70 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <stop_token>
+
+namespace mpsc {
+
+// Bounded queue for latest-value-wins producers. Pushing into a full mailbox
+// evicts the oldest entry instead of blocking, so a slow consumer can never
+// stall the producer.
+template<typename T>
+class Mailbox {
+public:
+    explicit Mailbox(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+
+    // Non-copyable
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    // Returns the number of entries evicted to make room
+    size_t push(T value) {
+        size_t evicted = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            while (m_queue.size() >= m_capacity) {
+                m_queue.pop_front();
+                evicted++;
+            }
+            m_queue.push_back(std::move(value));
+        }
+        m_cv.notify_one();
+        return evicted;
+    }
+
+    // Blocks until a value is available. Returns nullopt once stop is requested.
+    std::optional<T> recv(std::stop_token st) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (!m_cv.wait(lock, st, [this] { return !m_queue.empty(); })) {
+            return std::nullopt;
+        }
+
+        T value = std::move(m_queue.front());
+        m_queue.pop_front();
+        return value;
+    }
+
+    // Drops everything queued. Returns the number of entries discarded.
+    size_t clear() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        size_t count = m_queue.size();
+        m_queue.clear();
+        return count;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_queue.size();
+    }
+
+private:
+    std::deque<T> m_queue;
+    std::mutex m_mtx;
+    std::condition_variable_any m_cv;
+    size_t m_capacity;
+};
+
+} // namespace mpsc
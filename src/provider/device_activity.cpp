@@ -0,0 +1,39 @@
+#include "device_activity.h"
+#include "../control/control.h"
+
+static control::Setting& s_lazy = control::Registry::Get().AddBool("devices.lazy", true, "Register controllers and trackers when the client first uses them (read at startup)");
+static control::Setting& s_idleTimeout = control::Registry::Get().AddFloat("devices.idle_timeout_s", 5.0, 0.0, 3600.0, "Park a controller or tracker after this long without a pose, 0 never");
+static metrics::Counter& s_parks = metrics::Registry::Get().GetCounter("devices.parks");
+
+bool IsLazyDeviceActivation()
+{
+    return s_lazy.GetBool();
+}
+
+DeviceIdleTimer::DeviceIdleTimer(const std::string& serialNumber)
+    : m_parkedGauge(metrics::Registry::Get().GetGauge("pose." + serialNumber + ".parked"))
+    , m_lastPose(std::chrono::steady_clock::now())
+{
+}
+
+void DeviceIdleTimer::RecordPose()
+{
+    m_lastPose = std::chrono::steady_clock::now();
+    if (m_parked)
+    {
+        m_parked = false;
+        m_parkedGauge.Set(0);
+    }
+}
+
+bool DeviceIdleTimer::ShouldPark()
+{
+    double timeout = s_idleTimeout.Get();
+    if (m_parked || timeout <= 0.0 || std::chrono::steady_clock::now() - m_lastPose < std::chrono::duration<double>(timeout))
+        return false;
+
+    m_parked = true;
+    m_parkedGauge.Set(1);
+    s_parks.Add();
+    return true;
+}
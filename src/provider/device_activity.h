@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "../metrics/metrics.h"
+
+// Tracked devices besides the HMD, as bits of DeviceSetup::devices and SocketManager::GetRequestedDevices.
+// Trackers follow TrackerRole order from Waist.
+enum class DeviceRole : uint32_t
+{
+    LeftHand,
+    RightHand,
+    Waist,
+    Chest,
+    LeftFoot,
+    RightFoot,
+    LeftKnee,
+    RightKnee,
+    LeftElbow,
+    RightElbow,
+    LeftShoulder,
+    RightShoulder,
+    Count
+};
+
+constexpr uint32_t DeviceBit(DeviceRole role) { return 1u << static_cast<uint32_t>(role); }
+constexpr uint32_t kAllDevices = (1u << static_cast<uint32_t>(DeviceRole::Count)) - 1;
+
+// Registers devices only once the client uses them (devices.lazy)
+bool IsLazyDeviceActivation();
+
+// Tells a pose thread when to park: after devices.idle_timeout_s without a client pose the
+// device is reported out of range once, then the thread blocks until the next pose.
+class DeviceIdleTimer
+{
+public:
+    explicit DeviceIdleTimer(const std::string& serialNumber);
+
+    void RecordPose();
+    // True once per idle period, when the device should park
+    bool ShouldPark();
+    bool IsParked() const { return m_parked; }
+
+private:
+    metrics::Gauge& m_parkedGauge;
+    std::chrono::steady_clock::time_point m_lastPose;
+    bool m_parked = false;
+};
@@ -3,13 +3,26 @@
 #include "../controller/controller_device_driver.h"
 #include "../tracker/tracker_device_driver.h"
 #include "../mpsc/channel.h"
+#include "../metrics/metrics.h"
+#include "../frame/frame_metadata.h"
+#include <algorithm>
+#include <bit>
+
+#ifdef _WIN32
+#include "../readback/d3d11_texture_device.h"
+#else
+#include "../readback/synthetic_texture_device.h"
+#endif
+
+static metrics::Gauge& s_registeredDevices = metrics::Registry::Get().GetGauge("devices.registered");
+static metrics::Counter& s_hapticsForwarded = metrics::Registry::Get().GetCounter("haptics.forwarded");
 
 vr::EVRInitError AIVRDeviceProvider::Init(vr::IVRDriverContext* pDriverContext)
 {
     VR_INIT_SERVER_DRIVER_CONTEXT(pDriverContext);
 
     // Create channel for head pose (HMD)
-    auto [headPoseTx, headPoseRx] = mpsc::channel<Pose>();
+    auto [headPoseTx, headPoseRx] = mpsc::channel<PoseSample>();
 
     // Create channels for controller inputs
     auto [leftControllerInputTx, leftControllerInputRx] = mpsc::channel<ControllerInput>();
@@ -53,7 +66,13 @@ vr::EVRInitError AIVRDeviceProvider::Init(vr::IVRDriverContext* pDriverContext)
     );
 
     // Create HMD with head pose receiver
-    m_pHmd = std::make_unique<Driver>(std::move(headPoseRx), m_pSocketManager.get());
+    // Headless builds render into plain memory, see SyntheticTextureDevice
+#ifdef _WIN32
+    auto textureDevice = std::make_unique<D3D11TextureDevice>();
+#else
+    auto textureDevice = std::make_unique<SyntheticTextureDevice>();
+#endif
+    m_pHmd = std::make_unique<Driver>(std::move(headPoseRx), m_pSocketManager.get(), std::move(textureDevice));
 
     if (!vr::VRServerDriverHost()->TrackedDeviceAdded(
             m_pHmd->GetSerialNumber(),
@@ -63,35 +82,20 @@ vr::EVRInitError AIVRDeviceProvider::Init(vr::IVRDriverContext* pDriverContext)
         return vr::VRInitError_Driver_Unknown;
     }
 
-    // Add left controller
+    // With devices.lazy, controllers and trackers are only registered once the client uses them
+    // (see RunFrame), so a head-only session never starts their pose threads.
     m_pLeftController = std::make_unique<ControllerDriver>(
         vr::TrackedControllerRole_LeftHand,
         std::move(leftControllerInputRx),
         std::move(leftHandPoseRx)
     );
-    if (!vr::VRServerDriverHost()->TrackedDeviceAdded(
-            m_pLeftController->GetSerialNumber(),
-            vr::TrackedDeviceClass_Controller,
-            m_pLeftController.get()))
-    {
-        return vr::VRInitError_Driver_Unknown;
-    }
-
-    // Add right controller
     m_pRightController = std::make_unique<ControllerDriver>(
         vr::TrackedControllerRole_RightHand,
         std::move(rightControllerInputRx),
         std::move(rightHandPoseRx)
     );
-    if (!vr::VRServerDriverHost()->TrackedDeviceAdded(
-            m_pRightController->GetSerialNumber(),
-            vr::TrackedDeviceClass_Controller,
-            m_pRightController.get()))
-    {
-        return vr::VRInitError_Driver_Unknown;
-    }
 
-    // Add body trackers
+    // Body trackers
     struct TrackerInit { TrackerRole role; mpsc::Receiver<Pose> receiver; };
     TrackerInit trackerInits[] = {
         { TrackerRole::Waist, std::move(waistRx) },
@@ -112,12 +116,16 @@ vr::EVRInitError AIVRDeviceProvider::Init(vr::IVRDriverContext* pDriverContext)
             trackerInits[i].role,
             std::move(trackerInits[i].receiver)
         );
-        if (!vr::VRServerDriverHost()->TrackedDeviceAdded(
-                m_trackers[i]->GetSerialNumber(),
-                vr::TrackedDeviceClass_GenericTracker,
-                m_trackers[i].get()))
+    }
+
+    if (!IsLazyDeviceActivation())
+    {
+        for (uint32_t role = 0; role < static_cast<uint32_t>(DeviceRole::Count); ++role)
         {
-            return vr::VRInitError_Driver_Unknown;
+            if (!AddDevice(static_cast<DeviceRole>(role)))
+            {
+                return vr::VRInitError_Driver_Unknown;
+            }
         }
     }
 
@@ -127,8 +135,36 @@ vr::EVRInitError AIVRDeviceProvider::Init(vr::IVRDriverContext* pDriverContext)
     return vr::VRInitError_None;
 }
 
+bool AIVRDeviceProvider::AddDevice(DeviceRole role)
+{
+    // Never retried: SteamVR has no way to remove a device again, so one attempt per session
+    m_addedDevices |= DeviceBit(role);
+    s_registeredDevices.Set(std::popcount(m_addedDevices));
+
+    if (role == DeviceRole::LeftHand || role == DeviceRole::RightHand)
+    {
+        ControllerDriver* controller = role == DeviceRole::LeftHand ? m_pLeftController.get() : m_pRightController.get();
+        return vr::VRServerDriverHost()->TrackedDeviceAdded(
+            controller->GetSerialNumber(),
+            vr::TrackedDeviceClass_Controller,
+            controller);
+    }
+
+    TrackerDriver* tracker = m_trackers[static_cast<uint32_t>(role) - static_cast<uint32_t>(DeviceRole::Waist)].get();
+    return vr::VRServerDriverHost()->TrackedDeviceAdded(
+        tracker->GetSerialNumber(),
+        vr::TrackedDeviceClass_GenericTracker,
+        tracker);
+}
+
 void AIVRDeviceProvider::Cleanup()
 {
+    // Stop the HMD frame sender before the socket manager it sends through goes away
+    if (m_pHmd)
+    {
+        m_pHmd->StopFrameSender();
+    }
+
     // Reset socket manager first - this closes channels and stops threads
     m_pSocketManager.reset();
 
@@ -150,10 +186,26 @@ const char* const* AIVRDeviceProvider::GetInterfaceVersions()
 
 void AIVRDeviceProvider::RunFrame()
 {
+    // Register devices the client started sending or declared since the last frame
+    if (m_pSocketManager)
+    {
+        uint32_t pending = m_pSocketManager->GetRequestedDevices() & ~m_addedDevices;
+        while (pending != 0)
+        {
+            DeviceRole role = static_cast<DeviceRole>(std::countr_zero(pending));
+            pending &= pending - 1;
+            AddDevice(role);
+        }
+    }
+
     // Poll events only - pose/input updates happen via channel threads
     vr::VREvent_t event;
     while (vr::VRServerDriverHost()->PollNextEvent(&event, sizeof(event)))
     {
+        if (event.eventType == vr::VREvent_Input_HapticVibration)
+        {
+            ForwardHaptic(event);
+        }
         if (m_pHmd)
         {
             m_pHmd->ProcessEvent(event);
@@ -161,6 +213,33 @@ void AIVRDeviceProvider::RunFrame()
     }
 }
 
+void AIVRDeviceProvider::ForwardHaptic(const vr::VREvent_t& event)
+{
+    const vr::VREvent_HapticVibration_t& vibration = event.data.hapticVibration;
+    if (!m_pSocketManager || vibration.componentHandle == vr::k_ulInvalidInputComponentHandle)
+        return;
+
+    DeviceRole role;
+    if (m_pLeftController && vibration.componentHandle == m_pLeftController->GetHapticHandle())
+        role = DeviceRole::LeftHand;
+    else if (m_pRightController && vibration.componentHandle == m_pRightController->GetHapticHandle())
+        role = DeviceRole::RightHand;
+    else
+        return;
+
+    // Stamp it with when the game asked, not when RunFrame got to it
+    uint64_t ageUs = static_cast<uint64_t>(std::max(event.eventAgeSeconds, 0.0f) * 1e6f);
+    Haptic haptic {
+        static_cast<uint32_t>(role),
+        vibration.fDurationSeconds,
+        vibration.fFrequency,
+        vibration.fAmplitude,
+        GetDriverTimeUs() - ageUs
+    };
+    if (m_pSocketManager->SendHaptic(haptic))
+        s_hapticsForwarded.Add();
+}
+
 bool AIVRDeviceProvider::ShouldBlockStandbyMode()
 {
     return false;
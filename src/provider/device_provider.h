@@ -7,6 +7,7 @@
 #include "../controller/controller_device_driver.h"
 #include "../tracker/tracker_device_driver.h"
 #include "../socket/socket_manager.h"
+#include "../provider/device_activity.h"
 
 class AIVRDeviceProvider : public vr::IServerTrackedDeviceProvider
 {
@@ -20,9 +21,16 @@ public:
     void LeaveStandby() override;
 
 private:
+    // Registers one controller or tracker with SteamVR
+    bool AddDevice(DeviceRole role);
+    // Hands a game's vibration request for one of our controllers to the client
+    void ForwardHaptic(const vr::VREvent_t& event);
+
     std::unique_ptr<SocketManager> m_pSocketManager;
     std::unique_ptr<Driver> m_pHmd;
     std::unique_ptr<ControllerDriver> m_pLeftController;
     std::unique_ptr<ControllerDriver> m_pRightController;
     std::array<std::unique_ptr<TrackerDriver>, 10> m_trackers;
+    // DeviceBit mask of devices handed to TrackedDeviceAdded, RunFrame thread only
+    uint32_t m_addedDevices = 0;
 };
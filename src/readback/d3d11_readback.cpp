@@ -0,0 +1,236 @@
+#include "d3d11_readback.h"
+
+// Maps a submitted texture format to the layout the staging copy holds. Anything else
+// (float swapchains etc.) is not read back.
+static bool GetSourceFormat(DXGI_FORMAT format, SourceFormat& source)
+{
+    switch (format)
+    {
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            source = SourceFormat::Bgra8;
+            return true;
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            source = SourceFormat::Rgba8;
+            return true;
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            source = SourceFormat::Rgb10A2;
+            return true;
+        default:
+            return false;
+    }
+}
+
+D3D11Readback::D3D11Readback(ID3D11Device* device, ID3D11DeviceContext* context, uint32_t depth)
+    : m_pDevice(device)
+    , m_pContext(context)
+{
+    for (auto& layerRings : m_rings)
+    {
+        for (auto& ring : layerRings)
+            ring.slots.resize(depth > 0 ? depth : 1);
+    }
+}
+
+D3D11Readback::~D3D11Readback()
+{
+    for (auto& layerRings : m_rings)
+    {
+        for (auto& ring : layerRings)
+        {
+            for (auto& slot : ring.slots)
+            {
+                if (slot.mapped)
+                    m_pContext->Unmap(slot.staging.Get(), 0);
+            }
+        }
+    }
+}
+
+ID3D11Texture2D* D3D11Readback::OpenTexture(uint64_t handle)
+{
+    for (const auto& opened : m_openedTextures)
+    {
+        if (opened.handle == handle)
+            return opened.texture.Get();
+    }
+
+    ComPtr<ID3D11Texture2D> texture;
+    HRESULT hr = m_pDevice->OpenSharedResource(
+        reinterpret_cast<HANDLE>(static_cast<uintptr_t>(handle)),
+        __uuidof(ID3D11Texture2D),
+        reinterpret_cast<void**>(texture.GetAddressOf()));
+
+    if (FAILED(hr) || !texture)
+        return nullptr;
+
+    if (m_openedTextures.size() >= kMaxOpenedTextures)
+        m_openedTextures.erase(m_openedTextures.begin());
+    m_openedTextures.push_back(OpenedTexture{ handle, texture });
+    return texture.Get();
+}
+
+void D3D11Readback::ForgetTexture(uint64_t handle)
+{
+    std::erase_if(m_openedTextures, [handle](const OpenedTexture& opened) { return opened.handle == handle; });
+}
+
+bool D3D11Readback::Submit(const ReadbackRequest& request)
+{
+    ID3D11Texture2D* texture = OpenTexture(request.texture);
+    if (!texture)
+        return false;
+
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+
+    SourceFormat sourceFormat;
+    if (!GetSourceFormat(desc.Format, sourceFormat))
+        return false;
+
+    EyeRing& ring = GetRing(request.eye, request.layer);
+    if (ring.pending == ring.slots.size())
+    {
+        if (ring.acquired)
+            return false;
+        DropOldest(ring);
+    }
+
+    PixelRect region = GetReadbackRegion(request, desc.Width, desc.Height);
+    Slot& slot = ring.slots[ring.next];
+
+    // Staging textures match the copied region, not the whole swapchain image
+    if (!slot.staging || slot.width != region.width || slot.height != region.height || slot.format != desc.Format)
+    {
+        slot.staging.Reset();
+
+        D3D11_TEXTURE2D_DESC stagingDesc = {};
+        stagingDesc.Width = region.width;
+        stagingDesc.Height = region.height;
+        stagingDesc.MipLevels = 1;
+        stagingDesc.ArraySize = 1;
+        if (desc.Format == DXGI_FORMAT_R10G10B10A2_TYPELESS)
+            stagingDesc.Format = DXGI_FORMAT_R10G10B10A2_UNORM;
+        else if (desc.Format == DXGI_FORMAT_R8G8B8A8_TYPELESS)
+            stagingDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        else
+            stagingDesc.Format = desc.Format;
+        stagingDesc.SampleDesc.Count = 1;
+        stagingDesc.Usage = D3D11_USAGE_STAGING;
+        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        if (FAILED(m_pDevice->CreateTexture2D(&stagingDesc, nullptr, &slot.staging)))
+            return false;
+
+        slot.width = region.width;
+        slot.height = region.height;
+        slot.format = desc.Format;
+    }
+
+    D3D11_BOX box { region.x, region.y, 0, region.x + region.width, region.y + region.height, 1 };
+    {
+        OVD_TRACE_SCOPE_ARG("readback.copy", "frame", request.frameIndex);
+        m_pContext->CopySubresourceRegion(slot.staging.Get(), 0, 0, 0, 0, texture, 0, &box);
+    }
+
+    slot.sourceFormat = sourceFormat;
+    slot.frameIndex = request.frameIndex;
+    slot.texture = request.texture;
+    slot.pending = true;
+    ring.next = (ring.next + 1) % ring.slots.size();
+    ring.pending++;
+    m_submitted++;
+    return true;
+}
+
+bool D3D11Readback::MapSlot(Slot& slot, bool wait, D3D11_MAPPED_SUBRESOURCE& mapped)
+{
+    if (slot.mapped)
+    {
+        mapped = slot.mapping;
+        return true;
+    }
+
+    OVD_TRACE_SCOPE_ARG("readback.map", "frame", slot.frameIndex);
+    // DO_NOT_WAIT fails with DXGI_ERROR_WAS_STILL_DRAWING while the copy is in flight
+    HRESULT hr = m_pContext->Map(slot.staging.Get(), 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (FAILED(hr))
+        return false;
+
+    slot.mapped = true;
+    slot.mapping = mapped;
+    return true;
+}
+
+void D3D11Readback::DropOldest(EyeRing& ring)
+{
+    Slot& slot = ring.slots[ring.oldest];
+    if (slot.mapped)
+    {
+        m_pContext->Unmap(slot.staging.Get(), 0);
+        slot.mapped = false;
+    }
+    slot.pending = false;
+    ring.oldest = (ring.oldest + 1) % ring.slots.size();
+    ring.pending--;
+    m_dropped++;
+}
+
+std::optional<ReadbackResult> D3D11Readback::Acquire(uint32_t eye, uint32_t layer)
+{
+    EyeRing& ring = GetRing(eye, layer);
+    if (ring.pending == 0 || ring.acquired)
+        return std::nullopt;
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    bool wait = ring.pending == ring.slots.size();
+    if (!MapSlot(ring.slots[ring.oldest], wait, mapped))
+        return std::nullopt;
+
+    // Copies finish in order; if a newer one is done too, the oldest is already stale
+    while (ring.pending > 1 && MapSlot(ring.slots[(ring.oldest + 1) % ring.slots.size()], false, mapped))
+    {
+        DropOldest(ring);
+    }
+
+    const Slot& slot = ring.slots[ring.oldest];
+    ring.acquired = true;
+    return ReadbackResult{
+        static_cast<const uint8_t*>(slot.mapping.pData),
+        slot.mapping.RowPitch,
+        slot.width,
+        slot.height,
+        slot.sourceFormat,
+        eye & 1,
+        slot.frameIndex,
+        slot.texture
+    };
+}
+
+void D3D11Readback::Release(uint32_t eye, uint32_t layer)
+{
+    EyeRing& ring = GetRing(eye, layer);
+    if (!ring.acquired)
+        return;
+
+    Slot& slot = ring.slots[ring.oldest];
+    m_pContext->Unmap(slot.staging.Get(), 0);
+    slot.mapped = false;
+    slot.pending = false;
+    ring.oldest = (ring.oldest + 1) % ring.slots.size();
+    ring.pending--;
+    ring.acquired = false;
+    m_completed++;
+}
+
+ReadbackStats D3D11Readback::GetStats() const
+{
+    return ReadbackStats{ m_submitted.load(), m_completed.load(), m_dropped.load() };
+}
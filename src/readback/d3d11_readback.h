@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include "readback_backend.h"
+#include "../trace/trace.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Readback through per-eye, per-layer rings of D3D11 staging textures. Only the bounded region is
+// copied (CopySubresourceRegion) and each staging texture is sized to that region.
+class D3D11Readback : public ReadbackBackend
+{
+public:
+    D3D11Readback(ID3D11Device* device, ID3D11DeviceContext* context, uint32_t depth);
+    ~D3D11Readback() override;
+
+    bool Submit(const ReadbackRequest& request) override;
+    std::optional<ReadbackResult> Acquire(uint32_t eye, uint32_t layer = 0) override;
+    void Release(uint32_t eye, uint32_t layer = 0) override;
+    void ForgetTexture(uint64_t handle) override;
+    ReadbackStats GetStats() const override;
+
+private:
+    struct Slot {
+        ComPtr<ID3D11Texture2D> staging;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        SourceFormat sourceFormat = SourceFormat::Bgra8;
+        uint64_t frameIndex = 0;
+        uint64_t texture = 0;
+        bool pending = false;
+        bool mapped = false;
+        D3D11_MAPPED_SUBRESOURCE mapping{};
+    };
+
+    struct EyeRing {
+        std::vector<Slot> slots;
+        uint32_t next = 0;     // Slot the next copy goes to
+        uint32_t oldest = 0;   // Oldest pending copy
+        uint32_t pending = 0;
+        bool acquired = false;
+    };
+
+    struct OpenedTexture {
+        uint64_t handle;
+        ComPtr<ID3D11Texture2D> texture;
+    };
+
+    ID3D11Texture2D* OpenTexture(uint64_t handle);
+    bool MapSlot(Slot& slot, bool wait, D3D11_MAPPED_SUBRESOURCE& mapped);
+    void DropOldest(EyeRing& ring);
+
+    // Enough for the three textures of each eye's swapchain, for every layer
+    static constexpr size_t kMaxOpenedTextures = 3 * 2 * kMaxReadbackLayers;
+
+    ComPtr<ID3D11Device> m_pDevice;
+    ComPtr<ID3D11DeviceContext> m_pContext;
+    EyeRing& GetRing(uint32_t eye, uint32_t layer) { return m_rings[std::min(layer, kMaxReadbackLayers - 1)][eye & 1]; }
+
+    EyeRing m_rings[kMaxReadbackLayers][2];
+
+    // Swapchains cycle through a handful of shared textures, so keep them open until destroyed
+    std::vector<OpenedTexture> m_openedTextures;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_completed{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
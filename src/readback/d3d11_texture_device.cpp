@@ -0,0 +1,94 @@
+#include "d3d11_texture_device.h"
+#include "d3d11_readback.h"
+#include <algorithm>
+
+D3D11TextureDevice::D3D11TextureDevice()
+{
+    D3D_FEATURE_LEVEL featureLevel;
+    UINT createDeviceFlags = 0;
+
+#ifdef _DEBUG
+    createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    HRESULT hr = D3D11CreateDevice(
+        nullptr,
+        D3D_DRIVER_TYPE_HARDWARE,
+        nullptr,
+        createDeviceFlags,
+        nullptr,
+        0,
+        D3D11_SDK_VERSION,
+        &m_pDevice,
+        &featureLevel,
+        &m_pContext);
+
+    if (FAILED(hr))
+    {
+        m_pDevice.Reset();
+        m_pContext.Reset();
+    }
+}
+
+D3D11TextureDevice::~D3D11TextureDevice()
+{
+    m_textures.clear();
+    m_pContext.Reset();
+    m_pDevice.Reset();
+}
+
+bool D3D11TextureDevice::CreateSwapTextures(const SwapTextureDesc& swapDesc, uint64_t (&handles)[kSwapTextureCount])
+{
+    if (!m_pDevice)
+        return false;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = swapDesc.width;
+    desc.Height = swapDesc.height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = static_cast<DXGI_FORMAT>(swapDesc.format);
+    desc.SampleDesc.Count = swapDesc.sampleCount > 0 ? swapDesc.sampleCount : 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
+
+    SharedTexture created[kSwapTextureCount] = {};
+    for (uint32_t i = 0; i < kSwapTextureCount; i++)
+    {
+        HRESULT hr = m_pDevice->CreateTexture2D(&desc, nullptr, &created[i].texture);
+        if (FAILED(hr))
+            return false;
+
+        ComPtr<IDXGIResource> dxgiResource;
+        HANDLE sharedHandle = nullptr;
+        hr = created[i].texture.As(&dxgiResource);
+        if (FAILED(hr) || FAILED(dxgiResource->GetSharedHandle(&sharedHandle)))
+            return false;
+
+        created[i].handle = reinterpret_cast<uint64_t>(sharedHandle);
+    }
+
+    for (uint32_t i = 0; i < kSwapTextureCount; i++)
+    {
+        handles[i] = created[i].handle;
+        m_textures.push_back(std::move(created[i]));
+    }
+    return true;
+}
+
+void D3D11TextureDevice::DestroySwapTextures(const uint64_t (&handles)[kSwapTextureCount])
+{
+    std::erase_if(m_textures, [&](const SharedTexture& texture) {
+        return std::find(std::begin(handles), std::end(handles), texture.handle) != std::end(handles);
+    });
+}
+
+std::unique_ptr<ReadbackBackend> D3D11TextureDevice::CreateReadback(uint32_t depth)
+{
+    if (!m_pDevice)
+        return nullptr;
+
+    return std::make_unique<D3D11Readback>(m_pDevice.Get(), m_pContext.Get(), depth);
+}
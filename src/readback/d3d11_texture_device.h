@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include "texture_device.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Swap textures are shareable D3D11 textures on the driver's own device
+class D3D11TextureDevice : public TextureDevice
+{
+public:
+    D3D11TextureDevice();
+    ~D3D11TextureDevice() override;
+
+    bool CreateSwapTextures(const SwapTextureDesc& desc, uint64_t (&handles)[kSwapTextureCount]) override;
+    void DestroySwapTextures(const uint64_t (&handles)[kSwapTextureCount]) override;
+    std::unique_ptr<ReadbackBackend> CreateReadback(uint32_t depth) override;
+
+private:
+    struct SharedTexture {
+        uint64_t handle;
+        ComPtr<ID3D11Texture2D> texture;
+    };
+
+    ComPtr<ID3D11Device> m_pDevice;
+    ComPtr<ID3D11DeviceContext> m_pContext;
+    std::vector<SharedTexture> m_textures;
+};
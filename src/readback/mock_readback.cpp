@@ -0,0 +1,128 @@
+#include "mock_readback.h"
+#include <algorithm>
+#include <cstring>
+
+MockReadback::MockReadback(uint32_t depth, uint32_t latencyFrames)
+    : m_latencyFrames(latencyFrames)
+{
+    for (auto& layerRings : m_rings)
+    {
+        for (auto& ring : layerRings)
+            ring.slots.resize(depth > 0 ? depth : 1);
+    }
+}
+
+void MockReadback::RegisterTexture(uint64_t handle, const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height, SourceFormat format)
+{
+    std::lock_guard<std::mutex> lock(m_texturesMtx);
+    for (auto& texture : m_textures)
+    {
+        if (texture.handle == handle)
+        {
+            texture = Texture{ handle, pixels, rowPitch, width, height, format };
+            return;
+        }
+    }
+    m_textures.push_back(Texture{ handle, pixels, rowPitch, width, height, format });
+}
+
+void MockReadback::UnregisterTexture(uint64_t handle)
+{
+    std::lock_guard<std::mutex> lock(m_texturesMtx);
+    std::erase_if(m_textures, [handle](const Texture& texture) { return texture.handle == handle; });
+}
+
+bool MockReadback::Submit(const ReadbackRequest& request)
+{
+    Texture texture;
+    {
+        std::lock_guard<std::mutex> lock(m_texturesMtx);
+        auto it = std::find_if(m_textures.begin(), m_textures.end(), [&](const Texture& t) { return t.handle == request.texture; });
+        if (it == m_textures.end())
+            return false;
+        texture = *it;
+    }
+
+    EyeRing& ring = GetRing(request.eye, request.layer);
+    if (ring.pending == ring.slots.size())
+    {
+        if (ring.acquired)
+            return false;
+        DropOldest(ring);
+    }
+
+    // The "GPU copy" happens right away; readiness is what gets delayed
+    PixelRect region = GetReadbackRegion(request, texture.width, texture.height);
+    Slot& slot = ring.slots[ring.next];
+    slot.pixels.resize(static_cast<size_t>(region.width) * region.height * 4);
+    for (uint32_t y = 0; y < region.height; y++)
+    {
+        std::memcpy(slot.pixels.data() + static_cast<size_t>(y) * region.width * 4,
+                    texture.pixels + static_cast<size_t>(region.y + y) * texture.rowPitch + region.x * 4,
+                    region.width * 4);
+    }
+
+    slot.width = region.width;
+    slot.height = region.height;
+    slot.format = texture.format;
+    slot.frameIndex = request.frameIndex;
+    slot.texture = request.texture;
+    // Present acquires after submitting, so the next Acquire is this frame's
+    slot.readyAt = ring.acquires + 1 + m_latencyFrames;
+    slot.pending = true;
+    ring.next = (ring.next + 1) % ring.slots.size();
+    ring.pending++;
+    m_submitted++;
+    return true;
+}
+
+void MockReadback::DropOldest(EyeRing& ring)
+{
+    ring.slots[ring.oldest].pending = false;
+    ring.oldest = (ring.oldest + 1) % ring.slots.size();
+    ring.pending--;
+    m_dropped++;
+}
+
+std::optional<ReadbackResult> MockReadback::Acquire(uint32_t eye, uint32_t layer)
+{
+    EyeRing& ring = GetRing(eye, layer);
+    if (ring.acquired)
+        return std::nullopt;
+
+    ring.acquires++;
+    if (ring.pending == 0)
+        return std::nullopt;
+
+    // A full ring waits for its oldest copy, same as a blocking Map
+    bool wait = ring.pending == ring.slots.size();
+    if (!wait && !IsReady(ring, ring.slots[ring.oldest]))
+        return std::nullopt;
+
+    while (ring.pending > 1 && IsReady(ring, ring.slots[(ring.oldest + 1) % ring.slots.size()]))
+    {
+        DropOldest(ring);
+    }
+
+    const Slot& slot = ring.slots[ring.oldest];
+    ring.acquired = true;
+    return ReadbackResult{ slot.pixels.data(), slot.width * 4, slot.width, slot.height, slot.format, eye & 1, slot.frameIndex, slot.texture };
+}
+
+void MockReadback::Release(uint32_t eye, uint32_t layer)
+{
+    EyeRing& ring = GetRing(eye, layer);
+    if (!ring.acquired)
+        return;
+
+    ring.slots[ring.oldest].pending = false;
+    ring.oldest = (ring.oldest + 1) % ring.slots.size();
+    ring.pending--;
+    ring.acquired = false;
+    m_completed++;
+}
+
+ReadbackStats MockReadback::GetStats() const
+{
+    return ReadbackStats{ m_submitted.load(), m_completed.load(), m_dropped.load() };
+}
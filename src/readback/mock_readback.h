@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "readback_backend.h"
+
+// CPU stand-in for the GPU readback, for benchmarks and headless runs. Textures are plain
+// images registered up front; a copy becomes ready a fixed number of Presents (counted as
+// Acquire calls on its ring) after it was queued, which mimics the GPU running behind the CPU.
+class MockReadback : public ReadbackBackend
+{
+public:
+    MockReadback(uint32_t depth, uint32_t latencyFrames);
+
+    // pixels must stay valid while the texture is in use; rowPitch is in bytes
+    void RegisterTexture(uint64_t handle, const uint8_t* pixels, uint32_t rowPitch, uint32_t width, uint32_t height, SourceFormat format);
+    // Later Submits of the handle fail; copies already taken stay valid
+    void UnregisterTexture(uint64_t handle);
+
+    bool Submit(const ReadbackRequest& request) override;
+    std::optional<ReadbackResult> Acquire(uint32_t eye, uint32_t layer = 0) override;
+    void Release(uint32_t eye, uint32_t layer = 0) override;
+    void ForgetTexture(uint64_t handle) override { UnregisterTexture(handle); }
+    ReadbackStats GetStats() const override;
+
+private:
+    struct Texture {
+        uint64_t handle;
+        const uint8_t* pixels;
+        uint32_t rowPitch;
+        uint32_t width;
+        uint32_t height;
+        SourceFormat format;
+    };
+
+    struct Slot {
+        std::vector<uint8_t> pixels;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        SourceFormat format = SourceFormat::Bgra8;
+        uint64_t frameIndex = 0;
+        uint64_t texture = 0;
+        uint64_t readyAt = 0;
+        bool pending = false;
+    };
+
+    struct EyeRing {
+        std::vector<Slot> slots;
+        uint32_t next = 0;
+        uint32_t oldest = 0;
+        uint32_t pending = 0;
+        uint64_t acquires = 0;
+        bool acquired = false;
+    };
+
+    bool IsReady(const EyeRing& ring, const Slot& slot) const { return ring.acquires >= slot.readyAt; }
+    void DropOldest(EyeRing& ring);
+
+    uint32_t m_latencyFrames;
+    std::vector<Texture> m_textures;
+    std::mutex m_texturesMtx;
+    EyeRing& GetRing(uint32_t eye, uint32_t layer) { return m_rings[std::min(layer, kMaxReadbackLayers - 1)][eye & 1]; }
+
+    EyeRing m_rings[kMaxReadbackLayers][2];
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_completed{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <algorithm>
+#include "../image/unpack.h"
+#include "../image/resample.h"
+
+// One eye's region of a submitted texture to copy back to the CPU.
+// Bounds are normalized like vr::VRTextureBounds_t; an empty range means the whole axis.
+struct ReadbackRequest {
+    uint64_t texture;  // Shared texture handle from SubmitLayer
+    float uMin;
+    float vMin;
+    float uMax;
+    float vMax;
+    uint32_t eye;
+    uint64_t frameIndex;
+    uint32_t layer;  // Submission order within the frame; each layer has its own rings
+};
+
+// Rings per eye: the projection layer and the overlays submitted on top of it
+static constexpr uint32_t kMaxReadbackLayers = 4;
+
+// A finished copy, readable until its ring's Release. data points at the region's top-left pixel.
+struct ReadbackResult {
+    const uint8_t* data;
+    uint32_t rowPitch;
+    uint32_t width;
+    uint32_t height;
+    SourceFormat format;
+    uint32_t eye;
+    uint64_t frameIndex;
+    uint64_t texture;  // Handle the copy was taken from
+};
+
+struct ReadbackStats {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t dropped;  // Copies never handed out because a newer one was ready or the ring was full
+};
+
+// Pixel region of a width x height texture selected by the request's bounds
+inline PixelRect GetReadbackRegion(const ReadbackRequest& request, uint32_t width, uint32_t height)
+{
+    uint32_t x = std::min(static_cast<uint32_t>(std::max(request.uMin, 0.0f) * width), width - 1);
+    uint32_t y = std::min(static_cast<uint32_t>(std::max(request.vMin, 0.0f) * height), height - 1);
+    uint32_t w = static_cast<uint32_t>(std::max(request.uMax - request.uMin, 0.0f) * width);
+    uint32_t h = static_cast<uint32_t>(std::max(request.vMax - request.vMin, 0.0f) * height);
+
+    if (w == 0) w = width;
+    if (h == 0) h = height;
+    if (x + w > width) w = width - x;
+    if (y + h > height) h = height - y;
+    return PixelRect{ x, y, w, h };
+}
+
+// Copies eye images off the GPU through a ring of staging buffers per eye and layer, so a frame can
+// be mapped a few Presents after its copy was queued instead of stalling on it.
+class ReadbackBackend
+{
+public:
+    virtual ~ReadbackBackend() = default;
+
+    // Queues a copy of the request's region. Returns false if the texture can't be read back.
+    virtual bool Submit(const ReadbackRequest& request) = 0;
+
+    // Newest finished copy for the eye's layer, or nullopt while every queued copy is still in
+    // flight. Older finished copies are dropped so both eyes converge on the same frame. Once the
+    // ring is full the oldest copy is waited for, so results lag by at most depth - 1 frames.
+    virtual std::optional<ReadbackResult> Acquire(uint32_t eye, uint32_t layer = 0) = 0;
+
+    // Hands the acquired slot back to the ring
+    virtual void Release(uint32_t eye, uint32_t layer = 0) = 0;
+
+    // Drops whatever is cached for a shared texture that is about to be destroyed. Copies already
+    // taken from it stay valid.
+    virtual void ForgetTexture(uint64_t handle) = 0;
+
+    virtual ReadbackStats GetStats() const = 0;
+};
@@ -0,0 +1,114 @@
+#include "synthetic_texture_device.h"
+#include <algorithm>
+#include <unordered_map>
+
+// Copies are ready one Present after they were queued, like a GPU one frame behind
+static constexpr uint32_t kReadbackLatencyFrames = 1;
+
+// DXGI_FORMAT values of the non-BGRA formats the compositor uses
+static constexpr uint32_t kDxgiR10G10B10A2Typeless = 23;
+static constexpr uint32_t kDxgiR10G10B10A2Unorm = 24;
+static constexpr uint32_t kDxgiR8G8B8A8Typeless = 27;
+static constexpr uint32_t kDxgiR8G8B8A8Unorm = 28;
+static constexpr uint32_t kDxgiR8G8B8A8UnormSrgb = 29;
+
+// Every synthetic texture in the process, by handle
+static std::mutex s_texturesMtx;
+static std::unordered_map<uint64_t, std::unique_ptr<SyntheticTexture>> s_textures;
+static uint64_t s_nextHandle = 0x1000;
+
+static SourceFormat GetSourceFormat(uint32_t dxgiFormat)
+{
+    switch (dxgiFormat)
+    {
+        case kDxgiR10G10B10A2Typeless:
+        case kDxgiR10G10B10A2Unorm:
+            return SourceFormat::Rgb10A2;
+        case kDxgiR8G8B8A8Typeless:
+        case kDxgiR8G8B8A8Unorm:
+        case kDxgiR8G8B8A8UnormSrgb:
+            return SourceFormat::Rgba8;
+        default:
+            return SourceFormat::Bgra8;
+    }
+}
+
+SyntheticTexture* SyntheticTextureDevice::OpenShared(uint64_t handle)
+{
+    std::lock_guard<std::mutex> lock(s_texturesMtx);
+    auto it = s_textures.find(handle);
+    return it != s_textures.end() ? it->second.get() : nullptr;
+}
+
+SyntheticTextureDevice::~SyntheticTextureDevice()
+{
+    std::lock_guard<std::mutex> lock(s_texturesMtx);
+    for (uint64_t handle : m_handles)
+    {
+        s_textures.erase(handle);
+    }
+}
+
+bool SyntheticTextureDevice::CreateSwapTextures(const SwapTextureDesc& desc, uint64_t (&handles)[kSwapTextureCount])
+{
+    if (desc.width == 0 || desc.height == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (uint32_t i = 0; i < kSwapTextureCount; i++)
+    {
+        auto texture = std::make_unique<SyntheticTexture>();
+        texture->width = desc.width;
+        texture->height = desc.height;
+        texture->rowPitch = desc.width * 4;
+        texture->format = GetSourceFormat(desc.format);
+        texture->pixels.resize(static_cast<size_t>(texture->rowPitch) * desc.height);
+
+        {
+            std::lock_guard<std::mutex> texturesLock(s_texturesMtx);
+            handles[i] = s_nextHandle++;
+            if (m_pReadback)
+                m_pReadback->RegisterTexture(handles[i], texture->pixels.data(), texture->rowPitch, texture->width, texture->height, texture->format);
+            s_textures.emplace(handles[i], std::move(texture));
+        }
+        m_handles.push_back(handles[i]);
+    }
+    return true;
+}
+
+void SyntheticTextureDevice::DestroySwapTextures(const uint64_t (&handles)[kSwapTextureCount])
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (uint64_t handle : handles)
+    {
+        if (std::erase(m_handles, handle) == 0)
+            continue;
+
+        if (m_pReadback)
+            m_pReadback->UnregisterTexture(handle);
+
+        std::lock_guard<std::mutex> texturesLock(s_texturesMtx);
+        s_textures.erase(handle);
+    }
+}
+
+std::unique_ptr<ReadbackBackend> SyntheticTextureDevice::CreateReadback(uint32_t depth)
+{
+    auto readback = std::make_unique<MockReadback>(depth, kReadbackLatencyFrames);
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_pReadback = readback.get();
+    for (uint64_t handle : m_handles)
+    {
+        if (SyntheticTexture* texture = OpenShared(handle))
+            m_pReadback->RegisterTexture(handle, texture->pixels.data(), texture->rowPitch, texture->width, texture->height, texture->format);
+    }
+    return readback;
+}
+
+void SyntheticTextureDevice::ReleaseReadback(const ReadbackBackend* readback)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_pReadback == readback)
+        m_pReadback = nullptr;
+}
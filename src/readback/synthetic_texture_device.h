@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include "texture_device.h"
+#include "mock_readback.h"
+
+// A CPU image standing in for a shared GPU texture
+struct SyntheticTexture {
+    std::vector<uint8_t> pixels;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowPitch;
+    SourceFormat format;
+};
+
+// Headless stand-in for D3D11TextureDevice. Swap textures are plain images and the readback is
+// a MockReadback over them. Handles are unique across the process, the way D3D11 shared handles
+// are system-wide, so a mock compositor can OpenShared what the driver handed out and draw into it.
+class SyntheticTextureDevice : public TextureDevice
+{
+public:
+    ~SyntheticTextureDevice() override;
+
+    bool CreateSwapTextures(const SwapTextureDesc& desc, uint64_t (&handles)[kSwapTextureCount]) override;
+    void DestroySwapTextures(const uint64_t (&handles)[kSwapTextureCount]) override;
+    // Textures created or destroyed later are registered with the newest readback until it is
+    // released
+    std::unique_ptr<ReadbackBackend> CreateReadback(uint32_t depth) override;
+    void ReleaseReadback(const ReadbackBackend* readback) override;
+
+    // nullptr for handles no device has created or that were destroyed
+    static SyntheticTexture* OpenShared(uint64_t handle);
+
+private:
+    std::mutex m_mtx;
+    std::vector<uint64_t> m_handles;
+    MockReadback* m_pReadback = nullptr;
+};
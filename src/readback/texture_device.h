@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "readback_backend.h"
+
+// What the compositor asked for in CreateSwapTextureSet
+struct SwapTextureDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;  // DXGI_FORMAT value
+    uint32_t sampleCount;
+};
+
+// The GPU side of direct mode: owns the swap textures the compositor renders into and creates
+// the readback that copies them to the CPU. D3D11 on Windows, plain memory for headless builds.
+class TextureDevice
+{
+public:
+    static constexpr uint32_t kSwapTextureCount = 3;
+
+    virtual ~TextureDevice() = default;
+
+    // Fills handles with the shared handles of a new swap texture set. False if creation failed.
+    virtual bool CreateSwapTextures(const SwapTextureDesc& desc, uint64_t (&handles)[kSwapTextureCount]) = 0;
+    virtual void DestroySwapTextures(const uint64_t (&handles)[kSwapTextureCount]) = 0;
+
+    // nullptr if the device is unusable
+    virtual std::unique_ptr<ReadbackBackend> CreateReadback(uint32_t depth) = 0;
+    // Called before a readback from CreateReadback is destroyed, so the device stops using it
+    virtual void ReleaseReadback(const ReadbackBackend*) {}
+};
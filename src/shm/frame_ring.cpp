@@ -0,0 +1,144 @@
+#include "frame_ring.h"
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+FrameRing::~FrameRing()
+{
+#ifdef _WIN32
+    if (m_pView)
+        UnmapViewOfFile(m_pView);
+    if (m_hMapping)
+        CloseHandle(m_hMapping);
+    if (m_hEvent)
+        CloseHandle(m_hEvent);
+#else
+    if (m_pView)
+        munmap(m_pView, m_mappingSize);
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        shm_unlink(m_mappingName.c_str());
+    }
+#endif
+}
+
+std::expected<void, std::string> FrameRing::Create(uint32_t slotCount, uint32_t maxFrameBytes)
+{
+    if (m_pView)
+        return std::unexpected("frame ring already created");
+    if (slotCount == 0 || maxFrameBytes == 0)
+        return std::unexpected("invalid frame ring size");
+
+    // Keep every slot's pixels 64-byte aligned for the copy loops
+    uint32_t slotStride = (sizeof(FrameSlotHeader) + maxFrameBytes + 63) & ~63u;
+    uint64_t totalSize = sizeof(FrameRingHeader) + static_cast<uint64_t>(slotStride) * slotCount;
+    totalSize = (totalSize + 63) & ~63ull;
+
+    // Names carry the pid so a restarted vrserver never reuses a stale mapping
+#ifdef _WIN32
+    std::string suffix = std::to_string(GetCurrentProcessId());
+    m_mappingName = "Local\\OVDFrameRing_" + suffix;
+    m_eventName = "Local\\OVDFrameReady_" + suffix;
+
+    m_hMapping = CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(totalSize >> 32),
+        static_cast<DWORD>(totalSize & 0xFFFFFFFF),
+        m_mappingName.c_str());
+    if (!m_hMapping)
+        return std::unexpected("CreateFileMapping failed");
+
+    m_pView = static_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, totalSize));
+    if (!m_pView)
+        return std::unexpected("MapViewOfFile failed");
+
+    // Auto-reset, signalled once per published frame
+    m_hEvent = CreateEventA(nullptr, FALSE, FALSE, m_eventName.c_str());
+    if (!m_hEvent)
+        return std::unexpected("CreateEvent failed");
+#else
+    m_mappingName = "/OVDFrameRing_" + std::to_string(getpid());
+
+    m_fd = shm_open(m_mappingName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (m_fd < 0)
+        return std::unexpected("shm_open failed");
+    if (ftruncate(m_fd, static_cast<off_t>(totalSize)) != 0)
+        return std::unexpected("ftruncate failed");
+
+    void* view = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED)
+        return std::unexpected("mmap failed");
+    m_pView = static_cast<uint8_t*>(view);
+#endif
+
+    m_slotCount = slotCount;
+    m_slotStride = slotStride;
+    m_maxFrameBytes = maxFrameBytes;
+    m_mappingSize = totalSize;
+
+    m_pHeader = new (m_pView) FrameRingHeader{};
+    m_pHeader->slotCount = slotCount;
+    m_pHeader->slotStride = slotStride;
+    m_pHeader->maxFrameBytes = maxFrameBytes;
+    m_pHeader->writeSequence.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        new (m_pView + sizeof(FrameRingHeader) + static_cast<uint64_t>(i) * slotStride) FrameSlotHeader{};
+    }
+    m_pHeader->version = kFrameRingVersion;
+
+    // Magic last, readers treat anything else as not yet initialized
+    std::atomic_thread_fence(std::memory_order_release);
+    m_pHeader->magic = kFrameRingMagic;
+
+    return {};
+}
+
+FrameSlotHeader* FrameRing::GetSlot(uint64_t sequence) const
+{
+    uint64_t index = sequence % m_slotCount;
+    return reinterpret_cast<FrameSlotHeader*>(m_pView + sizeof(FrameRingHeader) + index * m_slotStride);
+}
+
+uint8_t* FrameRing::BeginWrite(uint32_t width, uint32_t height, uint32_t eye, uint32_t format, size_t size)
+{
+    if (!m_pView || size > m_maxFrameBytes)
+        return nullptr;
+
+    FrameSlotHeader* slot = GetSlot(m_nextSequence);
+
+    // Invalidate the slot before touching its pixels
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->width = width;
+    slot->height = height;
+    slot->eye = eye;
+    slot->format = format;
+    slot->size = static_cast<uint32_t>(size);
+
+    m_pWriteSlot = slot;
+    return reinterpret_cast<uint8_t*>(slot + 1);
+}
+
+void FrameRing::EndWrite()
+{
+    if (!m_pWriteSlot)
+        return;
+
+    uint64_t sequence = m_nextSequence++;
+    m_pWriteSlot->sequence.store(sequence, std::memory_order_release);
+    m_pHeader->writeSequence.store(sequence, std::memory_order_release);
+    m_pWriteSlot = nullptr;
+
+#ifdef _WIN32
+    SetEvent(m_hEvent);
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#endif
+#include <atomic>
+#include <string>
+#include <expected>
+#include <cstdint>
+
+// Shared memory layout, read by out-of-process consumers. Keep in sync with the client.
+//
+// [FrameRingHeader][slot 0][slot 1]...[slot N-1]
+// Each slot is a FrameSlotHeader followed by up to maxFrameBytes of pixels.
+//
+// Frame N is written to slot N % slotCount. A slot's sequence is 0 while it is being
+// written and N once published, so readers check it before and after touching the
+// pixels to detect a writer lapping them.
+static constexpr uint32_t kFrameRingMagic = 0x5244564F; // "OVDR"
+static constexpr uint32_t kFrameRingVersion = 1;
+
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotStride;
+    uint32_t maxFrameBytes;
+    uint32_t reserved;
+    std::atomic<uint64_t> writeSequence;
+};
+
+struct FrameSlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint32_t width;
+    uint32_t height;
+    uint32_t eye;
+    uint32_t size;
+    uint32_t format;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FrameRingHeader) == 32, "FrameRingHeader layout is shared with clients");
+static_assert(sizeof(FrameSlotHeader) == 32, "FrameSlotHeader layout is shared with clients");
+
+// Single-writer ring of frame slots in a named file mapping (POSIX shared memory outside Windows).
+// The driver writes each cropped eye straight into a slot; readers map it read-only.
+// Only Windows has the frame-ready event; elsewhere the event name is empty and readers poll.
+class FrameRing
+{
+public:
+    FrameRing() = default;
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    std::expected<void, std::string> Create(uint32_t slotCount, uint32_t maxFrameBytes);
+
+    // Returns the slot's pixel memory, or nullptr if the frame doesn't fit.
+    // Must be followed by EndWrite before the next BeginWrite.
+    uint8_t* BeginWrite(uint32_t width, uint32_t height, uint32_t eye, uint32_t format, size_t size);
+    void EndWrite();
+
+    const std::string& GetMappingName() const { return m_mappingName; }
+    const std::string& GetEventName() const { return m_eventName; }
+    uint32_t GetSlotCount() const { return m_slotCount; }
+    uint32_t GetSlotStride() const { return m_slotStride; }
+    uint32_t GetMaxFrameBytes() const { return m_maxFrameBytes; }
+    uint64_t GetMappingSize() const { return m_mappingSize; }
+
+private:
+    FrameSlotHeader* GetSlot(uint64_t sequence) const;
+
+#ifdef _WIN32
+    HANDLE m_hMapping = nullptr;
+    HANDLE m_hEvent = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    uint8_t* m_pView = nullptr;
+    FrameRingHeader* m_pHeader = nullptr;
+
+    std::string m_mappingName;
+    std::string m_eventName;
+    uint32_t m_slotCount = 0;
+    uint32_t m_slotStride = 0;
+    uint32_t m_maxFrameBytes = 0;
+    uint64_t m_mappingSize = 0;
+
+    uint64_t m_nextSequence = 1;
+    FrameSlotHeader* m_pWriteSlot = nullptr;
+};
@@ -1,7 +1,89 @@
 #include "socket_manager.h"
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+// Large enough to hold a full 1920x1080 BGRA eye so a frame rarely blocks mid-send
+static constexpr int kSendBufferSize = 8 * 1024 * 1024;
+
+// Shared memory defaults: a few 1920x1080 BGRA frames so readers get some slack
+static constexpr uint32_t kDefaultSharedSlotCount = 4;
+static constexpr uint32_t kDefaultSharedFrameBytes = 1920 * 1080 * 4;
+static constexpr uint32_t kMaxSharedSlotCount = 16;
+static constexpr uint32_t kMaxSharedFrameBytes = 4096 * 4096 * 4;
+
+// Control commands are short text lines
+static constexpr uint32_t kMaxControlSize = 4096;
+
+// A send blocked this long means the client or the network isn't keeping up
+static constexpr auto kSendStallThreshold = std::chrono::milliseconds(2);
+
+static metrics::Counter& s_bytesSent = metrics::Registry::Get().GetCounter("socket.bytes_sent");
+static metrics::Counter& s_messagesSent = metrics::Registry::Get().GetCounter("socket.messages_sent");
+static metrics::Counter& s_sendFailures = metrics::Registry::Get().GetCounter("socket.send_failures");
+static metrics::Counter& s_sendStalls = metrics::Registry::Get().GetCounter("socket.send_stalls");
+static metrics::Histogram& s_sendTime = metrics::Registry::Get().GetHistogram("socket.send_us");
+static metrics::Counter& s_bytesReceived = metrics::Registry::Get().GetCounter("socket.bytes_received");
+static metrics::Counter& s_messagesReceived = metrics::Registry::Get().GetCounter("socket.messages_received");
+static metrics::Counter& s_connections = metrics::Registry::Get().GetCounter("socket.connections");
+// Unknown types, or known ones with the wrong size; their payload is read and dropped
+static metrics::Counter& s_messagesDiscarded = metrics::Registry::Get().GetCounter("socket.messages_discarded");
+static metrics::Counter& s_priorityMessages = metrics::Registry::Get().GetCounter("socket.priority_messages");
+static metrics::Histogram& s_priorityDelay = metrics::Registry::Get().GetHistogram("socket.priority_delay_us");
+
+static control::Setting& s_port = control::Registry::Get().AddInt("socket.port", 21213, 1, 65535, "TCP port clients connect to (read at startup)");
+
+// What a client gets until it asks for something else
+static control::Setting& s_defaultEyes = control::Registry::Get().AddInt("subscription.eyes", kDefaultFrameSubscription.eyeMask, 0, 3, "Eye mask new clients are subscribed to");
+static control::Setting& s_defaultDivisor = control::Registry::Get().AddInt("subscription.divisor", kDefaultFrameSubscription.frameDivisor, 0, 1000, "Send every Nth frame to new clients");
+static control::Setting& s_defaultMaxFps = control::Registry::Get().AddFloat("subscription.max_fps", kDefaultFrameSubscription.maxFps, 0.0, 1000.0, "Frame rate cap for new clients, 0 for none");
+static control::Setting& s_defaultFilter = control::Registry::Get().AddInt("output.filter", static_cast<int64_t>(ResampleFilter::Box), 0, 1, "Resample filter for new clients, 0 box, 1 bilinear");
+
+// Writes every buffer in order, resuming after partial writes.
+// The buffers array is modified in place to track progress.
+static bool SendAll(SOCKET socket, net::Buffer* buffers, uint32_t count)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++)
+        total += net::GetBufferSize(buffers[i]);
+    OVD_TRACE_SCOPE_ARG("socket.send", "bytes", total);
+
+    auto start = std::chrono::steady_clock::now();
+    while (count > 0)
+    {
+        int64_t result = net::SendGathered(socket, buffers, count);
+        if (result < 0)
+        {
+            s_sendFailures.Add();
+            return false;
+        }
+        size_t sent = static_cast<size_t>(result);
+        s_bytesSent.Add(sent);
+
+        // Skip buffers that were fully written, then trim the partially written one
+        while (count > 0 && sent >= net::GetBufferSize(*buffers))
+        {
+            sent -= net::GetBufferSize(*buffers);
+            ++buffers;
+            --count;
+        }
+        if (count > 0)
+        {
+            net::AdvanceBuffer(*buffers, sent);
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    s_sendTime.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    if (elapsed > kSendStallThreshold)
+        s_sendStalls.Add();
+    s_messagesSent.Add();
+    return true;
+}
 
 SocketManager::SocketManager(
-    mpsc::Sender<Pose> headPoseSender,
+    mpsc::Sender<PoseSample> headPoseSender,
     mpsc::Sender<ControllerInput> leftControllerInputSender,
     mpsc::Sender<ControllerInput> rightControllerInputSender,
     mpsc::Sender<Pose> leftHandPoseSender,
@@ -20,15 +102,18 @@ SocketManager::SocketManager(
 
 SocketManager::~SocketManager()
 {
-    closesocket(clientSocket);
-    closesocket(listenSocket);
-    WSACleanup();
+    // The connection thread closes the client socket once its receive thread wakes up
+    connectionThread.request_stop();
+    net::Shutdown(clientSocket);
+    net::Close(listenSocket);
+    if (connectionThread.joinable())
+        connectionThread.join();
+    net::Cleanup();
 }
 
 std::expected<int, std::string> SocketManager::Init()
 {
-    WSADATA wsa;
-    if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+    if (!net::Startup())
     {
         return std::unexpected("WSAStartup failed");
     }
@@ -38,11 +123,12 @@ std::expected<int, std::string> SocketManager::Init()
     {
         return std::unexpected("socket failed");
     }
+    net::AllowAddressReuse(listenSocket);
 
     sockaddr_in serverAddr{};
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(21213);
+    serverAddr.sin_port = htons(static_cast<uint16_t>(s_port.GetInt()));
 
     if (bind(listenSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR)
     {
@@ -61,25 +147,71 @@ std::expected<int, std::string> SocketManager::Init()
 
 void SocketManager::Connect(std::stop_token st)
 {
+    trace::SetThreadName("Socket accept");
     while (!st.stop_requested())
     {
         clientSocket = accept(listenSocket, nullptr, nullptr);
         if (clientSocket == INVALID_SOCKET)
             continue;
 
+        // Frames are latency sensitive, don't let Nagle hold back the tail of a send
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        int sendBufferSize = kSendBufferSize;
+        setsockopt(clientSocket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBufferSize), sizeof(sendBufferSize));
+
+        m_frameCodec = FrameCodec::Raw;
+        m_stereoEnabled = false;
+        m_stereoLayout = StereoLayout::Sequential;
+        m_timingEnabled = false;
+        m_poseSequence = 0;
+        {
+            // Anything still queued was meant for the previous client
+            std::lock_guard<std::mutex> lock(m_priorityMtx);
+            m_priorityMsgs.clear();
+            m_priorityPending = false;
+        }
+        m_subscription.Store(FrameSubscription{
+            static_cast<uint32_t>(s_defaultEyes.GetInt()),
+            static_cast<uint32_t>(s_defaultDivisor.GetInt()),
+            s_defaultMaxFps.GetFloat(),
+            0
+        });
+        OutputSpec outputSpec{};
+        outputSpec.filter = static_cast<ResampleFilter>(s_defaultFilter.GetInt());
+        m_outputSpec.Store(outputSpec);
+        m_connectionId++;
+        m_settingsVersion++;
+        s_connections.Add();
         connected = true;
 
         receiverThread = std::jthread([this](std::stop_token st) { Receive(st); });
         receiverThread.join();
 
         connected = false;
-        closesocket(clientSocket);
+        m_sharedMemoryActive = false;
+        net::Close(clientSocket);
         clientSocket = INVALID_SOCKET;
     }
 }
 
+// Reads and drops size bytes so the next header is read from where it starts
+static bool DiscardPayload(SOCKET socket, uint32_t size)
+{
+    char scratch[4096];
+    while (size > 0)
+    {
+        int bytes = recv(socket, scratch, static_cast<int>(std::min<uint32_t>(size, sizeof(scratch))), MSG_WAITALL);
+        if (bytes <= 0)
+            return false;
+        size -= static_cast<uint32_t>(bytes);
+    }
+    return true;
+}
+
 void SocketManager::Receive(std::stop_token st)
 {
+    trace::SetThreadName("Socket receive");
     while (!st.stop_requested() && connected)
     {
         MsgHeader msgHeader;
@@ -87,6 +219,10 @@ void SocketManager::Receive(std::stop_token st)
         if (bytes <= 0)
             break;
 
+        OVD_TRACE_SCOPE_ARG("socket.receive", "type", static_cast<uint64_t>(msgHeader.type));
+        s_messagesReceived.Add();
+        s_bytesReceived.Add(sizeof(msgHeader) + msgHeader.size);
+
         if (msgHeader.type == MsgType::BodyPosition && msgHeader.size == sizeof(BodyPosition))
         {
             BodyPosition bodyPos;
@@ -94,33 +230,34 @@ void SocketManager::Receive(std::stop_token st)
             if (bytes <= 0)
                 break;
 
+            OVD_TRACE_SCOPE("pose.dispatch");
+            uint64_t sequence = ++m_poseSequence;
+
             // Send poses only if not null (all zeros means skip update)
             if (!bodyPos.head.isNull())
-                m_headPoseSender.send(bodyPos.head);
-            if (!bodyPos.leftHand.isNull())
-                m_leftHandPoseSender.send(bodyPos.leftHand);
-            if (!bodyPos.rightHand.isNull())
-                m_rightHandPoseSender.send(bodyPos.rightHand);
-            if (!bodyPos.waist.isNull())
-                m_trackerSenders.waist.send(bodyPos.waist);
-            if (!bodyPos.chest.isNull())
-                m_trackerSenders.chest.send(bodyPos.chest);
-            if (!bodyPos.leftFoot.isNull())
-                m_trackerSenders.leftFoot.send(bodyPos.leftFoot);
-            if (!bodyPos.rightFoot.isNull())
-                m_trackerSenders.rightFoot.send(bodyPos.rightFoot);
-            if (!bodyPos.leftKnee.isNull())
-                m_trackerSenders.leftKnee.send(bodyPos.leftKnee);
-            if (!bodyPos.rightKnee.isNull())
-                m_trackerSenders.rightKnee.send(bodyPos.rightKnee);
-            if (!bodyPos.leftElbow.isNull())
-                m_trackerSenders.leftElbow.send(bodyPos.leftElbow);
-            if (!bodyPos.rightElbow.isNull())
-                m_trackerSenders.rightElbow.send(bodyPos.rightElbow);
-            if (!bodyPos.leftShoulder.isNull())
-                m_trackerSenders.leftShoulder.send(bodyPos.leftShoulder);
-            if (!bodyPos.rightShoulder.isNull())
-                m_trackerSenders.rightShoulder.send(bodyPos.rightShoulder);
+                m_headPoseSender.send(PoseSample{ bodyPos.head, sequence, GetDriverTimeUs() });
+
+            // Every device that got a pose becomes requested, see AIVRDeviceProvider::RunFrame
+            uint32_t devices = 0;
+            auto sendPose = [&devices](mpsc::Sender<Pose>& sender, const Pose& devicePose, DeviceRole role) {
+                if (devicePose.isNull())
+                    return;
+                sender.send(devicePose);
+                devices |= DeviceBit(role);
+            };
+            sendPose(m_leftHandPoseSender, bodyPos.leftHand, DeviceRole::LeftHand);
+            sendPose(m_rightHandPoseSender, bodyPos.rightHand, DeviceRole::RightHand);
+            sendPose(m_trackerSenders.waist, bodyPos.waist, DeviceRole::Waist);
+            sendPose(m_trackerSenders.chest, bodyPos.chest, DeviceRole::Chest);
+            sendPose(m_trackerSenders.leftFoot, bodyPos.leftFoot, DeviceRole::LeftFoot);
+            sendPose(m_trackerSenders.rightFoot, bodyPos.rightFoot, DeviceRole::RightFoot);
+            sendPose(m_trackerSenders.leftKnee, bodyPos.leftKnee, DeviceRole::LeftKnee);
+            sendPose(m_trackerSenders.rightKnee, bodyPos.rightKnee, DeviceRole::RightKnee);
+            sendPose(m_trackerSenders.leftElbow, bodyPos.leftElbow, DeviceRole::LeftElbow);
+            sendPose(m_trackerSenders.rightElbow, bodyPos.rightElbow, DeviceRole::RightElbow);
+            sendPose(m_trackerSenders.leftShoulder, bodyPos.leftShoulder, DeviceRole::LeftShoulder);
+            sendPose(m_trackerSenders.rightShoulder, bodyPos.rightShoulder, DeviceRole::RightShoulder);
+            RequestDevices(devices);
         }
         else if (msgHeader.type == MsgType::Controller && msgHeader.size == sizeof(ControllerInput))
         {
@@ -131,35 +268,322 @@ void SocketManager::Receive(std::stop_token st)
 
             m_leftControllerInputSender.send(input);
             m_rightControllerInputSender.send(input);
+            RequestDevices(DeviceBit(DeviceRole::LeftHand) | DeviceBit(DeviceRole::RightHand));
+        }
+        else if (msgHeader.type == MsgType::SharedMemoryRequest && msgHeader.size == sizeof(SharedMemoryRequest))
+        {
+            SharedMemoryRequest request;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&request), sizeof(SharedMemoryRequest), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            EnableSharedMemory(request);
+        }
+        else if (msgHeader.type == MsgType::CodecRequest && msgHeader.size == sizeof(CodecRequest))
+        {
+            CodecRequest request;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&request), sizeof(CodecRequest), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            if (request.codec == FrameCodec::Raw || request.codec == FrameCodec::Qoi || request.codec == FrameCodec::DeltaRle || request.codec == FrameCodec::Tiles)
+                m_frameCodec = request.codec;
+        }
+        else if (msgHeader.type == MsgType::OutputSpec && msgHeader.size == sizeof(OutputSpec))
+        {
+            OutputSpec spec;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&spec), sizeof(OutputSpec), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            if (spec.filter != ResampleFilter::Box && spec.filter != ResampleFilter::Bilinear)
+                spec.filter = ResampleFilter::Bilinear;
+            if (!IsValidPixelFormat(spec.format))
+                spec.format = PixelFormat::Bgra8;
+
+            m_outputSpec.Store(spec);
+        }
+        else if (msgHeader.type == MsgType::StereoRequest && msgHeader.size == sizeof(StereoRequest))
+        {
+            StereoRequest request;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&request), sizeof(StereoRequest), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            m_stereoLayout = request.layout == StereoLayout::SideBySide ? StereoLayout::SideBySide : StereoLayout::Sequential;
+            m_stereoEnabled = request.enabled != 0;
+        }
+        else if (msgHeader.type == MsgType::TimingRequest && msgHeader.size == sizeof(TimingRequest))
+        {
+            TimingRequest request;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&request), sizeof(TimingRequest), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            m_timingEnabled = request.enabled != 0;
+        }
+        else if (msgHeader.type == MsgType::Subscription && msgHeader.size == sizeof(FrameSubscription))
+        {
+            FrameSubscription subscription;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&subscription), sizeof(FrameSubscription), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            subscription.eyeMask &= 3;
+            subscription.maxFps = std::isfinite(subscription.maxFps) ? std::max(subscription.maxFps, 0.0f) : 0.0f;
+            subscription.paused = subscription.paused != 0 ? 1 : 0;
+            m_subscription.Store(subscription);
+        }
+        else if (msgHeader.type == MsgType::StatsRequest && msgHeader.size == 0)
+        {
+            std::string stats = metrics::Registry::Get().FormatJson();
+            SendMsg(MsgType::Stats, stats.data(), static_cast<uint32_t>(stats.size()));
+        }
+        else if (msgHeader.type == MsgType::TraceRequest && msgHeader.size == sizeof(TraceRequest))
+        {
+            TraceRequest request;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&request), sizeof(TraceRequest), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            control::Registry::Get().Execute(request.enabled ? "trace start" : "trace stop");
+            if (!request.enabled)
+            {
+                std::string events = trace::ExportChromeJson();
+                SendMsg(MsgType::Trace, events.data(), static_cast<uint32_t>(events.size()));
+            }
+        }
+        else if (msgHeader.type == MsgType::Control && msgHeader.size <= kMaxControlSize)
+        {
+            std::string command(msgHeader.size, '\0');
+            bytes = msgHeader.size > 0 ? recv(clientSocket, command.data(), msgHeader.size, MSG_WAITALL) : 1;
+            if (bytes <= 0)
+                break;
+
+            std::string reply = control::Registry::Get().Execute(command, control::CommandSource::Remote);
+            SendMsg(MsgType::ControlReply, reply.data(), static_cast<uint32_t>(reply.size()));
         }
+        else if (msgHeader.type == MsgType::DeviceSetup && msgHeader.size == sizeof(DeviceSetup))
+        {
+            DeviceSetup setup;
+            bytes = recv(clientSocket, reinterpret_cast<char*>(&setup), sizeof(DeviceSetup), MSG_WAITALL);
+            if (bytes <= 0)
+                break;
+
+            RequestDevices(setup.devices & kAllDevices);
+        }
+        else
+        {
+            s_messagesDiscarded.Add();
+            if (!DiscardPayload(clientSocket, msgHeader.size))
+                break;
+            continue;
+        }
+
+        // Anything but input may change what the client expects to receive
+        if (msgHeader.type != MsgType::BodyPosition && msgHeader.type != MsgType::Controller && msgHeader.type != MsgType::DeviceSetup)
+            m_settingsVersion++;
     }
 }
 
-bool SocketManager::SendFrame(const Frame& frame)
+void SocketManager::RequestDevices(uint32_t devices)
 {
-    if (!connected)
-        return false;
+    // Usually nothing new, so skip the read-modify-write
+    if ((devices & ~m_requestedDevices.load(std::memory_order_relaxed)) != 0)
+        m_requestedDevices.fetch_or(devices);
+}
 
-    std::lock_guard<std::mutex> lock(sendMtx);
+void SocketManager::EnableSharedMemory(const SharedMemoryRequest& request)
+{
+    SharedMemoryInfo info{};
 
-    uint32_t pixelDataSize = frame.width * frame.height * 4;
+    if (m_frameRing.GetSlotCount() == 0)
+    {
+        uint32_t slotCount = request.slotCount ? std::min(request.slotCount, kMaxSharedSlotCount) : kDefaultSharedSlotCount;
+        uint32_t maxFrameBytes = request.maxFrameBytes ? std::min(request.maxFrameBytes, kMaxSharedFrameBytes) : kDefaultSharedFrameBytes;
+        m_frameRing.Create(slotCount, maxFrameBytes);
+    }
 
-    MsgHeader msgHeader { MsgType::Frame, static_cast<uint32_t>(12 + pixelDataSize) };
-    if (send(clientSocket, reinterpret_cast<const char*>(&msgHeader), sizeof(msgHeader), 0) == SOCKET_ERROR)
+    // An existing ring is reused as is; the reply tells the client its real geometry
+    if (m_frameRing.GetSlotCount() > 0)
     {
-        return false;
+        std::snprintf(info.mappingName, sizeof(info.mappingName), "%s", m_frameRing.GetMappingName().c_str());
+        std::snprintf(info.eventName, sizeof(info.eventName), "%s", m_frameRing.GetEventName().c_str());
+        info.slotCount = m_frameRing.GetSlotCount();
+        info.slotStride = m_frameRing.GetSlotStride();
+        info.maxFrameBytes = m_frameRing.GetMaxFrameBytes();
+        info.mappingSize = m_frameRing.GetMappingSize();
     }
 
-    uint32_t frameInfo[3] = { frame.width, frame.height, frame.eye };
-    if (send(clientSocket, reinterpret_cast<const char*>(frameInfo), sizeof(frameInfo), 0) == SOCKET_ERROR)
+    if (SendMsg(MsgType::SharedMemoryInfo, &info, sizeof(info)) && info.slotCount > 0)
     {
-        return false;
+        m_sharedMemoryActive = true;
     }
+}
 
-    if (send(clientSocket, reinterpret_cast<const char*>(frame.data), pixelDataSize, 0) == SOCKET_ERROR)
+FrameRing* SocketManager::GetSharedFrameRing()
+{
+    if (!connected || !m_sharedMemoryActive)
+        return nullptr;
+
+    return &m_frameRing;
+}
+
+// Holds sendMtx for one message. Priority messages queued before or while it is written go out
+// right before or after it, so they wait for at most the message already on the wire.
+class SocketManager::SendLock
+{
+public:
+    explicit SendLock(SocketManager& socket) :
+        m_socket(socket),
+        m_lock(socket.sendMtx)
+    {
+        m_socket.FlushPriorityMsgs();
+    }
+
+    ~SendLock()
     {
+        m_socket.FlushPriorityMsgs();
+        m_lock.unlock();
+
+        // One queued after the flush above found sendMtx taken and left it to us
+        if (m_socket.m_priorityPending)
+        {
+            std::unique_lock<std::mutex> lock(m_socket.sendMtx, std::try_to_lock);
+            if (lock.owns_lock())
+                m_socket.FlushPriorityMsgs();
+        }
+    }
+
+private:
+    SocketManager& m_socket;
+    std::unique_lock<std::mutex> m_lock;
+};
+
+void SocketManager::FlushPriorityMsgs()
+{
+    if (!m_priorityPending)
+        return;
+
+    uint64_t queuedUs;
+    {
+        std::lock_guard<std::mutex> lock(m_priorityMtx);
+        m_prioritySending.swap(m_priorityMsgs);
+        m_priorityMsgs.clear();
+        queuedUs = m_priorityQueuedUs;
+        m_priorityPending = false;
+    }
+    if (m_prioritySending.empty() || !connected)
+        return;
+
+    net::Buffer buffer = net::MakeBuffer(m_prioritySending.data(), static_cast<uint32_t>(m_prioritySending.size()));
+    if (SendAll(clientSocket, &buffer, 1))
+        s_priorityDelay.Record(GetDriverTimeUs() - queuedUs);
+}
+
+bool SocketManager::SendPriorityMsg(MsgType type, const void* data, uint32_t size)
+{
+    if (!connected)
         return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_priorityMtx);
+        if (m_priorityMsgs.empty())
+            m_priorityQueuedUs = GetDriverTimeUs();
+
+        MsgHeader msgHeader { type, size };
+        const auto* header = reinterpret_cast<const uint8_t*>(&msgHeader);
+        m_priorityMsgs.insert(m_priorityMsgs.end(), header, header + sizeof(msgHeader));
+        m_priorityMsgs.insert(m_priorityMsgs.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        m_priorityPending = true;
     }
+    s_priorityMessages.Add();
 
+    // Whoever holds sendMtx sends it when their current message is done
+    std::unique_lock<std::mutex> lock(sendMtx, std::try_to_lock);
+    if (lock.owns_lock())
+        FlushPriorityMsgs();
     return true;
 }
+
+bool SocketManager::SendHaptic(const Haptic& haptic)
+{
+    return SendPriorityMsg(MsgType::Haptic, &haptic, sizeof(haptic));
+}
+
+bool SocketManager::SendMsg(MsgType type, const void* data, uint32_t size)
+{
+    if (!connected)
+        return false;
+
+    SendLock lock(*this);
+
+    MsgHeader msgHeader { type, size };
+    net::Buffer buffers[2] = {
+        net::MakeBuffer(&msgHeader, sizeof(msgHeader)),
+        net::MakeBuffer(data, size)
+    };
+
+    return SendAll(clientSocket, buffers, 2);
+}
+
+bool SocketManager::SendFrame(const Frame& frame, const FrameMetadata& metadata)
+{
+    if (!connected)
+        return false;
+
+    SendLock lock(*this);
+
+    FrameInfo frameInfo { frame.width, frame.height, frame.eye, frame.codec, frame.format };
+    FrameMetadata sentMetadata = metadata;
+    MsgHeader msgHeader { MsgType::Frame, static_cast<uint32_t>(sizeof(frameInfo) + sizeof(sentMetadata) + frame.size) };
+
+    // Header, frame info, metadata and payload go out in a single gathered write
+    net::Buffer buffers[4] = {
+        net::MakeBuffer(&msgHeader, sizeof(msgHeader)),
+        net::MakeBuffer(&frameInfo, sizeof(frameInfo)),
+        net::MakeBuffer(&sentMetadata, sizeof(sentMetadata)),
+        net::MakeBuffer(frame.data, frame.size)
+    };
+
+    sentMetadata.sendUs = GetDriverTimeUs();
+    return SendAll(clientSocket, buffers, 4);
+}
+
+bool SocketManager::SendFrameTiming(const FrameTimingReport& report)
+{
+    return SendMsg(MsgType::FrameTiming, &report, sizeof(report));
+}
+
+bool SocketManager::SendStereoFrame(const FrameMetadata& metadata, StereoLayout layout, const Frame& left, const Frame& right)
+{
+    if (!connected)
+        return false;
+
+    SendLock lock(*this);
+
+    StereoFrameInfo info {
+        metadata.frameIndex,
+        layout,
+        0,
+        {
+            { left.width, left.height, left.eye, left.codec, left.format },
+            { right.width, right.height, right.eye, right.codec, right.format }
+        },
+        { left.size, right.size }
+    };
+    FrameMetadata sentMetadata = metadata;
+    MsgHeader msgHeader { MsgType::StereoFrame, static_cast<uint32_t>(sizeof(info) + sizeof(sentMetadata) + left.size + right.size) };
+
+    // Both eyes share one header and go out in a single gathered write
+    net::Buffer buffers[5] = {
+        net::MakeBuffer(&msgHeader, sizeof(msgHeader)),
+        net::MakeBuffer(&info, sizeof(info)),
+        net::MakeBuffer(&sentMetadata, sizeof(sentMetadata)),
+        net::MakeBuffer(left.data, left.size),
+        net::MakeBuffer(right.data, right.size)
+    };
+
+    sentMetadata.sendUs = GetDriverTimeUs();
+    return SendAll(clientSocket, buffers, right.size > 0 ? 5 : 4);
+}
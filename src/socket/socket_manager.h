@@ -5,17 +5,43 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <vector>
 #include <atomic>
-#include <d3d11.h>
-#include <wrl/client.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
+#include "socket_platform.h"
 #include "../mpsc/channel.h"
+#include "../shm/frame_ring.h"
+#include "../codec/frame_codec.h"
+#include "../image/convert.h"
+#include "../timing/frame_timer.h"
+#include "../frame/frame_subscription.h"
+#include "../frame/frame_metadata.h"
+#include "../metrics/metrics.h"
+#include "../trace/trace.h"
+#include "../control/control.h"
+#include "../thread/seqlock.h"
+#include "../provider/device_activity.h"
 
 enum class MsgType : uint32_t {
     Frame = 0,
     BodyPosition = 1,
-    Controller = 2
+    Controller = 2,
+    SharedMemoryRequest = 3,
+    SharedMemoryInfo = 4,
+    CodecRequest = 5,
+    OutputSpec = 6,
+    StereoRequest = 7,
+    StereoFrame = 8,
+    TimingRequest = 9,
+    FrameTiming = 10,
+    Subscription = 11,
+    StatsRequest = 12,  // No payload
+    Stats = 13,         // Metrics snapshot as UTF-8 JSON, see metrics::Registry::FormatJson
+    TraceRequest = 14,
+    Trace = 15,         // Chrome trace event JSON, see trace::ExportChromeJson
+    Control = 16,       // UTF-8 command, see control::Registry::Execute
+    ControlReply = 17,  // UTF-8 reply to a Control message
+    DeviceSetup = 18,
+    Haptic = 19         // Driver -> client, jumps ahead of queued frame data
 };
 
 struct MsgHeader {
@@ -28,6 +54,36 @@ struct Frame {
     uint32_t width;
     uint32_t height;
     uint32_t eye;
+    FrameCodec codec;
+    PixelFormat format;
+    uint32_t size;
+};
+
+// Wire layout following the MsgHeader of a Frame message, then a FrameMetadata and the payload
+struct FrameInfo {
+    uint32_t width;
+    uint32_t height;
+    uint32_t eye;
+    FrameCodec codec;
+    PixelFormat format;
+};
+
+// How a StereoFrame message packs the two eyes
+enum class StereoLayout : uint32_t {
+    Sequential = 0,  // Left eye payload followed by the right eye payload
+    SideBySide = 1   // One image with the left eye in the left half of every row
+};
+
+// Wire layout following the MsgHeader of a StereoFrame message, then a FrameMetadata and the payloads.
+// Both eyes come from the same Present. SideBySide sends a single (width0 + width1) x height
+// image of sizes[0] bytes; eyes[] still describe each half and sizes[1] is 0.
+// Side by side needs equal heights and a non-planar format, otherwise Sequential is used.
+struct StereoFrameInfo {
+    uint64_t frameIndex;
+    StereoLayout layout;
+    uint32_t reserved;
+    FrameInfo eyes[2];
+    uint32_t sizes[2];
 };
 
 #pragma pack(push, 1)
@@ -67,6 +123,80 @@ struct Pose {
     }
 };
 
+// Head pose stamped on arrival, so frames rendered from it can name it in their FrameMetadata
+struct PoseSample {
+    Pose pose;
+    uint64_t sequence;    // BodyPosition messages on this connection, from 1
+    uint64_t receivedUs;  // GetDriverTimeUs
+};
+
+// Client asks for frames over shared memory instead of TCP. Zero fields use defaults.
+struct SharedMemoryRequest {
+    uint32_t slotCount;
+    uint32_t maxFrameBytes;
+};
+
+// Driver reply to SharedMemoryRequest. slotCount is 0 if shared memory is unavailable.
+struct SharedMemoryInfo {
+    char mappingName[64];
+    char eventName[64];
+    uint32_t slotCount;
+    uint32_t slotStride;
+    uint32_t maxFrameBytes;
+    uint32_t reserved;
+    uint64_t mappingSize;
+};
+
+// Client selects the codec for subsequent frames
+struct CodecRequest {
+    FrameCodec codec;
+};
+
+// Client opts in to (or out of) receiving both eyes in one StereoFrame message
+struct StereoRequest {
+    uint32_t enabled;
+    StereoLayout layout;
+};
+
+// Client opts in to a FrameTiming message (a FrameTimingReport) after each frame message
+struct TimingRequest {
+    uint32_t enabled;
+};
+
+// Client declares the controllers and trackers it will drive, so they appear before their first pose.
+// Devices only ever get added; poses alone also add them.
+struct DeviceSetup {
+    uint32_t devices;  // DeviceBit(DeviceRole) mask
+};
+
+// A vibration a game asked a controller for
+struct Haptic {
+    uint32_t device;         // DeviceRole, LeftHand or RightHand
+    float durationSeconds;
+    float frequency;         // Hz
+    float amplitude;         // 0..1
+    uint64_t timestampUs;    // GetDriverTimeUs when the game triggered it
+};
+
+// Starts tracing, or stops it and replies with a Trace message holding everything recorded since
+struct TraceRequest {
+    uint32_t enabled;
+};
+
+// Client-requested output size, region of interest and pixel format, applied to both eyes
+// before sending. A zero width or height follows the region's aspect ratio; both zero keep
+// native resolution. The region is normalized to the eye image; an empty region means the whole eye.
+struct OutputSpec {
+    uint32_t width;
+    uint32_t height;
+    float roiMinU;
+    float roiMinV;
+    float roiMaxU;
+    float roiMaxV;
+    ResampleFilter filter;
+    PixelFormat format;
+};
+
 struct BodyPosition {
     // HMD
     Pose head;
@@ -105,7 +235,7 @@ class SocketManager
 {
 public:
     SocketManager(
-        mpsc::Sender<Pose> headPoseSender,
+        mpsc::Sender<PoseSample> headPoseSender,
         mpsc::Sender<ControllerInput> leftControllerInputSender,
         mpsc::Sender<ControllerInput> rightControllerInputSender,
         mpsc::Sender<Pose> leftHandPoseSender,
@@ -114,14 +244,46 @@ public:
     );
     ~SocketManager();
     std::expected<int, std::string> Init();
-    bool SendFrame(const Frame& frame);
+    // metadata.sendUs is stamped here
+    bool SendFrame(const Frame& frame, const FrameMetadata& metadata);
+    // For SideBySide, right.data is unused and right.size must be 0
+    bool SendStereoFrame(const FrameMetadata& metadata, StereoLayout layout, const Frame& left, const Frame& right);
+    bool SendFrameTiming(const FrameTimingReport& report);
+    // Goes out ahead of any frame not yet being written and never waits for one to finish
+    bool SendHaptic(const Haptic& haptic);
+    bool IsConnected() const { return connected; }
+
+    // Ring to write frames into when the connected client negotiated shared memory, else nullptr
+    FrameRing* GetSharedFrameRing();
+
+    FrameCodec GetFrameCodec() const { return m_frameCodec; }
+    OutputSpec GetOutputSpec() const { return m_outputSpec.Load(); }
+    bool IsStereoEnabled() const { return m_stereoEnabled; }
+    StereoLayout GetStereoLayout() const { return m_stereoLayout; }
+    bool IsTimingEnabled() const { return m_timingEnabled; }
+    FrameSubscription GetFrameSubscription() const { return m_subscription.Load(); }
+    // Changes whenever a new client connects, so per-client encoder state can be reset
+    uint64_t GetConnectionId() const { return m_connectionId; }
+    // Changes on connect and on every client request that affects frames (codec, output, ...)
+    uint64_t GetSettingsVersion() const { return m_settingsVersion; }
+    // DeviceBit mask of every device any client has sent data for or declared
+    uint32_t GetRequestedDevices() const { return m_requestedDevices.load(std::memory_order_relaxed); }
 
 private:
+    class SendLock;
+
     void Connect(std::stop_token st);
     void Receive(std::stop_token st);
+    bool SendMsg(MsgType type, const void* data, uint32_t size);
+    // Queues a small message for whichever thread holds sendMtx next, or sends it right away if none does
+    bool SendPriorityMsg(MsgType type, const void* data, uint32_t size);
+    // Caller holds sendMtx
+    void FlushPriorityMsgs();
+    void EnableSharedMemory(const SharedMemoryRequest& request);
+    void RequestDevices(uint32_t devices);
 
     // Channel senders
-    mpsc::Sender<Pose> m_headPoseSender;
+    mpsc::Sender<PoseSample> m_headPoseSender;
     mpsc::Sender<ControllerInput> m_leftControllerInputSender;
     mpsc::Sender<ControllerInput> m_rightControllerInputSender;
     mpsc::Sender<Pose> m_leftHandPoseSender;
@@ -135,4 +297,34 @@ private:
     std::jthread receiverThread;
     std::atomic<bool> connected{false};
     std::mutex sendMtx;
+
+    // Priority messages waiting for sendMtx, headers included, and when the oldest was queued
+    std::mutex m_priorityMtx;
+    std::vector<uint8_t> m_priorityMsgs;
+    uint64_t m_priorityQueuedUs = 0;
+    std::atomic<bool> m_priorityPending{false};
+    // What FlushPriorityMsgs is writing, sendMtx only
+    std::vector<uint8_t> m_prioritySending;
+
+    // Shared memory frame transport, created on first request and kept for later clients
+    FrameRing m_frameRing;
+    std::atomic<bool> m_sharedMemoryActive{false};
+
+    std::atomic<FrameCodec> m_frameCodec{FrameCodec::Raw};
+
+    std::atomic<bool> m_stereoEnabled{false};
+    std::atomic<StereoLayout> m_stereoLayout{StereoLayout::Sequential};
+
+    std::atomic<bool> m_timingEnabled{false};
+
+    // Receive thread only
+    uint64_t m_poseSequence = 0;
+
+    // Read by Present every frame, so never behind a lock. Written by the connection and
+    // receive threads, which don't overlap.
+    SeqLock<FrameSubscription> m_subscription{kDefaultFrameSubscription};
+    SeqLock<OutputSpec> m_outputSpec;
+    std::atomic<uint64_t> m_connectionId{0};
+    std::atomic<uint64_t> m_settingsVersion{0};
+    std::atomic<uint32_t> m_requestedDevices{0};
 };
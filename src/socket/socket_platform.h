@@ -0,0 +1,100 @@
+#pragma once
+
+// The few socket calls SocketManager needs, on Winsock or BSD sockets. Outside Windows the
+// Winsock names it uses (SOCKET, INVALID_SOCKET, closesocket, ...) map onto their POSIX equivalents.
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+
+inline int closesocket(SOCKET socket) { return close(socket); }
+#endif
+
+namespace net {
+
+#ifdef _WIN32
+// One piece of a gathered send
+using Buffer = WSABUF;
+
+inline Buffer MakeBuffer(const void* data, size_t size) { return Buffer{ static_cast<ULONG>(size), static_cast<CHAR*>(const_cast<void*>(data)) }; }
+inline size_t GetBufferSize(const Buffer& buffer) { return buffer.len; }
+inline void AdvanceBuffer(Buffer& buffer, size_t bytes) { buffer.buf += bytes; buffer.len -= static_cast<ULONG>(bytes); }
+
+// Bytes written, which may stop short of the total, or -1 on error
+inline int64_t SendGathered(SOCKET socket, Buffer* buffers, uint32_t count)
+{
+    DWORD sent = 0;
+    return WSASend(socket, buffers, count, &sent, 0, nullptr, nullptr) == SOCKET_ERROR ? -1 : static_cast<int64_t>(sent);
+}
+
+inline bool Startup()
+{
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+}
+
+inline void Cleanup() { WSACleanup(); }
+
+constexpr int kShutdownBoth = SD_BOTH;
+
+// SO_REUSEADDR would let another process take the port on Winsock; rebinding is already allowed
+inline void AllowAddressReuse(SOCKET) {}
+#else
+using Buffer = iovec;
+
+inline Buffer MakeBuffer(const void* data, size_t size) { return Buffer{ const_cast<void*>(data), size }; }
+inline size_t GetBufferSize(const Buffer& buffer) { return buffer.iov_len; }
+inline void AdvanceBuffer(Buffer& buffer, size_t bytes) { buffer.iov_base = static_cast<uint8_t*>(buffer.iov_base) + bytes; buffer.iov_len -= bytes; }
+
+// A client that hung up makes this fail rather than raising SIGPIPE
+inline int64_t SendGathered(SOCKET socket, Buffer* buffers, uint32_t count)
+{
+    msghdr message{};
+    message.msg_iov = buffers;
+    message.msg_iovlen = count;
+    return sendmsg(socket, &message, MSG_NOSIGNAL);
+}
+
+inline bool Startup() { return true; }
+inline void Cleanup() {}
+
+constexpr int kShutdownBoth = SHUT_RDWR;
+
+// Lets a restarted driver listen again while the last connection is still in TIME_WAIT
+inline void AllowAddressReuse(SOCKET socket)
+{
+    int reuse = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+}
+#endif
+
+// Wakes any thread blocked in accept or recv on the socket; on Linux closing it alone doesn't
+inline void Shutdown(SOCKET socket)
+{
+    if (socket != INVALID_SOCKET)
+        shutdown(socket, kShutdownBoth);
+}
+
+inline void Close(SOCKET socket)
+{
+    if (socket == INVALID_SOCKET)
+        return;
+    Shutdown(socket);
+    closesocket(socket);
+}
+
+} // namespace net
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// A small value with one writer and any number of readers, none of which take a lock.
+// Readers copy it and retry if a write overlapped; the writer never waits. The value is kept
+// in atomic words so an overlapping copy is well defined, just discarded.
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+
+public:
+    SeqLock() : SeqLock(T{}) {}
+    explicit SeqLock(const T& value) { Store(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Concurrent writers must be serialized by the caller
+    void Store(const T& value)
+    {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        // Odd while the words are being replaced
+        uint64_t version = m_version.load(std::memory_order_relaxed);
+        m_version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++)
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        m_version.store(version + 2, std::memory_order_release);
+    }
+
+    T Load() const
+    {
+        uint64_t words[kWords];
+        uint64_t version;
+        do
+        {
+            version = m_version.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; i++)
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((version & 1) || version != m_version.load(std::memory_order_relaxed));
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+    std::atomic<uint64_t> m_version{0};
+    std::atomic<uint64_t> m_words[kWords];
+};
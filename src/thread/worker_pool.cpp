@@ -0,0 +1,95 @@
+#include "worker_pool.h"
+#include <algorithm>
+#include "../trace/trace.h"
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+{
+    m_threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        m_threads.emplace_back([this](std::stop_token st) { WorkerThreadFunc(st); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    for (auto& thread : m_threads)
+    {
+        thread.request_stop();
+    }
+    m_threads.clear();
+}
+
+WorkerPool& WorkerPool::Shared()
+{
+    static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+void WorkerPool::Run(uint32_t count, const std::function<void(uint32_t)>& task)
+{
+    if (count == 0)
+        return;
+
+    if (m_threads.empty() || count == 1)
+    {
+        for (uint32_t i = 0; i < count; i++)
+            task(i);
+        return;
+    }
+
+    std::latch done(count);
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (uint32_t i = 0; i < count; i++)
+            m_jobs.push_back(Job{ &task, i, &done });
+    }
+    m_cv.notify_all();
+
+    // Help out until the queue is empty, then wait for stripes still running elsewhere
+    while (RunOne())
+    {
+    }
+    done.wait();
+}
+
+bool WorkerPool::RunOne()
+{
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_jobs.empty())
+            return false;
+        job = m_jobs.front();
+        m_jobs.pop_front();
+    }
+
+    {
+        OVD_TRACE_SCOPE_ARG("worker.task", "index", job.index);
+        (*job.task)(job.index);
+    }
+    job.done->count_down();
+    return true;
+}
+
+void WorkerPool::WorkerThreadFunc(std::stop_token st)
+{
+    trace::SetThreadName("Worker");
+    while (!st.stop_requested())
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            if (!m_cv.wait(lock, st, [this] { return !m_jobs.empty(); }))
+                return;
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        {
+            OVD_TRACE_SCOPE_ARG("worker.task", "index", job.index);
+            (*job.task)(job.index);
+        }
+        job.done->count_down();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <latch>
+#include <cstdint>
+#include <algorithm>
+
+// Persistent threads for splitting per-frame work into stripes. Spawning threads per frame
+// (std::async) costs more than converting a stripe, so the threads live as long as the pool.
+class WorkerPool
+{
+public:
+    // threadCount workers plus the calling thread share the work; 0 runs everything inline
+    explicit WorkerPool(uint32_t threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs task(0) .. task(count - 1) and returns once all of them have finished.
+    // The calling thread works through the queue too instead of sleeping.
+    void Run(uint32_t count, const std::function<void(uint32_t)>& task);
+
+    // Splits rows into about one stripe per thread and calls fn(rowBegin, rowEnd) for each.
+    // Stripes start on even rows so 2x2 subsampled chroma never straddles two stripes.
+    template<typename Fn>
+    void RunStripes(uint32_t rows, Fn&& fn)
+    {
+        uint32_t concurrency = GetConcurrency();
+        uint32_t stripeRows = std::max(kMinStripeRows, ((rows + concurrency - 1) / concurrency + 1) & ~1u);
+        uint32_t count = (rows + stripeRows - 1) / stripeRows;
+        Run(count, [&](uint32_t s) {
+            uint32_t begin = s * stripeRows;
+            fn(begin, std::min(begin + stripeRows, rows));
+        });
+    }
+
+    // Number of threads that can work on a Run, including the caller
+    uint32_t GetConcurrency() const { return static_cast<uint32_t>(m_threads.size()) + 1; }
+
+    // Process-wide pool with one worker per additional hardware thread
+    static WorkerPool& Shared();
+
+private:
+    // Below this a stripe costs more to hand off than to convert
+    static constexpr uint32_t kMinStripeRows = 16;
+
+    struct Job {
+        const std::function<void(uint32_t)>* task;
+        uint32_t index;
+        std::latch* done;
+    };
+
+    void WorkerThreadFunc(std::stop_token st);
+    bool RunOne();
+
+    std::deque<Job> m_jobs;
+    std::mutex m_mtx;
+    std::condition_variable_any m_cv;
+    std::vector<std::jthread> m_threads;
+};
@@ -0,0 +1,142 @@
+#include "frame_timer.h"
+#include "../metrics/metrics.h"
+#include <thread>
+#include <algorithm>
+
+static metrics::Counter& s_droppedFrames = metrics::Registry::Get().GetCounter("display.dropped_frames");
+static metrics::Counter& s_misPresented = metrics::Registry::Get().GetCounter("display.mispresented");
+// Present to the frame leaving over the socket or landing in the shared memory ring
+static metrics::Histogram& s_presentToSent = metrics::Registry::Get().GetHistogram("frame.present_to_sent_us");
+
+// Sleep overshoots by up to a scheduler tick, so the last stretch before a vsync is spun
+static constexpr auto kSpinWindow = std::chrono::milliseconds(2);
+
+VirtualVsync::VirtualVsync(double frequencyHz)
+    : m_origin(Clock::now())
+    , m_period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(frequencyHz, 1.0))))
+{
+}
+
+uint64_t VirtualVsync::GetVsyncIndexAt(Clock::time_point t) const
+{
+    if (t <= m_origin)
+        return 0;
+    auto elapsed = t - m_origin;
+    return static_cast<uint64_t>((elapsed + m_period - Clock::duration(1)) / m_period);
+}
+
+VirtualVsync::Clock::time_point VirtualVsync::GetVsyncTime(uint64_t index) const
+{
+    return m_origin + m_period * static_cast<int64_t>(index);
+}
+
+FrameTimer::FrameTimer(double displayFrequency)
+    : m_vsync(displayFrequency)
+    , m_origin(Clock::now())
+{
+}
+
+int64_t FrameTimer::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_origin).count();
+}
+
+FrameTimer::FrameRecord* FrameTimer::FindRecord(uint64_t frameIndex)
+{
+    FrameRecord& record = m_records[frameIndex % kRecordCount];
+    return record.frameIndex.load(std::memory_order_acquire) == frameIndex ? &record : nullptr;
+}
+
+const FrameTimer::FrameRecord* FrameTimer::FindRecord(uint64_t frameIndex) const
+{
+    const FrameRecord& record = m_records[frameIndex % kRecordCount];
+    return record.frameIndex.load(std::memory_order_acquire) == frameIndex ? &record : nullptr;
+}
+
+void FrameTimer::MarkSubmitLayer()
+{
+    m_lastSubmitNs = Now();
+}
+
+void FrameTimer::MarkPresent(uint64_t frameIndex)
+{
+    FrameRecord& record = m_records[frameIndex % kRecordCount];
+    record.frameIndex.store(UINT64_MAX, std::memory_order_relaxed);
+    record.submitNs = m_lastSubmitNs.load();
+    record.presentNs = Now();
+    record.readbackNs = 0;
+    record.sentNs = 0;
+    record.frameIndex.store(frameIndex, std::memory_order_release);
+}
+
+// Both eyes mark the same frame; the later one wins, so stages end when the last eye is done
+void FrameTimer::MarkReadbackDone(uint64_t frameIndex)
+{
+    if (FrameRecord* record = FindRecord(frameIndex))
+        record->readbackNs = Now();
+}
+
+void FrameTimer::MarkSent(uint64_t frameIndex)
+{
+    if (FrameRecord* record = FindRecord(frameIndex))
+    {
+        int64_t now = Now();
+        record->sentNs = now;
+        s_presentToSent.Record(static_cast<uint64_t>(std::max<int64_t>(now - record->presentNs, 0) / 1000));
+    }
+}
+
+void FrameTimer::WaitForVsync(uint32_t framesToThrottle)
+{
+    uint64_t vsync = m_vsync.GetVsyncIndexAt(Clock::now());
+    uint64_t target = m_lastVsync == UINT64_MAX ? vsync : m_lastVsync + 1 + framesToThrottle;
+
+    // Early frames wait for their slot; late ones land on the next vsync and count as missed
+    uint32_t dropped = vsync > target ? static_cast<uint32_t>(std::min<uint64_t>(vsync - target, UINT32_MAX)) : 0;
+    vsync = std::max(vsync, target);
+
+    auto deadline = m_vsync.GetVsyncTime(vsync);
+    if (deadline - Clock::now() > kSpinWindow)
+        std::this_thread::sleep_until(deadline - kSpinWindow);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+
+    m_lastVsync = vsync;
+    m_lastDropped = dropped;
+    m_lastMisPresented = dropped > 0 ? 1 : 0;
+    m_totalPresents++;
+    m_totalDropped += dropped;
+    m_totalMisPresented += dropped > 0 ? 1 : 0;
+    s_droppedFrames.Add(dropped);
+    s_misPresented.Add(dropped > 0 ? 1 : 0);
+}
+
+PresentTiming FrameTimer::GetPresentTiming() const
+{
+    return PresentTiming{ 1, m_lastMisPresented.load(), m_lastDropped.load() };
+}
+
+FrameTimingReport FrameTimer::GetReport(uint64_t frameIndex) const
+{
+    auto micros = [](int64_t from, int64_t to) {
+        return from > 0 && to > from ? static_cast<uint32_t>(std::min<int64_t>((to - from) / 1000, UINT32_MAX)) : 0u;
+    };
+
+    FrameTimingReport report{};
+    report.frameIndex = frameIndex;
+    if (const FrameRecord* record = FindRecord(frameIndex))
+    {
+        int64_t submit = record->submitNs;
+        int64_t present = record->presentNs;
+        int64_t readback = record->readbackNs;
+        int64_t sent = record->sentNs;
+        report.submitToPresentUs = micros(submit, present);
+        report.presentToReadbackUs = micros(present, readback);
+        report.readbackToSendUs = micros(readback, sent);
+    }
+    report.vsyncPeriodUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(m_vsync.GetPeriod()).count());
+    report.totalPresents = m_totalPresents;
+    report.totalDropped = m_totalDropped;
+    report.totalMisPresented = m_totalMisPresented;
+    return report;
+}
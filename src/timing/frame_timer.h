@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+// Fixed-rate clock standing in for the scanout of a real display
+class VirtualVsync
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit VirtualVsync(double frequencyHz);
+
+    // Index of the first vsync at or after t
+    uint64_t GetVsyncIndexAt(Clock::time_point t) const;
+    Clock::time_point GetVsyncTime(uint64_t index) const;
+    Clock::duration GetPeriod() const { return m_period; }
+    double GetFrequency() const { return 1.0 / std::chrono::duration<double>(m_period).count(); }
+
+private:
+    Clock::time_point m_origin;
+    Clock::duration m_period;
+};
+
+// Where one frame's time went, reported to clients after it was sent (MsgType::FrameTiming).
+// Durations are in microseconds; totals count since the driver started.
+struct FrameTimingReport {
+    uint64_t frameIndex;
+    uint32_t submitToPresentUs;    // SubmitLayer -> Present
+    uint32_t presentToReadbackUs;  // Present -> pixels converted, includes readback pipelining
+    uint32_t readbackToSendUs;     // Converted -> handed to the socket or shared memory ring
+    uint32_t vsyncPeriodUs;
+    uint64_t totalPresents;
+    uint64_t totalDropped;
+    uint64_t totalMisPresented;
+};
+
+// What GetFrameTiming reports for the most recent frame, in SteamVR's terms
+struct PresentTiming {
+    uint32_t numFramePresents;
+    uint32_t numMisPresented;   // 1 if the frame missed the vsync it was aiming for
+    uint32_t numDroppedFrames;  // Extra vsyncs the previous frame stayed on screen
+};
+
+// Timestamps each stage of a frame and paces presents to a virtual vsync.
+// Stage marks may come from different threads; frames are kept in a small ring by index.
+class FrameTimer
+{
+public:
+    explicit FrameTimer(double displayFrequency);
+
+    void MarkSubmitLayer();
+    void MarkPresent(uint64_t frameIndex);
+    void MarkReadbackDone(uint64_t frameIndex);
+    void MarkSent(uint64_t frameIndex);
+
+    // Called from PostPresent. Blocks until the vsync the last frame is shown on, at least
+    // 1 + framesToThrottle vsyncs after the previous one, and updates drop/mispresent counts.
+    void WaitForVsync(uint32_t framesToThrottle);
+
+    double GetDisplayFrequency() const { return m_vsync.GetFrequency(); }
+    PresentTiming GetPresentTiming() const;
+    FrameTimingReport GetReport(uint64_t frameIndex) const;
+
+private:
+    using Clock = VirtualVsync::Clock;
+
+    struct FrameRecord {
+        std::atomic<uint64_t> frameIndex{UINT64_MAX};
+        std::atomic<int64_t> submitNs{0};
+        std::atomic<int64_t> presentNs{0};
+        std::atomic<int64_t> readbackNs{0};
+        std::atomic<int64_t> sentNs{0};
+    };
+
+    static constexpr size_t kRecordCount = 16;
+
+    int64_t Now() const;
+    FrameRecord* FindRecord(uint64_t frameIndex);
+    const FrameRecord* FindRecord(uint64_t frameIndex) const;
+
+    VirtualVsync m_vsync;
+    Clock::time_point m_origin;
+    FrameRecord m_records[kRecordCount];
+    std::atomic<int64_t> m_lastSubmitNs{0};
+
+    // Only touched by the present thread
+    uint64_t m_lastVsync = UINT64_MAX;
+
+    std::atomic<uint32_t> m_lastMisPresented{0};
+    std::atomic<uint32_t> m_lastDropped{0};
+    std::atomic<uint64_t> m_totalPresents{0};
+    std::atomic<uint64_t> m_totalDropped{0};
+    std::atomic<uint64_t> m_totalMisPresented{0};
+};
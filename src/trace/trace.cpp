@@ -0,0 +1,165 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+// Power of two; about 320 KB per thread that has recorded at least once
+static constexpr uint64_t kEventsPerThread = 8192;
+static constexpr uint64_t kInstant = UINT64_MAX;
+
+struct Event {
+    const char* name;
+    const char* argName;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint64_t arg;
+};
+
+// Written only by its thread. Kept after the thread exits so its events still show in dumps.
+struct ThreadBuffer {
+    uint32_t threadId;
+    std::string name;
+    std::atomic<uint64_t> head{0};
+    Event events[kEventsPerThread];
+};
+
+struct BufferList {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::atomic<uint64_t> sessionStartNs{0};
+};
+
+static BufferList& GetBufferList()
+{
+    static BufferList list;
+    return list;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local std::string t_threadName;
+
+static ThreadBuffer* GetThreadBuffer()
+{
+    if (t_buffer)
+        return t_buffer;
+
+    BufferList& list = GetBufferList();
+    std::lock_guard<std::mutex> lock(list.mtx);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->threadId = static_cast<uint32_t>(list.buffers.size() + 1);
+    buffer->name = t_threadName.empty() ? "Thread " + std::to_string(buffer->threadId) : t_threadName;
+    t_buffer = buffer.get();
+    list.buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+uint64_t Now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void SetEnabled(bool enabled)
+{
+    if (enabled && !IsEnabled())
+        GetBufferList().sessionStartNs = Now();
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SetThreadName(std::string_view name)
+{
+    if (t_threadName == name)
+        return;
+
+    t_threadName = name;
+    if (t_buffer)
+    {
+        std::lock_guard<std::mutex> lock(GetBufferList().mtx);
+        t_buffer->name = t_threadName;
+    }
+}
+
+void Record(const char* name, uint64_t startNs, uint64_t durationNs, const char* argName, uint64_t arg)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head & (kEventsPerThread - 1)] = Event{ name, argName, startNs, durationNs, arg };
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void RecordInstant(const char* name, const char* argName, uint64_t arg)
+{
+    Record(name, Now(), kInstant, argName, arg);
+}
+
+static void Append(std::string& out, const char* format, auto... args)
+{
+    char text[512];
+    int length = std::snprintf(text, sizeof(text), format, args...);
+    if (length > 0)
+        out.append(text, std::min<size_t>(static_cast<size_t>(length), sizeof(text) - 1));
+}
+
+std::string ExportChromeJson()
+{
+    BufferList& list = GetBufferList();
+    uint64_t sessionStart = list.sessionStartNs;
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&first]() { const char* s = first ? "" : ","; first = false; return s; };
+
+    std::lock_guard<std::mutex> lock(list.mtx);
+    std::vector<Event> events;
+    for (const auto& buffer : list.buffers)
+    {
+        Append(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+               separator(), buffer->threadId, buffer->name.c_str());
+
+        // The owner keeps writing while we copy; anything it may have lapped is thrown away after
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > kEventsPerThread ? head - kEventsPerThread : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++)
+            events.push_back(buffer->events[i & (kEventsPerThread - 1)]);
+        uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        uint64_t firstValid = headAfter > kEventsPerThread ? headAfter - kEventsPerThread : 0;
+
+        for (uint64_t i = std::max(begin, firstValid); i < head; i++)
+        {
+            const Event& event = events[i - begin];
+            if (event.startNs < sessionStart)
+                continue;
+
+            double ts = (event.startNs - sessionStart) / 1000.0;
+            if (event.durationNs == kInstant)
+                Append(out, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", separator(), event.name, ts, buffer->threadId);
+            else
+                Append(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u", separator(), event.name, ts, event.durationNs / 1000.0, buffer->threadId);
+
+            if (event.argName)
+                Append(out, ",\"args\":{\"%s\":%llu}", event.argName, static_cast<unsigned long long>(event.arg));
+            out += "}";
+        }
+    }
+    out += "]}";
+    return out;
+}
+
+bool WriteChromeTrace(const std::string& path)
+{
+    std::string json = ExportChromeJson();
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+} // namespace trace
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Timeline tracing. Each thread records into its own ring buffer, so recording takes no locks;
+// when tracing is off a trace point is one relaxed load and a branch. Define OVD_DISABLE_TRACING
+// to compile the trace points out entirely.
+//
+// Event and argument names must be string literals (or otherwise outlive the trace).
+
+namespace trace {
+
+inline std::atomic<bool> g_enabled{false};
+
+inline bool IsEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+// Turning tracing on starts a new session; dumps only include events recorded since
+void SetEnabled(bool enabled);
+
+// Shown as the thread's track name, can be called before tracing is enabled
+void SetThreadName(std::string_view name);
+
+// Nanoseconds on the trace clock
+uint64_t Now();
+void Record(const char* name, uint64_t startNs, uint64_t durationNs, const char* argName, uint64_t arg);
+void RecordInstant(const char* name, const char* argName, uint64_t arg);
+
+// Chrome trace event JSON, opens in chrome://tracing and ui.perfetto.dev
+std::string ExportChromeJson();
+bool WriteChromeTrace(const std::string& path);
+
+// Records a complete event covering its lifetime
+class Scope
+{
+public:
+    explicit Scope(const char* name, const char* argName = nullptr, uint64_t arg = 0)
+        : m_name(IsEnabled() ? name : nullptr)
+        , m_argName(argName)
+        , m_arg(arg)
+        , m_start(m_name ? Now() : 0)
+    {
+    }
+
+    ~Scope()
+    {
+        if (m_name)
+            Record(m_name, m_start, Now() - m_start, m_argName, m_arg);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // For arguments only known partway through the scope
+    void SetArg(const char* argName, uint64_t arg)
+    {
+        m_argName = argName;
+        m_arg = arg;
+    }
+
+private:
+    const char* m_name;
+    const char* m_argName;
+    uint64_t m_arg;
+    uint64_t m_start;
+};
+
+} // namespace trace
+
+#define OVD_TRACE_CONCAT_INNER(a, b) a##b
+#define OVD_TRACE_CONCAT(a, b) OVD_TRACE_CONCAT_INNER(a, b)
+
+#if defined(OVD_DISABLE_TRACING)
+    #define OVD_TRACE_SCOPE(name)
+    #define OVD_TRACE_SCOPE_ARG(name, argName, arg)
+    #define OVD_TRACE_INSTANT(name, argName, arg)
+#else
+    #define OVD_TRACE_SCOPE(name) ::trace::Scope OVD_TRACE_CONCAT(traceScope, __LINE__)(name)
+    #define OVD_TRACE_SCOPE_ARG(name, argName, arg) ::trace::Scope OVD_TRACE_CONCAT(traceScope, __LINE__)(name, argName, arg)
+    #define OVD_TRACE_INSTANT(name, argName, arg) do { if (::trace::IsEnabled()) ::trace::RecordInstant(name, argName, arg); } while (0)
+#endif
@@ -5,6 +5,10 @@
 #include <thread>
 #include "../socket/socket_manager.h"
 #include "../mpsc/channel.h"
+#include "../metrics/pose_metrics.h"
+#include "../trace/trace.h"
+#include "../control/control.h"
+#include "../provider/device_activity.h"
 
 enum class TrackerRole
 {
@@ -0,0 +1,545 @@
+// Load generator and latency probe for the driver's TCP protocol. Opens N connections, sends
+// BodyPosition and Controller messages at the given rates and pattern, consumes frames at a
+// capped speed and reports throughput and latency per connection.
+//
+// Latency is measured without comparing clocks across machines: every frame names the newest
+// BodyPosition the HMD had applied when it was submitted (FrameMetadata::poseSequence), so
+// "pose -> frame" is the time from sending a pose to receiving the first frame rendered from it.
+// Against a driver on the same host, "send -> receive" adds the transport time of each frame
+// from the driver's sendUs stamp.
+//
+// The driver serves one client at a time; extra connections wait in its accept backlog and are
+// reported as not served. --stand-in (not on Windows) runs the headless driver core in-process,
+// and --haptic-rate then plays a game buzzing the controllers, timing each vibration from the
+// game's request to its arrival here through whatever frame traffic is queued.
+//
+//   ovd_loadgen [--host=127.0.0.1] [--port=21213] [--connections=1] [--duration=10]
+//               [--pose-rate=90] [--pattern=steady|burst|jitter] [--burst=8]
+//               [--body=head|hands|full] [--controller-rate=0] [--read-rate=0]
+//               [--eyes=3] [--max-fps=0] [--stand-in] [--haptic-rate=0]
+
+#include "socket/socket_manager.h"
+#include "frame/frame_metadata.h"
+#include "frame/frame_subscription.h"
+#include "metrics/metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef OVD_LOADGEN_STANDIN
+#include "standin/stand_in.h"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+enum class Pattern {
+    Steady,  // Evenly spaced
+    Burst,   // burstSize messages back to back, same average rate
+    Jitter   // Each message up to half a period early or late
+};
+
+enum class BodyParts {
+    Head,
+    Hands,  // Head and both controllers
+    Full    // Every tracker too
+};
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 21213;
+    uint32_t connections = 1;
+    double duration = 10.0;
+    double poseRate = 90.0;
+    Pattern pattern = Pattern::Steady;
+    uint32_t burstSize = 8;
+    BodyParts body = BodyParts::Hands;
+    double controllerRate = 0.0;
+    double readRate = 0.0;  // MB/s, 0 for as fast as possible
+    int eyes = -1;          // Driver default unless given
+    float maxFps = 0.0f;
+    bool standIn = false;
+    double hapticRate = 0.0;  // Stand-in only
+};
+
+struct ConnectionStats {
+    bool connected = false;
+    bool served = false;  // Got at least one message back
+    uint64_t posesSent = 0;
+    uint64_t controllerSent = 0;
+    uint64_t messages = 0;
+    uint64_t frames = 0;
+    uint64_t frameBytes = 0;
+    std::vector<uint64_t> poseToFrameUs;
+    std::vector<uint64_t> transitUs;
+    std::vector<uint64_t> hapticUs;
+    metrics::Histogram poseToFrameHistogram;
+};
+
+static bool SendAll(SOCKET socket, const void* data, size_t size)
+{
+    net::Buffer buffer = net::MakeBuffer(data, size);
+    while (net::GetBufferSize(buffer) > 0)
+    {
+        int64_t sent = net::SendGathered(socket, &buffer, 1);
+        if (sent <= 0)
+            return false;
+        net::AdvanceBuffer(buffer, static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+static bool SendMsg(SOCKET socket, MsgType type, const void* data, uint32_t size)
+{
+    MsgHeader header{ type, size };
+    return SendAll(socket, &header, sizeof(header)) && SendAll(socket, data, size);
+}
+
+static bool RecvAll(SOCKET socket, void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0)
+    {
+        int received = recv(socket, bytes, static_cast<int>(size), MSG_WAITALL);
+        if (received <= 0)
+            return false;
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+static SOCKET Connect(const Options& options)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1)
+        return INVALID_SOCKET;
+
+    SOCKET client = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (client == INVALID_SOCKET)
+        return INVALID_SOCKET;
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+    {
+        net::Close(client);
+        return INVALID_SOCKET;
+    }
+
+    int noDelay = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    return client;
+}
+
+static bool IsLoopback(const std::string& host)
+{
+    return host.starts_with("127.") || host == "::1";
+}
+
+// A head slowly circling, so reprojecting clients see plausible motion
+static BodyPosition MakeBody(BodyParts parts, double seconds)
+{
+    float x = static_cast<float>(0.1 * std::cos(seconds));
+    float z = static_cast<float>(0.1 * std::sin(seconds));
+    auto at = [](float px, float py, float pz) { return Pose{ px, py, pz, 1.0f, 0.0f, 0.0f, 0.0f }; };
+
+    BodyPosition body{};
+    body.head = at(x, 1.7f, z);
+    if (parts == BodyParts::Head)
+        return body;
+
+    body.leftHand = at(x - 0.2f, 1.2f, z - 0.3f);
+    body.rightHand = at(x + 0.2f, 1.2f, z - 0.3f);
+    if (parts == BodyParts::Hands)
+        return body;
+
+    body.waist = at(x, 1.0f, z);
+    body.chest = at(x, 1.35f, z);
+    body.leftFoot = at(x - 0.1f, 0.05f, z);
+    body.rightFoot = at(x + 0.1f, 0.05f, z);
+    body.leftKnee = at(x - 0.1f, 0.5f, z);
+    body.rightKnee = at(x + 0.1f, 0.5f, z);
+    body.leftElbow = at(x - 0.3f, 1.2f, z);
+    body.rightElbow = at(x + 0.3f, 1.2f, z);
+    body.leftShoulder = at(x - 0.18f, 1.45f, z);
+    body.rightShoulder = at(x + 0.18f, 1.45f, z);
+    return body;
+}
+
+class Connection
+{
+public:
+    Connection(const Options& options, uint32_t id) :
+        m_options(options),
+        m_id(id),
+        m_poseSentUs(static_cast<size_t>(options.duration * options.poseRate) + options.burstSize + 64)
+    {}
+
+    bool Start()
+    {
+        m_socket = Connect(m_options);
+        if (m_socket == INVALID_SOCKET)
+            return false;
+        m_stats.connected = true;
+
+        // Queued behind an earlier client, these only reach the driver once it is served
+        if (m_options.eyes >= 0 || m_options.maxFps > 0.0f)
+        {
+            FrameSubscription subscription = kDefaultFrameSubscription;
+            if (m_options.eyes >= 0)
+                subscription.eyeMask = static_cast<uint32_t>(m_options.eyes);
+            subscription.maxFps = m_options.maxFps;
+            SendMsg(m_socket, MsgType::Subscription, &subscription, sizeof(subscription));
+        }
+
+        m_receiver = std::jthread([this] { ReceiveThreadFunc(); });
+        m_sender = std::jthread([this](std::stop_token st) { SendThreadFunc(st); });
+        return true;
+    }
+
+    // Shutting the socket down also wakes a sender blocked on a connection the driver isn't reading
+    void Stop()
+    {
+        if (m_socket == INVALID_SOCKET)
+            return;
+        m_sender.request_stop();
+        net::Shutdown(m_socket);
+        m_sender.join();
+        m_receiver.join();
+        net::Close(m_socket);
+        m_socket = INVALID_SOCKET;
+    }
+
+    uint32_t GetId() const { return m_id; }
+    ConnectionStats& GetStats() { return m_stats; }
+
+private:
+    void SendThreadFunc(std::stop_token st)
+    {
+        std::mt19937 random(m_id + 1);
+        std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+
+        auto posePeriod = std::chrono::duration<double>(1.0 / m_options.poseRate);
+        auto controllerPeriod = std::chrono::duration<double>(m_options.controllerRate > 0.0 ? 1.0 / m_options.controllerRate : 0.0);
+        auto start = Clock::now();
+        auto nextPose = start;
+        auto nextController = m_options.controllerRate > 0.0 ? start : Clock::time_point::max();
+        uint64_t sequence = 0;
+        uint64_t controllerCount = 0;
+
+        // Behind schedule the due messages go out back to back, so rates beyond the sleep
+        // granularity still average out
+        while (!st.stop_requested())
+        {
+            auto now = Clock::now();
+            if (now >= nextController && nextController <= nextPose)
+            {
+                ControllerInput input{};
+                input.joystickX = static_cast<float>(std::sin(controllerCount * 0.05));
+                input.trigger = static_cast<float>(controllerCount % 100) / 100.0f;
+                if (!SendMsg(m_socket, MsgType::Controller, &input, sizeof(input)))
+                    break;
+                m_stats.controllerSent++;
+                controllerCount++;
+                nextController = start + std::chrono::duration_cast<Clock::duration>(controllerPeriod * static_cast<double>(controllerCount));
+                continue;
+            }
+
+            if (now >= nextPose)
+            {
+                // The driver numbers BodyPosition messages on a connection from 1
+                if (++sequence >= m_poseSentUs.size())
+                    break;
+
+                BodyPosition body = MakeBody(m_options.body, std::chrono::duration<double>(now - start).count());
+                m_poseSentUs[sequence].store(GetDriverTimeUs(), std::memory_order_release);
+                if (!SendMsg(m_socket, MsgType::BodyPosition, &body, sizeof(body)))
+                    break;
+                m_stats.posesSent++;
+
+                double slot = static_cast<double>(sequence);
+                if (m_options.pattern == Pattern::Burst)
+                    slot = std::floor(slot / m_options.burstSize) * m_options.burstSize;
+                else if (m_options.pattern == Pattern::Jitter)
+                    slot += jitter(random);
+                nextPose = std::max(now, start + std::chrono::duration_cast<Clock::duration>(posePeriod * slot));
+                continue;
+            }
+
+            std::this_thread::sleep_until(std::min(nextPose, nextController));
+        }
+    }
+
+    void ReceiveThreadFunc()
+    {
+        std::vector<uint8_t> payload;
+        uint64_t lastPoseSequence = 0;
+        uint64_t bytesRead = 0;
+        auto start = Clock::now();
+
+        MsgHeader header;
+        while (RecvAll(m_socket, &header, sizeof(header)))
+        {
+            payload.resize(header.size);
+            if (!RecvAll(m_socket, payload.data(), header.size))
+                break;
+
+            uint64_t nowUs = GetDriverTimeUs();
+            m_stats.served = true;
+            m_stats.messages++;
+            bytesRead += sizeof(header) + header.size;
+
+            if (header.type == MsgType::Haptic && header.size >= sizeof(Haptic))
+            {
+                Haptic haptic;
+                std::memcpy(&haptic, payload.data(), sizeof(haptic));
+                m_stats.hapticUs.push_back(nowUs - haptic.timestampUs);
+            }
+
+            size_t metadataOffset = 0;
+            if (header.type == MsgType::Frame)
+                metadataOffset = sizeof(FrameInfo);
+            else if (header.type == MsgType::StereoFrame)
+                metadataOffset = sizeof(StereoFrameInfo);
+
+            if (metadataOffset != 0 && header.size >= metadataOffset + sizeof(FrameMetadata))
+            {
+                FrameMetadata metadata;
+                std::memcpy(&metadata, payload.data() + metadataOffset, sizeof(metadata));
+                m_stats.frames++;
+                m_stats.frameBytes += header.size;
+                m_stats.transitUs.push_back(nowUs - metadata.sendUs);
+
+                // Only the first frame rendered from a pose times it; later ones reuse it
+                if (metadata.poseSequence > lastPoseSequence && metadata.poseSequence < m_poseSentUs.size())
+                {
+                    lastPoseSequence = metadata.poseSequence;
+                    uint64_t latencyUs = nowUs - m_poseSentUs[metadata.poseSequence].load(std::memory_order_acquire);
+                    m_stats.poseToFrameUs.push_back(latencyUs);
+                    m_stats.poseToFrameHistogram.Record(latencyUs);
+                }
+            }
+
+            // A slow consumer: TCP backpressure reaches the driver's sender like it would
+            if (m_options.readRate > 0.0)
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(bytesRead / (m_options.readRate * 1e6))));
+        }
+    }
+
+    const Options& m_options;
+    uint32_t m_id;
+    SOCKET m_socket = INVALID_SOCKET;
+    ConnectionStats m_stats;
+    std::vector<std::atomic<uint64_t>> m_poseSentUs;  // By pose sequence
+    std::jthread m_sender;
+    std::jthread m_receiver;
+};
+
+static uint64_t Percentile(std::vector<uint64_t> values, double fraction)
+{
+    if (values.empty())
+        return 0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void PrintLatency(const char* name, const std::vector<uint64_t>& latenciesUs)
+{
+    std::printf("    %-18s %8zu %9.2f %9.2f %9.2f %9.2f\n", name, latenciesUs.size(),
+                Percentile(latenciesUs, 0.5) / 1000.0, Percentile(latenciesUs, 0.99) / 1000.0,
+                Percentile(latenciesUs, 0.999) / 1000.0, Percentile(latenciesUs, 1.0) / 1000.0);
+}
+
+static void PrintHistogram(const metrics::Histogram& histogram)
+{
+    metrics::Histogram::Snapshot snapshot = histogram.GetSnapshot();
+    uint64_t largest = *std::max_element(std::begin(snapshot.buckets), std::end(snapshot.buckets));
+    if (largest == 0)
+        return;
+
+    std::printf("    pose -> frame histogram (us)\n");
+    for (uint32_t i = 0; i < metrics::Histogram::kBuckets; i++)
+    {
+        if (snapshot.buckets[i] == 0)
+            continue;
+        uint64_t low = i == 0 ? 0 : 1ull << (i - 1);
+        uint64_t high = (1ull << i) - 1;
+        int width = static_cast<int>(40 * snapshot.buckets[i] / largest);
+        std::printf("    %8llu-%-8llu %8llu %.*s\n", static_cast<unsigned long long>(low), static_cast<unsigned long long>(high),
+                    static_cast<unsigned long long>(snapshot.buckets[i]), std::max(width, 1), "########################################");
+    }
+}
+
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+        size_t equals = arg.find('=');
+        std::string_view name = arg.substr(0, equals);
+        std::string value(equals == std::string_view::npos ? std::string_view{} : arg.substr(equals + 1));
+
+        if (name == "--host")
+            options.host = value;
+        else if (name == "--port")
+            options.port = static_cast<uint16_t>(std::atoi(value.c_str()));
+        else if (name == "--connections")
+            options.connections = static_cast<uint32_t>(std::max(1, std::atoi(value.c_str())));
+        else if (name == "--duration")
+            options.duration = std::atof(value.c_str());
+        else if (name == "--pose-rate")
+            options.poseRate = std::atof(value.c_str());
+        else if (name == "--burst")
+            options.burstSize = static_cast<uint32_t>(std::max(1, std::atoi(value.c_str())));
+        else if (name == "--controller-rate")
+            options.controllerRate = std::atof(value.c_str());
+        else if (name == "--read-rate")
+            options.readRate = std::atof(value.c_str());
+        else if (name == "--eyes")
+            options.eyes = std::clamp(std::atoi(value.c_str()), 0, 3);
+        else if (name == "--max-fps")
+            options.maxFps = static_cast<float>(std::atof(value.c_str()));
+        else if (name == "--stand-in")
+            options.standIn = true;
+        else if (name == "--haptic-rate")
+            options.hapticRate = std::atof(value.c_str());
+        else if (name == "--pattern" && (value == "steady" || value == "burst" || value == "jitter"))
+            options.pattern = value == "steady" ? Pattern::Steady : value == "burst" ? Pattern::Burst : Pattern::Jitter;
+        else if (name == "--body" && (value == "head" || value == "hands" || value == "full"))
+            options.body = value == "head" ? BodyParts::Head : value == "hands" ? BodyParts::Hands : BodyParts::Full;
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+    if (options.hapticRate > 0.0 && !options.standIn)
+    {
+        std::fprintf(stderr, "--haptic-rate needs --stand-in to play the game\n");
+        return false;
+    }
+    return options.duration > 0.0 && options.poseRate > 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: ovd_loadgen [--host=ip] [--port=n] [--connections=n] [--duration=s] [--pose-rate=hz]\n"
+                             "                   [--pattern=steady|burst|jitter] [--burst=n] [--body=head|hands|full]\n"
+                             "                   [--controller-rate=hz] [--read-rate=MB/s] [--eyes=0-3] [--max-fps=n] [--stand-in]\n"
+                             "                   [--haptic-rate=hz]\n");
+        return 1;
+    }
+
+    if (!net::Startup())
+        return 1;
+
+#ifdef OVD_LOADGEN_STANDIN
+    std::unique_ptr<StandIn> standIn;
+    if (options.standIn)
+    {
+        standIn = std::make_unique<StandIn>();
+        if (!standIn->Start(options.port))
+        {
+            std::fprintf(stderr, "driver stand-in failed to start on port %u\n", options.port);
+            return 1;
+        }
+        options.host = "127.0.0.1";
+    }
+#else
+    if (options.standIn)
+    {
+        std::fprintf(stderr, "--stand-in needs the headless driver core, which this build does not have\n");
+        return 1;
+    }
+#endif
+
+#ifdef OVD_LOADGEN_STANDIN
+    // Buzzes whichever devices have a haptic output in turn, like a game would during play
+    std::jthread hapticThread;
+    if (standIn && options.hapticRate > 0.0)
+    {
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.hapticRate));
+        hapticThread = std::jthread([&host = standIn->GetHost(), period](std::stop_token st) {
+            auto next = Clock::now();
+            for (uint32_t tick = 0; !st.stop_requested(); tick++)
+            {
+                uint32_t count = host.GetDeviceCount();
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (host.TriggerHaptic((tick + i) % count, 0.05f, 160.0f, 0.5f))
+                        break;
+                }
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+#endif
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (uint32_t i = 0; i < options.connections; i++)
+    {
+        auto connection = std::make_unique<Connection>(options, i);
+        if (!connection->Start())
+            std::fprintf(stderr, "connection %u to %s:%u failed\n", i, options.host.c_str(), options.port);
+        connections.push_back(std::move(connection));
+    }
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+#ifdef OVD_LOADGEN_STANDIN
+    if (hapticThread.joinable())
+    {
+        hapticThread.request_stop();
+        hapticThread.join();
+    }
+#endif
+    for (auto& connection : connections)
+    {
+        connection->Stop();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+#ifdef OVD_LOADGEN_STANDIN
+    if (standIn)
+        standIn->Stop();
+#endif
+    net::Cleanup();
+
+    bool sameHost = options.standIn || IsLoopback(options.host);
+    for (auto& connection : connections)
+    {
+        ConnectionStats& stats = connection->GetStats();
+        std::printf("connection %u: %s\n", connection->GetId(), !stats.connected ? "not connected" : stats.served ? "served" : "not served (waiting in the driver's backlog)");
+        if (!stats.connected)
+            continue;
+
+        std::printf("    sent      %8.1f poses/s, %.1f controller/s\n", stats.posesSent / elapsed, stats.controllerSent / elapsed);
+        std::printf("    received  %8.1f frames/s, %.1f MB/s, %llu messages\n", stats.frames / elapsed, stats.frameBytes / elapsed / 1e6,
+                    static_cast<unsigned long long>(stats.messages));
+        if (stats.frames == 0 && stats.hapticUs.empty())
+            continue;
+
+        std::printf("    %-18s %8s %9s %9s %9s %9s\n", "latency (ms)", "count", "p50", "p99", "p999", "max");
+        PrintLatency("pose -> frame", stats.poseToFrameUs);
+        if (sameHost)
+            PrintLatency("send -> receive", stats.transitUs);
+        if (sameHost && !stats.hapticUs.empty())
+            PrintLatency("haptic -> receive", stats.hapticUs);
+        PrintHistogram(stats.poseToFrameHistogram);
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "mock_compositor.h"
+#include "readback/synthetic_texture_device.h"
+#include "frame/frame_metadata.h"
+#include <algorithm>
+#include <cstring>
+
+// DXGI_FORMAT_R8G8B8A8_UNORM, what the SteamVR compositor usually asks for
+static constexpr uint32_t kSwapTextureFormat = 28;
+
+MockCompositor::MockCompositor(MockVRHost& host, uint32_t hmdIndex, uint32_t overlayLayers) :
+    m_host(host),
+    m_hmdIndex(hmdIndex),
+    m_overlaySets(overlayLayers)
+{}
+
+// Clear except for a translucent panel across the lower middle, a little lower for each layer
+static void DrawOverlay(SyntheticTexture& texture, uint32_t layer)
+{
+    std::fill(texture.pixels.begin(), texture.pixels.end(), uint8_t{ 0 });
+    uint32_t top = std::min(texture.height / 2 + layer * texture.height / 16, texture.height);
+    uint32_t bottom = std::min(top + texture.height / 4, texture.height);
+    for (uint32_t y = top; y < bottom; y++)
+    {
+        for (uint32_t x = texture.width / 4; x < texture.width * 3 / 4; x++)
+        {
+            uint8_t* pixel = &texture.pixels[static_cast<size_t>(y) * texture.rowPitch + x * 4];
+            pixel[0] = pixel[1] = pixel[2] = 0xE0;
+            pixel[3] = 0xC0;
+        }
+    }
+}
+
+MockCompositor::~MockCompositor()
+{
+    Stop();
+}
+
+bool MockCompositor::Start()
+{
+    if (m_hmdIndex >= m_host.GetDeviceCount())
+        return false;
+
+    vr::ITrackedDeviceServerDriver* hmd = m_host.GetDevice(m_hmdIndex);
+    auto* display = static_cast<vr::IVRDisplayComponent*>(hmd->GetComponent(vr::IVRDisplayComponent_Version));
+    m_pDirectMode = static_cast<vr::IVRDriverDirectModeComponent*>(hmd->GetComponent(vr::IVRDriverDirectModeComponent_Version));
+    if (!display || !m_pDirectMode)
+        return false;
+
+    display->GetRecommendedRenderTargetSize(&m_eyeWidth, &m_eyeHeight);
+    vr::IVRDriverDirectModeComponent::SwapTextureSetDesc_t desc{ m_eyeWidth, m_eyeHeight, kSwapTextureFormat, 1 };
+    for (auto& swapSet : m_swapSets)
+    {
+        m_pDirectMode->CreateSwapTextureSet(kPid, &desc, &swapSet);
+        if (swapSet.rSharedTextureHandles[0] == 0)
+            return false;
+    }
+    for (uint32_t layer = 0; layer < m_overlaySets.size(); layer++)
+    {
+        auto& swapSet = m_overlaySets[layer];
+        m_pDirectMode->CreateSwapTextureSet(kPid, &desc, &swapSet);
+        if (swapSet.rSharedTextureHandles[0] == 0)
+            return false;
+        for (vr::SharedTextureHandle_t handle : swapSet.rSharedTextureHandles)
+        {
+            if (SyntheticTexture* texture = SyntheticTextureDevice::OpenShared(handle))
+                DrawOverlay(*texture, layer);
+        }
+    }
+
+    m_renderThread = std::jthread([this](std::stop_token st) { RenderThreadFunc(st); });
+    return true;
+}
+
+void MockCompositor::Stop()
+{
+    if (!m_pDirectMode)
+        return;
+
+    if (m_renderThread.joinable())
+    {
+        m_renderThread.request_stop();
+        m_renderThread.join();
+    }
+    m_pDirectMode->DestroyAllSwapTextureSets(kPid);
+    m_pDirectMode = nullptr;
+}
+
+void MockCompositor::RenderThreadFunc(std::stop_token st)
+{
+    for (uint64_t frame = 0; !st.stop_requested(); frame++)
+    {
+        vr::SharedTextureHandle_t setHandles[2] = { m_swapSets[0].rSharedTextureHandles[0], m_swapSets[1].rSharedTextureHandles[0] };
+        uint32_t indices[2] = {};
+        m_pDirectMode->GetNextSwapTextureSetIndex(setHandles, &indices);
+
+        vr::DriverPose_t headPose = m_host.GetLastPose(m_hmdIndex);
+        vr::IVRDriverDirectModeComponent::SubmitLayerPerEye_t layers[2] = {};
+        for (uint32_t eye = 0; eye < 2; eye++)
+        {
+            // "Rendering" is a changing first row; the driver only looks at handles and hashes
+            vr::SharedTextureHandle_t texture = m_swapSets[eye].rSharedTextureHandles[indices[eye]];
+            if (SyntheticTexture* pixels = SyntheticTextureDevice::OpenShared(texture))
+                std::memset(pixels->pixels.data(), static_cast<int>(frame), pixels->rowPitch);
+
+            // Translation only; rotation stays identity since nothing reads it back
+            layers[eye].hTexture = texture;
+            layers[eye].bounds = vr::VRTextureBounds_t{ 0.0f, 0.0f, 1.0f, 1.0f };
+            layers[eye].mHmdPose.m[0][0] = layers[eye].mHmdPose.m[1][1] = layers[eye].mHmdPose.m[2][2] = 1.0f;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                layers[eye].mHmdPose.m[axis][3] = static_cast<float>(headPose.vecPosition[axis]);
+            }
+        }
+
+        uint64_t startUs = GetDriverTimeUs();
+        m_pDirectMode->SubmitLayer(layers);
+        for (const auto& swapSet : m_overlaySets)
+        {
+            vr::IVRDriverDirectModeComponent::SubmitLayerPerEye_t overlay[2] = { layers[0], layers[1] };
+            overlay[0].hTexture = overlay[1].hTexture = swapSet.rSharedTextureHandles[0];
+            m_pDirectMode->SubmitLayer(overlay);
+        }
+        m_presentCallsUs.push_back(GetDriverTimeUs());
+        m_pDirectMode->Present(0);
+        m_presentTimesUs.push_back(GetDriverTimeUs() - startUs);
+        m_presentCount.fetch_add(1, std::memory_order_relaxed);
+
+        m_pDirectMode->PostPresent(nullptr);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// Plays the SteamVR compositor against the HMD's direct mode component on its own thread: one
+// synthetic swap texture set per eye, a changed image every frame rendered at the HMD's newest
+// pose, then SubmitLayer/Present/PostPresent, so the driver paces it to the display rate.
+// Optional overlay layers, a translucent HUD panel each, are submitted on top of the eyes.
+
+#include <openvr_driver.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "mock_vr_host.h"
+
+class MockCompositor
+{
+public:
+    // hmdIndex is the HMD's device index on host
+    MockCompositor(MockVRHost& host, uint32_t hmdIndex, uint32_t overlayLayers = 0);
+    ~MockCompositor();
+
+    bool Start();
+    // Joins the render thread and destroys the swap textures
+    void Stop();
+
+    uint32_t GetEyeWidth() const { return m_eyeWidth; }
+    uint32_t GetEyeHeight() const { return m_eyeHeight; }
+    uint64_t GetPresentCount() const { return m_presentCount.load(std::memory_order_relaxed); }
+    // Microseconds spent in each SubmitLayer + Present; read after Stop
+    const std::vector<uint64_t>& GetPresentTimesUs() const { return m_presentTimesUs; }
+    // Driver time each Present was called at, by frame; the low byte of a frame number is the
+    // value of its first row, so frames read without FrameMetadata can be timed. Read after Stop
+    const std::vector<uint64_t>& GetPresentCallsUs() const { return m_presentCallsUs; }
+
+private:
+    void RenderThreadFunc(std::stop_token st);
+
+    // The SteamVR compositor is one process to the driver
+    static constexpr uint32_t kPid = 1;
+
+    MockVRHost& m_host;
+    uint32_t m_hmdIndex;
+    vr::IVRDriverDirectModeComponent* m_pDirectMode = nullptr;
+    vr::IVRDriverDirectModeComponent::SwapTextureSet_t m_swapSets[2] = {};
+    // One texture set per overlay, shared by both eyes and drawn once
+    std::vector<vr::IVRDriverDirectModeComponent::SwapTextureSet_t> m_overlaySets;
+    uint32_t m_eyeWidth = 0;
+    uint32_t m_eyeHeight = 0;
+
+    std::jthread m_renderThread;
+    std::atomic<uint64_t> m_presentCount{0};
+    std::vector<uint64_t> m_presentTimesUs;
+    std::vector<uint64_t> m_presentCallsUs;
+};
@@ -0,0 +1,224 @@
+#include "mock_vr_host.h"
+#include <cstdio>
+#include <cstring>
+
+MockVRHost::MockVRHost(PoseObserver poseObserver) :
+    m_poseObserver(std::move(poseObserver))
+{}
+
+void MockVRHost::QueueEvent(const vr::VREvent_t& event)
+{
+    std::lock_guard<std::mutex> lock(m_eventMtx);
+    m_events.push_back({ event, std::chrono::steady_clock::now() });
+}
+
+bool MockVRHost::TriggerHaptic(uint32_t index, float durationSeconds, float frequency, float amplitude)
+{
+    if (index >= GetDeviceCount())
+        return false;
+
+    vr::VRInputComponentHandle_t component = m_devices[index].hapticComponent.load(std::memory_order_acquire);
+    if (component == vr::k_ulInvalidInputComponentHandle)
+        return false;
+
+    vr::VREvent_t event{};
+    event.eventType = vr::VREvent_Input_HapticVibration;
+    event.trackedDeviceIndex = index;
+    event.data.hapticVibration.containerHandle = TrackedDeviceToPropertyContainer(index);
+    event.data.hapticVibration.componentHandle = component;
+    event.data.hapticVibration.fDurationSeconds = durationSeconds;
+    event.data.hapticVibration.fFrequency = frequency;
+    event.data.hapticVibration.fAmplitude = amplitude;
+    QueueEvent(event);
+    return true;
+}
+
+void MockVRHost::DeactivateDevices()
+{
+    for (uint32_t i = GetDeviceCount(); i > 0; --i)
+    {
+        m_devices[i - 1].driver->Deactivate();
+    }
+}
+
+void* MockVRHost::GetGenericInterface(const char* pchInterfaceVersion, vr::EVRInitError* peError)
+{
+    void* result = nullptr;
+    if (std::strcmp(pchInterfaceVersion, vr::IVRServerDriverHost_Version) == 0)
+        result = static_cast<vr::IVRServerDriverHost*>(this);
+    else if (std::strcmp(pchInterfaceVersion, vr::IVRProperties_Version) == 0)
+        result = static_cast<vr::IVRProperties*>(this);
+    else if (std::strcmp(pchInterfaceVersion, vr::IVRDriverInput_Version) == 0)
+        result = static_cast<vr::IVRDriverInput*>(this);
+    else if (std::strcmp(pchInterfaceVersion, vr::IVRSettings_Version) == 0)
+        result = static_cast<vr::IVRSettings*>(this);
+    else if (std::strcmp(pchInterfaceVersion, vr::IVRDriverLog_Version) == 0)
+        result = static_cast<vr::IVRDriverLog*>(this);
+
+    if (peError)
+        *peError = result ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+    return result;
+}
+
+bool MockVRHost::TrackedDeviceAdded(const char* pchDeviceSerialNumber, vr::ETrackedDeviceClass, vr::ITrackedDeviceServerDriver* pDriver)
+{
+    uint32_t index = m_deviceCount.load(std::memory_order_relaxed);
+    if (!pDriver || index >= kMaxDevices)
+        return false;
+
+    m_devices[index].serial = pchDeviceSerialNumber;
+    m_devices[index].driver = pDriver;
+    m_deviceCount.store(index + 1, std::memory_order_release);
+
+    // vrserver activates a little later on its own thread; right away is close enough here
+    return pDriver->Activate(index) == vr::VRInitError_None;
+}
+
+void MockVRHost::TrackedDevicePoseUpdated(uint32_t unWhichDevice, const vr::DriverPose_t& newPose, uint32_t)
+{
+    if (unWhichDevice >= GetDeviceCount())
+        return;
+
+    m_devices[unWhichDevice].lastPose.Store(newPose);
+    m_devices[unWhichDevice].poseUpdates.fetch_add(1, std::memory_order_relaxed);
+    if (m_poseObserver)
+        m_poseObserver(unWhichDevice, newPose);
+}
+
+bool MockVRHost::PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent)
+{
+    std::lock_guard<std::mutex> lock(m_eventMtx);
+    if (m_events.empty() || uncbVREvent < sizeof(vr::VREvent_t))
+        return false;
+
+    // Age is how long it waited for the driver to poll, as vrserver reports it
+    *pEvent = m_events.front().event;
+    pEvent->eventAgeSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - m_events.front().queuedAt).count();
+    m_events.pop_front();
+    return true;
+}
+
+vr::ETrackedPropertyError MockVRHost::ReadPropertyBatch(vr::PropertyContainerHandle_t, vr::PropertyRead_t* pBatch, uint32_t unBatchEntryCount)
+{
+    for (uint32_t i = 0; i < unBatchEntryCount; i++)
+    {
+        pBatch[i].eError = vr::TrackedProp_UnknownProperty;
+    }
+    return vr::TrackedProp_Success;
+}
+
+vr::ETrackedPropertyError MockVRHost::WritePropertyBatch(vr::PropertyContainerHandle_t, vr::PropertyWrite_t* pBatch, uint32_t unBatchEntryCount)
+{
+    for (uint32_t i = 0; i < unBatchEntryCount; i++)
+    {
+        pBatch[i].eError = vr::TrackedProp_Success;
+    }
+    return vr::TrackedProp_Success;
+}
+
+vr::EVRInputError MockVRHost::CreateComponent(vr::VRInputComponentHandle_t* pHandle)
+{
+    if (pHandle)
+        *pHandle = m_nextComponent.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+vr::EVRInputError MockVRHost::CreateBooleanComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle)
+{
+    return CreateComponent(pHandle);
+}
+
+vr::EVRInputError MockVRHost::UpdateBooleanComponent(vr::VRInputComponentHandle_t, bool, double)
+{
+    m_inputUpdates.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+vr::EVRInputError MockVRHost::CreateScalarComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle, vr::EVRScalarType, vr::EVRScalarUnits)
+{
+    return CreateComponent(pHandle);
+}
+
+vr::EVRInputError MockVRHost::UpdateScalarComponent(vr::VRInputComponentHandle_t, float, double)
+{
+    m_inputUpdates.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+vr::EVRInputError MockVRHost::CreateHapticComponent(vr::PropertyContainerHandle_t ulContainer, const char*, vr::VRInputComponentHandle_t* pHandle)
+{
+    vr::EVRInputError error = CreateComponent(pHandle);
+    // Containers are device index + 1, see TrackedDeviceToPropertyContainer
+    if (error == vr::VRInputError_None && ulContainer >= 1 && ulContainer <= kMaxDevices)
+        m_devices[ulContainer - 1].hapticComponent.store(*pHandle, std::memory_order_release);
+    return error;
+}
+
+vr::EVRInputError MockVRHost::CreateSkeletonComponent(vr::PropertyContainerHandle_t, const char*, const char*, const char*, vr::EVRSkeletalTrackingLevel, const vr::VRBoneTransform_t*, uint32_t, vr::VRInputComponentHandle_t* pHandle)
+{
+    return CreateComponent(pHandle);
+}
+
+vr::EVRInputError MockVRHost::UpdateSkeletonComponent(vr::VRInputComponentHandle_t, vr::EVRSkeletalMotionRange, const vr::VRBoneTransform_t*, uint32_t)
+{
+    m_inputUpdates.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+vr::EVRInputError MockVRHost::CreatePoseComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle)
+{
+    return CreateComponent(pHandle);
+}
+
+vr::EVRInputError MockVRHost::UpdatePoseComponent(vr::VRInputComponentHandle_t, const vr::HmdMatrix34_t*, double)
+{
+    m_inputUpdates.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+vr::EVRInputError MockVRHost::CreateEyeTrackingComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle)
+{
+    return CreateComponent(pHandle);
+}
+
+vr::EVRInputError MockVRHost::UpdateEyeTrackingComponent(vr::VRInputComponentHandle_t, const vr::VREyeTrackingData_t*, double)
+{
+    m_inputUpdates.fetch_add(1, std::memory_order_relaxed);
+    return vr::VRInputError_None;
+}
+
+void MockVRHost::SetSettingsError(vr::EVRSettingsError* peError)
+{
+    if (peError)
+        *peError = vr::VRSettingsError_None;
+}
+
+bool MockVRHost::GetBool(const char*, const char*, vr::EVRSettingsError* peError)
+{
+    SetSettingsError(peError);
+    return false;
+}
+
+int32_t MockVRHost::GetInt32(const char*, const char*, vr::EVRSettingsError* peError)
+{
+    SetSettingsError(peError);
+    return 0;
+}
+
+float MockVRHost::GetFloat(const char*, const char*, vr::EVRSettingsError* peError)
+{
+    SetSettingsError(peError);
+    return 0.0f;
+}
+
+void MockVRHost::GetString(const char*, const char*, char* pchValue, uint32_t unValueLen, vr::EVRSettingsError* peError)
+{
+    SetSettingsError(peError);
+    if (pchValue && unValueLen > 0)
+        pchValue[0] = '\0';
+}
+
+void MockVRHost::Log(const char* pchLogMessage)
+{
+    std::fprintf(stderr, "[driver] %s", pchLogMessage);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Stands in for vrserver so the driver core runs headless: hands out the server interfaces
+// through IVRDriverContext, activates devices as they are added, keeps each device's newest
+// pose and reports every update to an observer. Properties, settings and input components are
+// accepted and dropped.
+
+#include <openvr_driver.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "thread/seqlock.h"
+
+class MockVRHost : public vr::IVRDriverContext,
+                   public vr::IVRServerDriverHost,
+                   public vr::IVRProperties,
+                   public vr::IVRDriverInput,
+                   public vr::IVRSettings,
+                   public vr::IVRDriverLog
+{
+public:
+    // Called on the device's pose thread for every TrackedDevicePoseUpdated
+    using PoseObserver = std::function<void(uint32_t deviceIndex, const vr::DriverPose_t& pose)>;
+
+    explicit MockVRHost(PoseObserver poseObserver = nullptr);
+
+    // Activated devices, in the order they were added
+    uint32_t GetDeviceCount() const { return m_deviceCount.load(std::memory_order_acquire); }
+    vr::ITrackedDeviceServerDriver* GetDevice(uint32_t index) const { return m_devices[index].driver; }
+    const char* GetDeviceSerial(uint32_t index) const { return m_devices[index].serial.c_str(); }
+    uint64_t GetPoseUpdateCount(uint32_t index) const { return m_devices[index].poseUpdates.load(std::memory_order_relaxed); }
+    // What the compositor would render the device at
+    vr::DriverPose_t GetLastPose(uint32_t index) const { return m_devices[index].lastPose.Load(); }
+    uint64_t GetInputUpdateCount() const { return m_inputUpdates.load(std::memory_order_relaxed); }
+
+    // Delivered to the driver through PollNextEvent
+    void QueueEvent(const vr::VREvent_t& event);
+    // Queues the VREvent_Input_HapticVibration a game would cause; false if the device has no haptic output
+    bool TriggerHaptic(uint32_t index, float durationSeconds, float frequency, float amplitude);
+
+    // Deactivates every device, newest first, the way vrserver does before Cleanup
+    void DeactivateDevices();
+
+    // IVRDriverContext
+    void* GetGenericInterface(const char* pchInterfaceVersion, vr::EVRInitError* peError) override;
+    vr::DriverHandle_t GetDriverHandle() override { return 1; }
+
+    // IVRServerDriverHost
+    bool TrackedDeviceAdded(const char* pchDeviceSerialNumber, vr::ETrackedDeviceClass eDeviceClass, vr::ITrackedDeviceServerDriver* pDriver) override;
+    void TrackedDevicePoseUpdated(uint32_t unWhichDevice, const vr::DriverPose_t& newPose, uint32_t unPoseStructSize) override;
+    void VsyncEvent(double) override {}
+    void VendorSpecificEvent(uint32_t, vr::EVREventType, const vr::VREvent_Data_t&, double) override {}
+    bool IsExiting() override { return false; }
+    bool PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent) override;
+    void GetRawTrackedDevicePoses(float, vr::TrackedDevicePose_t*, uint32_t) override {}
+    void RequestRestart(const char*, const char*, const char*, const char*) override {}
+    uint32_t GetFrameTimings(vr::Compositor_FrameTiming*, uint32_t) override { return 0; }
+    void SetDisplayEyeToHead(uint32_t, const vr::HmdMatrix34_t&, const vr::HmdMatrix34_t&) override {}
+    void SetDisplayProjectionRaw(uint32_t, const vr::HmdRect2_t&, const vr::HmdRect2_t&) override {}
+    void SetRecommendedRenderTargetSize(uint32_t, uint32_t, uint32_t) override {}
+
+    // IVRProperties
+    vr::ETrackedPropertyError ReadPropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle, vr::PropertyRead_t* pBatch, uint32_t unBatchEntryCount) override;
+    vr::ETrackedPropertyError WritePropertyBatch(vr::PropertyContainerHandle_t ulContainerHandle, vr::PropertyWrite_t* pBatch, uint32_t unBatchEntryCount) override;
+    const char* GetPropertyNameFromEnum(vr::ETrackedDeviceProperty) override { return ""; }
+    vr::PropertyContainerHandle_t TrackedDeviceToPropertyContainer(vr::TrackedDeviceIndex_t nDevice) override { return nDevice + 1; }
+
+    // IVRDriverInput
+    vr::EVRInputError CreateBooleanComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle) override;
+    vr::EVRInputError UpdateBooleanComponent(vr::VRInputComponentHandle_t, bool, double) override;
+    vr::EVRInputError CreateScalarComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle, vr::EVRScalarType, vr::EVRScalarUnits) override;
+    vr::EVRInputError UpdateScalarComponent(vr::VRInputComponentHandle_t, float, double) override;
+    vr::EVRInputError CreateHapticComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle) override;
+    vr::EVRInputError CreateSkeletonComponent(vr::PropertyContainerHandle_t, const char*, const char*, const char*, vr::EVRSkeletalTrackingLevel, const vr::VRBoneTransform_t*, uint32_t, vr::VRInputComponentHandle_t* pHandle) override;
+    vr::EVRInputError UpdateSkeletonComponent(vr::VRInputComponentHandle_t, vr::EVRSkeletalMotionRange, const vr::VRBoneTransform_t*, uint32_t) override;
+    vr::EVRInputError CreatePoseComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle) override;
+    vr::EVRInputError UpdatePoseComponent(vr::VRInputComponentHandle_t, const vr::HmdMatrix34_t*, double) override;
+    vr::EVRInputError CreateEyeTrackingComponent(vr::PropertyContainerHandle_t, const char*, vr::VRInputComponentHandle_t* pHandle) override;
+    vr::EVRInputError UpdateEyeTrackingComponent(vr::VRInputComponentHandle_t, const vr::VREyeTrackingData_t*, double) override;
+
+    // IVRSettings, every key reads as unset
+    const char* GetSettingsErrorNameFromEnum(vr::EVRSettingsError) override { return ""; }
+    void SetBool(const char*, const char*, bool, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+    void SetInt32(const char*, const char*, int32_t, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+    void SetFloat(const char*, const char*, float, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+    void SetString(const char*, const char*, const char*, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+    bool GetBool(const char*, const char*, vr::EVRSettingsError* peError) override;
+    int32_t GetInt32(const char*, const char*, vr::EVRSettingsError* peError) override;
+    float GetFloat(const char*, const char*, vr::EVRSettingsError* peError) override;
+    void GetString(const char*, const char*, char* pchValue, uint32_t unValueLen, vr::EVRSettingsError* peError) override;
+    void RemoveSection(const char*, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+    void RemoveKeyInSection(const char*, const char*, vr::EVRSettingsError* peError) override { SetSettingsError(peError); }
+
+    // IVRDriverLog
+    void Log(const char* pchLogMessage) override;
+
+private:
+    static constexpr uint32_t kMaxDevices = 64;
+
+    struct Device {
+        std::string serial;
+        vr::ITrackedDeviceServerDriver* driver = nullptr;
+        std::atomic<uint64_t> poseUpdates{0};
+        SeqLock<vr::DriverPose_t> lastPose;
+        std::atomic<vr::VRInputComponentHandle_t> hapticComponent{vr::k_ulInvalidInputComponentHandle};
+    };
+
+    struct QueuedEvent {
+        vr::VREvent_t event;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    static void SetSettingsError(vr::EVRSettingsError* peError);
+    vr::EVRInputError CreateComponent(vr::VRInputComponentHandle_t* pHandle);
+
+    PoseObserver m_poseObserver;
+
+    // Written only by TrackedDeviceAdded; a device is visible to readers once the count covers it
+    std::array<Device, kMaxDevices> m_devices;
+    std::atomic<uint32_t> m_deviceCount{0};
+
+    std::atomic<uint64_t> m_nextComponent{1};
+    std::atomic<uint64_t> m_inputUpdates{0};
+
+    std::mutex m_eventMtx;
+    std::deque<QueuedEvent> m_events;
+};
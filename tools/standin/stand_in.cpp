@@ -0,0 +1,65 @@
+#include "stand_in.h"
+#include "provider/device_provider.h"
+#include "control/control.h"
+#include <chrono>
+#include <string>
+
+// vrserver runs its driver loop far faster than the display
+static constexpr auto kRunFramePeriod = std::chrono::milliseconds(1);
+
+StandIn::StandIn(MockVRHost::PoseObserver poseObserver) :
+    m_host(std::move(poseObserver))
+{}
+
+StandIn::~StandIn()
+{
+    Stop();
+}
+
+bool StandIn::Start(uint16_t port, uint32_t overlayLayers)
+{
+    control::Registry::Get().Execute("set socket.port=" + std::to_string(port));
+
+    m_pProvider = std::make_unique<AIVRDeviceProvider>();
+    if (m_pProvider->Init(&m_host) != vr::VRInitError_None)
+    {
+        m_pProvider.reset();
+        return false;
+    }
+
+    // Init adds the HMD first
+    m_pCompositor = std::make_unique<MockCompositor>(m_host, 0, overlayLayers);
+    if (!m_pCompositor->Start())
+    {
+        Stop();
+        return false;
+    }
+
+    m_runFrameThread = std::jthread([this](std::stop_token st) {
+        while (!st.stop_requested())
+        {
+            m_pProvider->RunFrame();
+            std::this_thread::sleep_for(kRunFramePeriod);
+        }
+    });
+    return true;
+}
+
+void StandIn::Stop()
+{
+    if (!m_pProvider)
+        return;
+
+    // The compositor's swap textures are gone before the HMD that owns them
+    if (m_pCompositor)
+        m_pCompositor->Stop();
+    if (m_runFrameThread.joinable())
+    {
+        m_runFrameThread.request_stop();
+        m_runFrameThread.join();
+    }
+
+    m_host.DeactivateDevices();
+    m_pProvider->Cleanup();
+    m_pProvider.reset();
+}
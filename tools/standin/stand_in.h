@@ -0,0 +1,36 @@
+#pragma once
+
+// The real driver core running as it would under SteamVR, minus SteamVR: AIVRDeviceProvider on a
+// MockVRHost, RunFrame called like vrserver's main loop and a MockCompositor presenting at the
+// display rate. Clients connect to it on the given port like they would to the installed driver.
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include "mock_vr_host.h"
+#include "mock_compositor.h"
+
+class AIVRDeviceProvider;
+
+class StandIn
+{
+public:
+    explicit StandIn(MockVRHost::PoseObserver poseObserver = nullptr);
+    ~StandIn();
+
+    // Sets socket.port, so only one stand-in per process. overlayLayers are composited by the
+    // compositor on top of the eyes every frame.
+    bool Start(uint16_t port, uint32_t overlayLayers = 0);
+    // Stops presenting and pose traffic to the host, then shuts the driver down, which also
+    // disconnects the client
+    void Stop();
+
+    MockVRHost& GetHost() { return m_host; }
+    MockCompositor* GetCompositor() { return m_pCompositor.get(); }
+
+private:
+    MockVRHost m_host;
+    std::unique_ptr<AIVRDeviceProvider> m_pProvider;
+    std::unique_ptr<MockCompositor> m_pCompositor;
+    std::jthread m_runFrameThread;
+};